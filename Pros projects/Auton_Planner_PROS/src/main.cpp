@@ -1,10 +1,24 @@
 #include "main.h"
+#include "bonkers/config_bundle.hpp"
+#include "bonkers/drive_geometry.hpp"
+#include "bonkers/drive_trace.hpp"
+#include "bonkers/image_decoder.hpp"
+#include "bonkers/log_plan.hpp"
+#include "bonkers/plan.hpp"
+#include "bonkers/plan_arena.hpp"
+#include "bonkers/plan_pros.hpp"
+#include "bonkers/plan_vm.hpp"
+#include "bonkers/sd_path.hpp"
+#include "bonkers/ui.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <cinttypes>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <iterator>
 #include <vector>
 
 // =====================================================
@@ -26,66 +40,6 @@ namespace {
 constexpr char kJerkbotName[] = "jerkbot.bmp";
 
 int g_step_index = 0;
-
-bool starts_with(const char* str, const char* prefix) {
-    if (!str || !prefix) {
-        return false;
-    }
-    const std::size_t prefix_len = std::strlen(prefix);
-    return std::strncmp(str, prefix, prefix_len) == 0;
-}
-
-bool try_mount_sd() {
-    char buffer[64] = {0};
-    errno = 0;
-    return pros::usd::list_files("/", buffer, sizeof(buffer)) != PROS_ERR;
-}
-
-FILE* sd_open(const char* name, const char* mode) {
-    if (!name || !mode) {
-        return nullptr;
-    }
-
-    const char* prefixes[] = {
-        "/usd/",
-        "usd/",
-        "/usd/Images/",
-        "/usd/images/",
-        "usd/Images/",
-        "usd/images/",
-    };
-
-    for (int attempt = 0; attempt < 3; ++attempt) {
-        FILE* file = std::fopen(name, mode);
-        if (file) {
-            return file;
-        }
-
-        if (starts_with(name, "usd/")) {
-            char fixed[128];
-            std::snprintf(fixed, sizeof(fixed), "/%s", name);
-            file = std::fopen(fixed, mode);
-            if (file) {
-                return file;
-            }
-        }
-
-        try_mount_sd();
-
-        char path[128];
-        for (const char* prefix : prefixes) {
-            std::snprintf(path, sizeof(path), "%s%s", prefix, name);
-            file = std::fopen(path, mode);
-            if (file) {
-                return file;
-            }
-        }
-
-        pros::delay(50);
-    }
-
-    return nullptr;
-}
 }
 
 // =====================================================
@@ -104,59 +58,10 @@ void update_auton_mode_from_controller() {
 }
 
 // =====================================================
-// BMP DRAW (24-bit uncompressed)
+// BMP/VBI DRAW (row-batched, see image_decoder.cpp)
 // =====================================================
-bool draw_bmp_from_sd(const char* name, int x, int y) {
-    FILE* file = sd_open(name, "rb");
-    if (!file) return false;
-
-    std::uint8_t header[54];
-    if (std::fread(header, 1, sizeof(header), file) != sizeof(header)) {
-        std::fclose(file);
-        return false;
-    }
-
-    const std::uint32_t data_offset = *reinterpret_cast<std::uint32_t*>(&header[10]);
-    const std::int32_t width = *reinterpret_cast<std::int32_t*>(&header[18]);
-    const std::int32_t height = *reinterpret_cast<std::int32_t*>(&header[22]);
-    const std::uint16_t bpp = *reinterpret_cast<std::uint16_t*>(&header[28]);
-    const std::uint32_t compression = *reinterpret_cast<std::uint32_t*>(&header[30]);
-
-    if (bpp != 24 || compression != 0 || width <= 0 || height == 0) {
-        std::fclose(file);
-        return false;
-    }
-
-    const std::int32_t abs_height = std::abs(height);
-    const std::uint32_t row_size = ((bpp * width + 31) / 32) * 4;
-    std::vector<std::uint8_t> row(row_size);
-
-    std::fseek(file, static_cast<long>(data_offset), SEEK_SET);
-
-    for (std::int32_t row_idx = 0; row_idx < abs_height; ++row_idx) {
-        if (std::fread(row.data(), 1, row_size, file) != row_size) {
-            break;
-        }
-        const std::int32_t draw_y = height > 0 ? (abs_height - 1 - row_idx) : row_idx;
-        for (std::int32_t col = 0; col < width; ++col) {
-            const std::size_t idx = static_cast<std::size_t>(col * 3);
-            const std::uint8_t b = row[idx];
-            const std::uint8_t g = row[idx + 1];
-            const std::uint8_t r = row[idx + 2];
-            const std::uint32_t color = (static_cast<std::uint32_t>(r) << 16) |
-                                        (static_cast<std::uint32_t>(g) << 8) |
-                                        static_cast<std::uint32_t>(b);
-            pros::screen::set_pen(color);
-            pros::screen::draw_pixel(x + col, y + draw_y);
-        }
-    }
-
-    std::fclose(file);
-    return true;
-}
-
 void draw_jerkbot() {
-    draw_bmp_from_sd(kJerkbotName, 0, 0);
+    image::draw_file(sd::open, kJerkbotName, 0, 0);
 }
 
 // =====================================================
@@ -168,61 +73,105 @@ void stop_drive() {
     right_drive.brake();
 }
 
-void turn_to_heading(double target, int max_speed) {
-    while (true) {
-        double current = imu.get_heading();
-        double error = target - current;
-
-        if (error > 180) error -= 360;
-        if (error < -180) error += 360;
+// plan::Robot bindings for the auton VM. There is no abort path here: the
+// competition switch ends autonomous by stopping the task.
+void vm_drive(void*, int left, int right) {
+    left_drive.move(left);
+    right_drive.move(right);
+}
 
-        if (std::abs(error) < 2.0) break;
+void vm_brake_drive(void*) {
+    stop_drive();
+}
 
-        double kp = 1.5;
-        int speed = static_cast<int>(error * kp);
+void vm_rollers(void*, int power) {
+    if (power == 0) {
+        intake_left.brake();
+        intake_right.brake();
+    } else {
+        intake_left.move(power);
+        intake_right.move(power);
+    }
+}
 
-        if (speed > max_speed) speed = max_speed;
-        if (speed < -max_speed) speed = -max_speed;
+void vm_intake(void*, int power) {
+    if (power == 0) {
+        intake_left.brake();
+    } else {
+        intake_left.move(power);
+    }
+}
 
-        left_drive.move(speed);
-        right_drive.move(-speed);
-        pros::delay(20);
+void vm_outake(void*, int power) {
+    if (power == 0) {
+        intake_right.brake();
+    } else {
+        intake_right.move(power);
     }
+}
+
+void vm_stop_all(void*) {
     stop_drive();
+    vm_rollers(nullptr, 0);
+}
+
+double vm_heading(void*) {
+    return imu.get_heading();
 }
 
+// Average of a side's three encoders.
+double side_mm(const pros::MotorGroup& side) {
+    return (side.get_position(0) + side.get_position(1) + side.get_position(2)) / 3 * geometry::kMmPerMotorDegree;
+}
+
+double vm_left_mm(void*) {
+    return side_mm(left_drive);
+}
+
+double vm_right_mm(void*) {
+    return side_mm(right_drive);
+}
+
+const plan::Robot kRobot = {nullptr,
+                            vm_drive,
+                            vm_brake_drive,
+                            vm_rollers,
+                            vm_intake,
+                            vm_outake,
+                            vm_stop_all,
+                            vm_heading,
+                            plan::pros_millis,
+                            plan::pros_delay_until,
+                            nullptr,
+                            vm_left_mm,
+                            vm_right_mm,
+                            geometry::kTrackWidthMm,
+                            plan::pros_micros,
+                            plan::pros_overrun};
+
 // =====================================================
 // AUTON STEP SYSTEM (EASY TO EDIT)
 // =====================================================
 
-enum class StepType {
-    EMPTY,
-    DRIVE_MS,
-    TANK_MS,
-    TURN_HEADING,
-    WAIT_MS,
-    INTAKE_ON,
-    INTAKE_OFF,
-    OUTTAKE_ON,
-    OUTTAKE_OFF
-};
-
-struct Step {
-    StepType type;
-    int value1; // speed or heading or ms
-    int value2; // duration for DRIVE_MS, right speed for TANK_MS
-    int value3; // duration for TANK_MS
-};
+using plan::Step;
+using plan::StepType;
+using plan::kPlanCapacity;
+using plan::next_step_type;
+using plan::slot_filename;
+using plan::step_type_name;
 
-constexpr std::size_t kMaxSteps = 10;
-constexpr int kSlotCount = 3;
-constexpr char kSlot1File[] = "auton_plans_slot1.txt";
-constexpr char kSlot2File[] = "auton_plans_slot2.txt";
-constexpr char kSlot3File[] = "auton_plans_slot3.txt";
 static int g_save_slot = 0;
 
+// The recorder fits a minute of driving into far fewer than kPlanCapacity steps.
+static plan::Arena<3 * kPlanCapacity> g_plan_arena;
+static plan::PlanBuffer g_gps_plan = g_plan_arena.carve(kPlanCapacity);
+static plan::PlanBuffer g_basic_plan = g_plan_arena.carve(kPlanCapacity);
+// stop_recording() and import_log() fit steps here, without holding
+// g_plan_mutex, before copying them into a plan. Both run on the menu task.
+static plan::PlanBuffer g_scratch_plan = g_plan_arena.carve(kPlanCapacity);
+
 // --- GPS MODE PLAN (EDIT THIS) ---
-static Step gps_plan[kMaxSteps] = {
+constexpr Step kDefaultGpsPlan[] = {
     {StepType::DRIVE_MS, 60, 1200, 0},
     {StepType::TURN_HEADING, 90, 0, 0},
     {StepType::DRIVE_MS, -40, 500, 0},
@@ -230,54 +179,17 @@ static Step gps_plan[kMaxSteps] = {
 };
 
 // --- BASIC MODE PLAN (EDIT THIS) ---
-static Step basic_plan[kMaxSteps] = {
+constexpr Step kDefaultBasicPlan[] = {
     {StepType::DRIVE_MS, 50, 1000, 0},
     {StepType::TURN_HEADING, 45, 0, 0},
     {StepType::DRIVE_MS, 50, 500, 0},
 };
 
-void run_plan(const Step* plan, std::size_t count) {
-    for (std::size_t i = 0; i < count; ++i) {
-        const Step& step = plan[i];
-        switch (step.type) {
-            case StepType::EMPTY:
-                break;
-            case StepType::DRIVE_MS:
-                left_drive.move(step.value1);
-                right_drive.move(step.value1);
-                pros::delay(step.value2);
-                stop_drive();
-                break;
-            case StepType::TANK_MS:
-                left_drive.move(step.value1);
-                right_drive.move(step.value2);
-                pros::delay(step.value3);
-                stop_drive();
-                break;
-            case StepType::TURN_HEADING:
-                turn_to_heading(step.value1, 60);
-                break;
-            case StepType::WAIT_MS:
-                pros::delay(step.value1);
-                break;
-            case StepType::INTAKE_ON:
-                intake_left.move(127);
-                intake_right.move(127);
-                break;
-            case StepType::INTAKE_OFF:
-                intake_left.brake();
-                intake_right.brake();
-                break;
-            case StepType::OUTTAKE_ON:
-                intake_left.move(-127);
-                intake_right.move(-127);
-                break;
-            case StepType::OUTTAKE_OFF:
-                intake_left.brake();
-                intake_right.brake();
-                break;
-        }
-    }
+// Compiled at the start of each run, since the menu edits plans in place.
+void run_plan(const Step* steps, std::size_t count) {
+    std::vector<plan::Instr> program;
+    plan::compile(steps, count, &program);
+    plan::run(program, kRobot, 0);
 }
 
 // =====================================================
@@ -287,191 +199,67 @@ void run_plan(const Step* plan, std::size_t count) {
 constexpr int kScreenW = 480;
 constexpr int kScreenH = 240;
 
-struct Rect {
-    int x;
-    int y;
-    int w;
-    int h;
-};
-
-bool hit_test(const Rect& r, int x, int y) {
-    return x >= r.x && x <= (r.x + r.w) && y >= r.y && y <= (r.y + r.h);
-}
-
-const char* step_type_name(StepType type) {
-    switch (type) {
-        case StepType::EMPTY: return "EMPTY";
-        case StepType::DRIVE_MS: return "DRIVE_MS";
-        case StepType::TANK_MS: return "TANK_MS";
-        case StepType::TURN_HEADING: return "TURN_HEADING";
-        case StepType::WAIT_MS: return "WAIT_MS";
-        case StepType::INTAKE_ON: return "INTAKE_ON";
-        case StepType::INTAKE_OFF: return "INTAKE_OFF";
-        case StepType::OUTTAKE_ON: return "OUTTAKE_ON";
-        case StepType::OUTTAKE_OFF: return "OUTTAKE_OFF";
-        default: return "UNKNOWN";
-    }
-}
-
-StepType prev_step_type(StepType type) {
-    switch (type) {
-        case StepType::EMPTY: return StepType::OUTTAKE_OFF;
-        case StepType::DRIVE_MS: return StepType::EMPTY;
-        case StepType::TANK_MS: return StepType::DRIVE_MS;
-        case StepType::TURN_HEADING: return StepType::TANK_MS;
-        case StepType::WAIT_MS: return StepType::TURN_HEADING;
-        case StepType::INTAKE_ON: return StepType::WAIT_MS;
-        case StepType::INTAKE_OFF: return StepType::INTAKE_ON;
-        case StepType::OUTTAKE_ON: return StepType::INTAKE_OFF;
-        case StepType::OUTTAKE_OFF: return StepType::OUTTAKE_ON;
-        default: return StepType::DRIVE_MS;
-    }
-}
-
-StepType next_step_type(StepType type) {
-    switch (type) {
-        case StepType::EMPTY: return StepType::DRIVE_MS;
-        case StepType::DRIVE_MS: return StepType::TANK_MS;
-        case StepType::TANK_MS: return StepType::TURN_HEADING;
-        case StepType::TURN_HEADING: return StepType::WAIT_MS;
-        case StepType::WAIT_MS: return StepType::INTAKE_ON;
-        case StepType::INTAKE_ON: return StepType::INTAKE_OFF;
-        case StepType::INTAKE_OFF: return StepType::OUTTAKE_ON;
-        case StepType::OUTTAKE_ON: return StepType::OUTTAKE_OFF;
-        case StepType::OUTTAKE_OFF: return StepType::EMPTY;
-        default: return StepType::DRIVE_MS;
-    }
-}
-
-StepType parse_step_type(const std::string& token) {
-    if (token == "EMPTY") return StepType::EMPTY;
-    if (token == "DRIVE_MS") return StepType::DRIVE_MS;
-    if (token == "TANK_MS") return StepType::TANK_MS;
-    if (token == "TURN_HEADING") return StepType::TURN_HEADING;
-    if (token == "WAIT_MS") return StepType::WAIT_MS;
-    if (token == "INTAKE_ON") return StepType::INTAKE_ON;
-    if (token == "INTAKE_OFF") return StepType::INTAKE_OFF;
-    if (token == "OUTTAKE_ON") return StepType::OUTTAKE_ON;
-    if (token == "OUTTAKE_OFF") return StepType::OUTTAKE_OFF;
-    return StepType::EMPTY;
-}
-
-const char* slot_filename(int slot) {
-    switch (slot) {
-        case 0: return kSlot1File;
-        case 1: return kSlot2File;
-        case 2: return kSlot3File;
-        default: return kSlot1File;
-    }
-}
+using ui::Rect;
+using ui::draw_button;
+using ui::hit_test;
 
 int read_slot_file() {
-    FILE* file = sd_open("auton_slot.txt", "r");
+    FILE* file = sd::open(plan::kSlotIndexFile, "r");
     if (!file) {
         return 0;
     }
-    int slot = 1;
-    if (std::fscanf(file, "%d", &slot) != 1) {
-        std::fclose(file);
-        return 0;
-    }
+    const int slot = plan::read_slot(file);
     std::fclose(file);
-    if (slot < 1 || slot > kSlotCount) {
-        return 0;
-    }
-    return slot - 1;
+    return slot;
 }
 
 void write_slot_file(int slot) {
-    FILE* file = sd_open("auton_slot.txt", "w");
+    FILE* file = sd::open(plan::kSlotIndexFile, "w");
     if (!file) {
         return;
     }
-    std::fprintf(file, "%d\n", slot + 1);
+    plan::write_slot(file, slot);
     std::fclose(file);
 }
 
-Step* active_plan(int* count) {
-    if (g_auton_mode == AutonMode::GPS_MODE) {
-        *count = static_cast<int>(kMaxSteps);
-        return gps_plan;
-    }
-    *count = static_cast<int>(kMaxSteps);
-    return basic_plan;
+plan::PlanBuffer& plan_for(AutonMode mode) {
+    return mode == AutonMode::GPS_MODE ? g_gps_plan : g_basic_plan;
 }
 
-constexpr int kRecordSampleMs = 100;
-constexpr int kRecordDeadband = 5;
-constexpr int kRecordSnap = 5;
+// The recorder keeps every control period's drive powers, encoder distances
+// and heading, then fits them into steps when it stops (see
+// bonkers/drive_trace.hpp). power_error is how far a step may stray from the
+// driver's sticks: smaller keeps more detail in more steps.
+constexpr std::uint32_t kRecordSampleMs = 10;
+constexpr std::size_t kRecordSamples = 6000; // the last minute of driving
+constexpr trace::FitOptions kRecordFit = {.sample_ms = kRecordSampleMs, .power_error = 8};
 
 pros::Mutex g_plan_mutex;
-bool g_recording = false;
+// Read by the opcontrol task, which records, as well as the menu task.
+std::atomic<bool> g_recording{false};
 bool g_record_full = false;
-bool g_record_ui_dirty = false;
+std::atomic<bool> g_record_ui_dirty{false};
 AutonMode g_record_mode = AutonMode::GPS_MODE;
-int g_record_index = 0;
-
-int snap_speed(int value) {
-    if (std::abs(value) <= kRecordDeadband) {
-        return 0;
-    }
-    const int snapped = static_cast<int>(std::round(static_cast<double>(value) / kRecordSnap)) * kRecordSnap;
-    return std::max(-127, std::min(127, snapped));
-}
 
-void clear_plan(Step* plan, int count) {
-    for (int i = 0; i < count; ++i) {
-        plan[i] = {StepType::EMPTY, 0, 0, 0};
-    }
-}
+// Guarded by g_plan_mutex while recording. Once g_recording is cleared the
+// opcontrol task stops pushing, and it belongs to the menu task, which
+// starts and stops every recording.
+trace::Ring<kRecordSamples> g_record_trace;
 
 bool load_plans_from_sd(const char* filename) {
-    FILE* file = sd_open(filename, "r");
+    FILE* file = sd::open(filename, "r");
     if (!file) {
         return false;
     }
 
     g_plan_mutex.take();
-    clear_plan(gps_plan, static_cast<int>(kMaxSteps));
-    clear_plan(basic_plan, static_cast<int>(kMaxSteps));
-
-    enum class Section { NONE, GPS, BASIC };
-    Section section = Section::NONE;
-    int gps_idx = 0;
-    int basic_idx = 0;
-
-    char line[128];
-    while (std::fgets(line, sizeof(line), file)) {
-        std::string s(line);
-        if (s.find("[GPS]") != std::string::npos) {
-            section = Section::GPS;
-            continue;
-        }
-        if (s.find("[BASIC]") != std::string::npos) {
-            section = Section::BASIC;
-            continue;
-        }
-        if (s.empty() || s[0] == '#') {
-            continue;
-        }
-
-        char type_str[32];
-        int v1 = 0;
-        int v2 = 0;
-        int v3 = 0;
-        const int fields = std::sscanf(s.c_str(), "%31[^,],%d,%d,%d", type_str, &v1, &v2, &v3);
-        if (fields >= 3) {
-            Step step{parse_step_type(type_str), v1, v2, v3};
-            if (section == Section::GPS && gps_idx < static_cast<int>(kMaxSteps)) {
-                gps_plan[gps_idx++] = step;
-            } else if (section == Section::BASIC && basic_idx < static_cast<int>(kMaxSteps)) {
-                basic_plan[basic_idx++] = step;
-            }
-        }
-    }
-
-    std::fclose(file);
+    plan::read_plans(file, &g_gps_plan, &g_basic_plan, filename);
+    const std::size_t dropped = g_gps_plan.dropped() + g_basic_plan.dropped();
     g_plan_mutex.give();
+    std::fclose(file);
+    if (dropped > 0) {
+        std::printf("[plan] %s: %zu steps past the %zu-step limit were dropped\n", filename, dropped, kPlanCapacity);
+    }
     g_record_ui_dirty = true;
     return true;
 }
@@ -479,63 +267,66 @@ bool load_plans_from_sd(const char* filename) {
 void start_recording() {
     g_plan_mutex.take();
     g_record_mode = g_auton_mode;
-    Step* plan = (g_record_mode == AutonMode::GPS_MODE) ? gps_plan : basic_plan;
-    clear_plan(plan, static_cast<int>(kMaxSteps));
-    g_record_index = 0;
+    g_record_trace.clear();
     g_record_full = false;
     g_recording = true;
     g_record_ui_dirty = true;
     g_plan_mutex.give();
 }
 
-void stop_recording() {
+// Drops the recording without touching the plan.
+void cancel_recording() {
+    g_plan_mutex.take();
     g_recording = false;
     g_record_ui_dirty = true;
+    g_plan_mutex.give();
 }
 
-void record_sample(int left_speed, int right_speed) {
+// Replaces the recorded mode's plan with the fitted steps. False if nothing
+// was recorded.
+bool stop_recording() {
+    g_plan_mutex.take();
     if (!g_recording) {
-        return;
+        g_plan_mutex.give();
+        return false;
     }
+    g_recording = false;
+    g_record_ui_dirty = true;
+    g_plan_mutex.give();
 
-    const int left = snap_speed(left_speed);
-    const int right = snap_speed(right_speed);
-
+    const std::size_t samples = g_record_trace.size();
+    const std::size_t overwritten = g_record_trace.overwritten();
+    g_scratch_plan.clear();
+    const bool fitted = trace::fit(g_record_trace.linearize(), samples, kRecordFit, &g_scratch_plan);
+    const std::size_t count = g_scratch_plan.size();
     g_plan_mutex.take();
-    Step* plan = (g_record_mode == AutonMode::GPS_MODE) ? gps_plan : basic_plan;
+    plan_for(g_record_mode).assign(g_scratch_plan.data(), count);
+    g_record_full = !fitted;
+    g_plan_mutex.give();
 
-    if (g_record_index == 0 && plan[0].type == StepType::EMPTY) {
-        plan[0] = {StepType::TANK_MS, left, right, kRecordSampleMs};
-        g_record_index = 1;
-        g_plan_mutex.give();
-        return;
+    std::printf("[record] %zu samples -> %zu steps%s\n", samples, count, g_record_full ? ", plan full" : "");
+    if (overwritten > 0) {
+        std::printf("[record] kept the last %" PRIu32 " ms; %zu earlier samples were overwritten\n",
+                    static_cast<std::uint32_t>(samples * kRecordSampleMs), overwritten);
     }
+    return samples > 0;
+}
 
-    Step& last = plan[g_record_index - 1];
-    if (last.type == StepType::TANK_MS && last.value1 == left && last.value2 == right) {
-        last.value3 += kRecordSampleMs;
-        g_plan_mutex.give();
+void record_sample(int left_speed, int right_speed) {
+    if (!g_recording) {
         return;
     }
-
-    if (g_record_index >= static_cast<int>(kMaxSteps)) {
-        g_recording = false;
-        g_record_full = true;
-        g_record_ui_dirty = true;
-        g_plan_mutex.give();
-        return;
+    const trace::Sample sample = {static_cast<std::int8_t>(std::max(-127, std::min(127, left_speed))),
+                                  static_cast<std::int8_t>(std::max(-127, std::min(127, right_speed))),
+                                  static_cast<float>(vm_left_mm(nullptr)), static_cast<float>(vm_right_mm(nullptr)),
+                                  static_cast<float>(imu.get_heading())};
+    g_plan_mutex.take();
+    if (g_recording) {
+        g_record_trace.push(sample);
     }
-
-    plan[g_record_index++] = {StepType::TANK_MS, left, right, kRecordSampleMs};
     g_plan_mutex.give();
 }
 
-void draw_button(const Rect& r, const char* label, std::uint32_t color) {
-    pros::screen::set_pen(color);
-    pros::screen::draw_rect(r.x, r.y, r.x + r.w, r.y + r.h);
-    pros::screen::print(TEXT_MEDIUM, r.x + 6, r.y + 8, label);
-}
-
 Rect record_button_rect() {
     return {10, 180, 140, 30};
 }
@@ -551,7 +342,48 @@ void draw_record_button() {
     draw_button(rec_btn, label, color);
 }
 
-void draw_menu(AutonMode mode, int step_index, Step* plan, std::size_t count, int slot) {
+// The editor pages through plans this many steps at a time.
+constexpr int kPageSteps = 10;
+
+// How far one V1/V2 tap moves a value. V3 always moves 50 (ms).
+struct EditSteps {
+    int value1;
+    int value2;
+};
+
+EditSteps edit_steps(StepType type) {
+    switch (type) {
+        case StepType::DRIVE_DIST:
+            return {50, 5}; // mm, power
+        case StepType::TURN_RELATIVE:
+            return {5, 5}; // degrees, power
+        case StepType::ARC:
+            return {5, 50}; // degrees, radius mm
+        default:
+            return {5, 50};
+    }
+}
+
+// Index one past the last step is the "new step" slot: editing it appends.
+int last_edit_index(const plan::PlanBuffer& plan) {
+    const int count = static_cast<int>(plan.size());
+    return plan.full() ? count - 1 : count;
+}
+
+// True when the step at `index` runs inside a PARALLEL group.
+bool in_parallel_group(const plan::PlanBuffer& plan, int index) {
+    for (int i = std::min(index, static_cast<int>(plan.size())) - 1; i >= 0; --i) {
+        if (plan[i].type == StepType::PARALLEL) {
+            return true;
+        }
+        if (plan[i].type == StepType::END_PARALLEL) {
+            return false;
+        }
+    }
+    return false;
+}
+
+void draw_menu(AutonMode mode, int step_index, const plan::PlanBuffer& plan, int slot) {
     pros::screen::set_pen(0x00000000);
     pros::screen::fill_rect(0, 0, kScreenW - 1, kScreenH - 1);
 
@@ -578,8 +410,10 @@ void draw_menu(AutonMode mode, int step_index, Step* plan, std::size_t count, in
     const Rect v2p_btn{380, 100, 50, 30};
     const Rect v3m_btn{320, 140, 50, 30};
     const Rect v3p_btn{380, 140, 50, 30};
-    const Rect rec_btn = record_button_rect();
     const Rect clr_btn{170, 180, 140, 30};
+    const Rect pgm_btn{320, 180, 50, 30};
+    const Rect pgp_btn{380, 180, 50, 30};
+    const Rect log_btn{438, 180, 36, 30};
 
     draw_button(prev_btn, "PREV", 0x00FFFFFF);
     draw_button(next_btn, "NEXT", 0x00FFFFFF);
@@ -592,51 +426,122 @@ void draw_menu(AutonMode mode, int step_index, Step* plan, std::size_t count, in
     draw_button(v3p_btn, "V3+", 0x00FFFFFF);
     draw_record_button();
     draw_button(clr_btn, "CLEAR", 0x00FFFFFF);
+    draw_button(pgm_btn, "PG-", 0x00FFFFFF);
+    draw_button(pgp_btn, "PG+", 0x00FFFFFF);
+    draw_button(log_btn, "LOG", 0x00FFFF00);
+
+    step_index = std::max(0, std::min(step_index, last_edit_index(plan)));
+    const int count = static_cast<int>(plan.size());
+    const Step blank{StepType::EMPTY, 0, 0, 0};
+    const Step& step = step_index < count ? plan[step_index] : blank;
+    pros::screen::print(TEXT_MEDIUM, 10, 120, "STEP: %d / %d%s  PG %d/%d", step_index + 1, count,
+                        step_index < count ? "" : " (new)", step_index / kPageSteps + 1,
+                        std::max(count - 1, 0) / kPageSteps + 1);
+    const bool marker = step.type == StepType::PARALLEL || step.type == StepType::END_PARALLEL;
+    pros::screen::print(TEXT_MEDIUM, 10, 140, "TYPE: %s%s", step_type_name(step.type),
+                        !marker && in_parallel_group(plan, step_index) ? " (parallel)" : "");
+    pros::screen::print(TEXT_MEDIUM, 10, 160, "V1:%d  V2:%d  V3:%d", step.value1, step.value2, step.value3);
+    pros::screen::print(TEXT_MEDIUM, 10, 95, "SLOT: %d%s", slot + 1, g_record_full ? "  PLAN FULL" : "");
+}
 
-    if (step_index < 0) step_index = 0;
-    if (step_index >= static_cast<int>(count)) step_index = static_cast<int>(count) - 1;
+// Keeps robot_config.bin, when the card has one, in step with the slot and
+// plans chosen here, since Tahera loads it ahead of the text files.
+void sync_config_bundle(bool with_plans) {
+    FILE* file = sd::open(config::kBundleFile, "rb");
+    if (!file) {
+        return;
+    }
+    config::Config bundle;
+    const bool ok = config::read_bundle(file, &bundle);
+    std::fclose(file);
+    if (!ok) {
+        return;
+    }
 
-    const Step& step = plan[step_index];
-    pros::screen::print(TEXT_MEDIUM, 10, 120, "STEP: %d / %d", step_index + 1, static_cast<int>(count));
-    pros::screen::print(TEXT_MEDIUM, 10, 140, "TYPE: %s", step_type_name(step.type));
-    pros::screen::print(TEXT_MEDIUM, 10, 160, "V1:%d  V2:%d  V3:%d", step.value1, step.value2, step.value3);
-    pros::screen::print(TEXT_MEDIUM, 10, 95, "SLOT: %d", slot + 1);
+    bundle.active_slot = g_save_slot;
+    if (with_plans) {
+        config::SlotPlans& slot = bundle.slots[g_save_slot];
+        g_plan_mutex.take();
+        slot.gps.assign(g_gps_plan.data(), g_gps_plan.data() + g_gps_plan.size());
+        slot.basic.assign(g_basic_plan.data(), g_basic_plan.data() + g_basic_plan.size());
+        g_plan_mutex.give();
+        slot.loaded = true;
+    }
+    // Encoded first: opening the file truncates it, and a bundle that
+    // cannot be encoded must leave the old one in place.
+    std::vector<std::uint8_t> bytes;
+    if (!config::encode_bundle(bundle, &bytes)) {
+        std::printf("[config] %s left as it was; the plans do not fit a bundle\n", config::kBundleFile);
+        return;
+    }
+    file = sd::open(config::kBundleFile, "wb");
+    if (!config::write_bundle(file, bytes)) {
+        std::printf("[config] could not update %s\n", config::kBundleFile);
+    }
+    if (file) {
+        std::fclose(file);
+    }
 }
 
 bool save_plans_to_sd(const char* filename) {
-    FILE* file = sd_open(filename, "w");
+    FILE* file = sd::open(filename, "w");
     if (!file) return false;
 
     g_plan_mutex.take();
-    std::fprintf(file, "[GPS]\\n");
-    for (const auto& step : gps_plan) {
-        std::fprintf(file, "%s,%d,%d,%d\\n", step_type_name(step.type), step.value1, step.value2, step.value3);
-    }
-
-    std::fprintf(file, "[BASIC]\\n");
-    for (const auto& step : basic_plan) {
-        std::fprintf(file, "%s,%d,%d,%d\\n", step_type_name(step.type), step.value1, step.value2, step.value3);
-    }
-
+    const bool ok = plan::write_plans(file, g_gps_plan.data(), g_gps_plan.size(), g_basic_plan.data(),
+                                      g_basic_plan.size());
     g_plan_mutex.give();
     std::fclose(file);
     write_slot_file(g_save_slot);
-    return true;
+    sync_config_bundle(true);
+    return ok;
 }
 
+// Turns auton_import.bbl, a Basic Bonkers log copied onto the card, into the
+// current mode's plan and saves it to the selected slot. The roller buttons
+// mean what controller_mapping.txt makes them mean in Tahera.
+bool import_log() {
+    FILE* file = sd::open(log_plan::kImportFile, "rb");
+    if (!file) {
+        std::printf("[import] no %s on the card\n", log_plan::kImportFile);
+        return false;
+    }
+    log_plan::Options options;
+    options.fit = kRecordFit;
+    config::default_buttons(options.buttons);
+    FILE* mapping = sd::open(config::kButtonMapFile, "r");
+    config::read_buttons(mapping, options.buttons, config::kButtonMapFile);
+    if (mapping) {
+        std::fclose(mapping);
+    }
+
+    cancel_recording();
+    std::size_t samples = 0;
+    const bool ok = log_plan::read_log(file, options, &g_scratch_plan, &samples);
+    std::fclose(file);
+    if (!ok) {
+        std::printf("[import] %s is not a controller log\n", log_plan::kImportFile);
+        return false;
+    }
+    const std::size_t count = g_scratch_plan.size();
+    g_plan_mutex.take();
+    plan_for(g_auton_mode).assign(g_scratch_plan.data(), count);
+    g_record_full = g_scratch_plan.dropped() > 0;
+    g_plan_mutex.give();
+    std::printf("[import] %s: %zu samples -> %zu steps%s\n", log_plan::kImportFile, samples, count,
+                g_record_full ? ", plan full" : "");
+    return save_plans_to_sd(slot_filename(g_save_slot));
+}
 
 void menu_loop() {
     int step_index = 0;
-    draw_menu(g_auton_mode, step_index,
-              g_auton_mode == AutonMode::GPS_MODE ? gps_plan : basic_plan,
-              static_cast<int>(kMaxSteps), g_save_slot);
+    draw_menu(g_auton_mode, step_index, plan_for(g_auton_mode), g_save_slot);
 
     bool touch_armed = false;
 
     while (true) {
         if (g_record_ui_dirty) {
-            Step* plan = g_auton_mode == AutonMode::GPS_MODE ? gps_plan : basic_plan;
-            draw_menu(g_auton_mode, step_index, plan, kMaxSteps, g_save_slot);
+            draw_menu(g_auton_mode, step_index, plan_for(g_auton_mode), g_save_slot);
             g_record_ui_dirty = false;
         }
 
@@ -667,35 +572,45 @@ void menu_loop() {
             const Rect v3p_btn{380, 140, 50, 30};
             const Rect rec_btn = record_button_rect();
             const Rect clr_btn{170, 180, 140, 30};
+            const Rect pgm_btn{320, 180, 50, 30};
+            const Rect pgp_btn{380, 180, 50, 30};
+            const Rect log_btn{438, 180, 36, 30};
 
             if (hit_test(rec_btn, x, y)) {
                 if (g_recording) {
-                    stop_recording();
+                    if (stop_recording()) {
+                        save_plans_to_sd(slot_filename(g_save_slot));
+                    }
                 } else {
                     start_recording();
                 }
-                Step* plan = g_auton_mode == AutonMode::GPS_MODE ? gps_plan : basic_plan;
-                draw_menu(g_auton_mode, step_index, plan, kMaxSteps, g_save_slot);
+                draw_menu(g_auton_mode, step_index, plan_for(g_auton_mode), g_save_slot);
+                pros::delay(50);
+                continue;
+            }
+
+            if (hit_test(log_btn, x, y)) {
+                import_log();
+                step_index = 0;
+                draw_menu(g_auton_mode, step_index, plan_for(g_auton_mode), g_save_slot);
                 pros::delay(50);
                 continue;
             }
 
             if (hit_test(clr_btn, x, y)) {
-                stop_recording();
+                cancel_recording();
                 g_plan_mutex.take();
-                Step* plan = g_auton_mode == AutonMode::GPS_MODE ? gps_plan : basic_plan;
-                clear_plan(plan, static_cast<int>(kMaxSteps));
+                plan_for(g_auton_mode).clear();
+                g_record_full = false;
                 g_plan_mutex.give();
                 step_index = 0;
-                draw_menu(g_auton_mode, step_index, plan, kMaxSteps, g_save_slot);
+                draw_menu(g_auton_mode, step_index, plan_for(g_auton_mode), g_save_slot);
                 pros::delay(50);
                 continue;
             }
 
             if (g_recording) {
-                draw_menu(g_auton_mode, step_index,
-                          g_auton_mode == AutonMode::GPS_MODE ? gps_plan : basic_plan,
-                          kMaxSteps, g_save_slot);
+                draw_menu(g_auton_mode, step_index, plan_for(g_auton_mode), g_save_slot);
                 pros::delay(50);
                 continue;
             }
@@ -707,10 +622,11 @@ void menu_loop() {
             if (hit_test(slot1_btn, x, y)) {
                 g_save_slot = 0;
                 write_slot_file(g_save_slot);
+                sync_config_bundle(false);
                 if (!load_plans_from_sd(slot_filename(g_save_slot))) {
                     g_plan_mutex.take();
-                    clear_plan(gps_plan, static_cast<int>(kMaxSteps));
-                    clear_plan(basic_plan, static_cast<int>(kMaxSteps));
+                    g_gps_plan.clear();
+                    g_basic_plan.clear();
                     g_plan_mutex.give();
                     g_record_ui_dirty = true;
                 }
@@ -718,10 +634,11 @@ void menu_loop() {
             if (hit_test(slot2_btn, x, y)) {
                 g_save_slot = 1;
                 write_slot_file(g_save_slot);
+                sync_config_bundle(false);
                 if (!load_plans_from_sd(slot_filename(g_save_slot))) {
                     g_plan_mutex.take();
-                    clear_plan(gps_plan, static_cast<int>(kMaxSteps));
-                    clear_plan(basic_plan, static_cast<int>(kMaxSteps));
+                    g_gps_plan.clear();
+                    g_basic_plan.clear();
                     g_plan_mutex.give();
                     g_record_ui_dirty = true;
                 }
@@ -729,32 +646,46 @@ void menu_loop() {
             if (hit_test(slot3_btn, x, y)) {
                 g_save_slot = 2;
                 write_slot_file(g_save_slot);
+                sync_config_bundle(false);
                 if (!load_plans_from_sd(slot_filename(g_save_slot))) {
                     g_plan_mutex.take();
-                    clear_plan(gps_plan, static_cast<int>(kMaxSteps));
-                    clear_plan(basic_plan, static_cast<int>(kMaxSteps));
+                    g_gps_plan.clear();
+                    g_basic_plan.clear();
                     g_plan_mutex.give();
                     g_record_ui_dirty = true;
                 }
             }
 
-            Step* plan = g_auton_mode == AutonMode::GPS_MODE ? gps_plan : basic_plan;
-            const int count = static_cast<int>(kMaxSteps);
+            plan::PlanBuffer& plan = plan_for(g_auton_mode);
+            const int last = last_edit_index(plan);
 
             if (hit_test(prev_btn, x, y)) step_index = std::max(0, step_index - 1);
-            if (hit_test(next_btn, x, y)) step_index = std::min(count - 1, step_index + 1);
-
+            if (hit_test(next_btn, x, y)) step_index = std::min(last, step_index + 1);
+            if (hit_test(pgm_btn, x, y)) step_index = std::max(0, step_index - kPageSteps);
+            if (hit_test(pgp_btn, x, y)) step_index = std::min(last, step_index + kPageSteps);
+            step_index = std::max(0, std::min(step_index, last));
+
+            const bool edit = hit_test(type_btn, x, y) || hit_test(v1m_btn, x, y) || hit_test(v1p_btn, x, y) ||
+                              hit_test(v2m_btn, x, y) || hit_test(v2p_btn, x, y) || hit_test(v3m_btn, x, y) ||
+                              hit_test(v3p_btn, x, y);
             g_plan_mutex.take();
-            if (hit_test(type_btn, x, y)) plan[step_index].type = next_step_type(plan[step_index].type);
-            if (hit_test(v1m_btn, x, y)) plan[step_index].value1 -= 5;
-            if (hit_test(v1p_btn, x, y)) plan[step_index].value1 += 5;
-            if (hit_test(v2m_btn, x, y)) plan[step_index].value2 -= 50;
-            if (hit_test(v2p_btn, x, y)) plan[step_index].value2 += 50;
-            if (hit_test(v3m_btn, x, y)) plan[step_index].value3 -= 50;
-            if (hit_test(v3p_btn, x, y)) plan[step_index].value3 += 50;
+            if (edit && step_index == static_cast<int>(plan.size())) {
+                plan.push_back({StepType::EMPTY, 0, 0, 0});
+            }
+            if (edit && step_index < static_cast<int>(plan.size())) {
+                Step& step = plan[step_index];
+                if (hit_test(type_btn, x, y)) step.type = next_step_type(step.type);
+                const EditSteps steps = edit_steps(step.type);
+                if (hit_test(v1m_btn, x, y)) step.value1 -= steps.value1;
+                if (hit_test(v1p_btn, x, y)) step.value1 += steps.value1;
+                if (hit_test(v2m_btn, x, y)) step.value2 -= steps.value2;
+                if (hit_test(v2p_btn, x, y)) step.value2 += steps.value2;
+                if (hit_test(v3m_btn, x, y)) step.value3 -= 50;
+                if (hit_test(v3p_btn, x, y)) step.value3 += 50;
+            }
             g_plan_mutex.give();
 
-            draw_menu(g_auton_mode, step_index, plan, count, g_save_slot);
+            draw_menu(g_auton_mode, step_index, plan, g_save_slot);
         }
 
         pros::delay(50);
@@ -771,12 +702,17 @@ void menu_task_fn(void*) {
 
 void initialize() {
     pros::lcd::initialize();
+    left_drive.set_encoder_units_all(pros::v5::MotorUnits::degrees);
+    right_drive.set_encoder_units_all(pros::v5::MotorUnits::degrees);
     imu.reset(true);
     while (imu.is_calibrating()) {
         pros::delay(10);
     }
+    g_gps_plan.assign(kDefaultGpsPlan, std::size(kDefaultGpsPlan));
+    g_basic_plan.assign(kDefaultBasicPlan, std::size(kDefaultBasicPlan));
     g_save_slot = read_slot_file();
     load_plans_from_sd(slot_filename(g_save_slot));
+    sd::log_stats();
     static pros::Task menu_task(menu_task_fn, nullptr, TASK_PRIORITY_DEFAULT,
                                 TASK_STACK_DEPTH_DEFAULT, "AutonMenu");
 }
@@ -784,26 +720,19 @@ void initialize() {
 void autonomous() {
     update_auton_mode_from_controller();
 
-    if (g_auton_mode == AutonMode::GPS_MODE) {
-        run_plan(gps_plan, sizeof(gps_plan) / sizeof(gps_plan[0]));
-    } else {
-        run_plan(basic_plan, sizeof(basic_plan) / sizeof(basic_plan[0]));
-    }
+    const plan::PlanBuffer& steps = plan_for(g_auton_mode);
+    run_plan(steps.data(), steps.size());
 }
 
 void opcontrol() {
-    int record_timer_ms = 0;
+    std::uint32_t wake_ms = pros::millis();
     while (true) {
         update_auton_mode_from_controller();
 
         int left_y = master.get_analog(ANALOG_LEFT_Y);
         int right_y = master.get_analog(ANALOG_RIGHT_Y);
 
-        record_timer_ms += 20;
-        if (record_timer_ms >= kRecordSampleMs) {
-            record_timer_ms = 0;
-            record_sample(left_y, right_y);
-        }
+        record_sample(left_y, right_y);
 
         left_drive.move(left_y);
         right_drive.move(right_y);
@@ -826,6 +755,7 @@ void opcontrol() {
             intake_right.brake();
         }
 
-        pros::delay(20);
+        // The recorder samples once a loop, so the loop keeps its period.
+        pros::Task::delay_until(&wake_ms, kRecordSampleMs);
     }
 }
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "bonkers/log_format.hpp"
+#include "pros/rtos.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+
+namespace logger {
+constexpr std::size_t kRecordBytes = 32;   // one ring slot, length byte included
+constexpr std::size_t kRingRecords = 512;  // power of two; ~2.5 s of match at 5 ms samples
+constexpr std::size_t kBlockBytes = 4096;  // staging block, a whole number of SD sectors
+constexpr std::uint32_t kFlushIntervalMs = 250;
+
+static_assert(ctrl_log::kMaxFrameSize <= kBlockBytes, "a log frame must fit the staging block");
+static_assert(ctrl_log::kMaxRecordSize < kRecordBytes, "a log record must fit a ring slot");
+
+struct WriterStats {
+    std::uint32_t records;
+    std::uint32_t bytes;          // in frames the card took whole
+    std::uint32_t writes;         // fwrite calls, one frame each
+    std::uint32_t short_writes;   // frames fwrite did not take whole: a full or pulled card
+    std::uint32_t failed_flushes; // fflush calls that failed
+    std::uint32_t max_write_us;   // slowest fwrite + fflush, i.e. the stall the loop no longer sees
+};
+
+// Moves SD writes off the control loop. The loop copies fixed-size records
+// into a single-producer/single-consumer ring and never waits; a
+// low-priority task drains the ring into a sector-sized block and writes it
+// as one CRC-checked ctrl_log frame when it fills or every flush interval,
+// so a power cut loses at most that interval. When the ring is full the
+// record is dropped and counted instead of blocking the loop.
+class LogWriter {
+    public:
+        // Takes ownership of `file`, positioned just past the log header;
+        // stop() closes it. `session_id` must match the header.
+        void start(FILE* file, std::uint32_t session_id, std::uint32_t flush_interval_ms = kFlushIntervalMs);
+
+        // Control-loop side. Records longer than kRecordBytes - 1 are cut.
+        bool push(const void* data, std::size_t size);
+
+        // Drains everything pushed so far, writes the end frame, flushes
+        // and closes the file. Returns false if the writer did not finish
+        // within the timeout.
+        bool stop();
+
+        bool running() const { return m_task.has_value() && !m_stopped.load(); }
+        std::uint32_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+        // Only stable after stop().
+        const WriterStats& stats() const { return m_stats; }
+    private:
+        struct Record {
+            std::uint8_t size;
+            char data[kRecordBytes - 1];
+        };
+
+        void run();
+        bool pop(Record* out);
+        void append(const Record& record);
+        void write_block(bool flush);
+        void write_frame(std::size_t payload_bytes);
+
+        FILE* m_file = nullptr;
+        std::optional<pros::Task> m_task;
+        Record m_ring[kRingRecords];
+        std::atomic<std::uint32_t> m_head{0}; // written by the producer only
+        std::atomic<std::uint32_t> m_tail{0}; // written by the writer task only
+        std::atomic<std::uint32_t> m_dropped{0};
+        std::atomic<bool> m_stopping{false};
+        std::atomic<bool> m_stopped{false};
+        std::uint8_t m_block[kBlockBytes]; // frame header, payload, CRC
+        std::size_t m_block_used = 0;      // payload bytes
+        std::uint32_t m_session_id = 0;
+        std::uint16_t m_frame_sequence = 0;
+        std::uint32_t m_flush_interval_ms = kFlushIntervalMs;
+        std::uint32_t m_last_flush_ms = 0;
+        WriterStats m_stats{};
+};
+} // namespace logger
@@ -0,0 +1,125 @@
+#include "log_writer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace logger {
+namespace {
+constexpr std::uint32_t kRingMask = kRingRecords - 1;
+constexpr std::uint32_t kIdleWaitMs = 50;
+constexpr std::uint32_t kStopTimeoutMs = 2000;
+
+static_assert((kRingRecords & kRingMask) == 0, "kRingRecords must be a power of two");
+} // namespace
+
+void LogWriter::start(FILE* file, std::uint32_t session_id, std::uint32_t flush_interval_ms) {
+    if (m_task || !file) {
+        return;
+    }
+    m_file = file;
+    m_session_id = session_id;
+    m_flush_interval_ms = flush_interval_ms;
+    m_last_flush_ms = pros::millis();
+    m_task.emplace([this] { run(); }, TASK_PRIORITY_DEFAULT - 2, TASK_STACK_DEPTH_DEFAULT, "log writer");
+}
+
+bool LogWriter::push(const void* data, std::size_t size) {
+    const std::uint32_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= kRingRecords) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    Record& slot = m_ring[head & kRingMask];
+    slot.size = static_cast<std::uint8_t>(std::min(size, sizeof(slot.data)));
+    std::memcpy(slot.data, data, slot.size);
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogWriter::stop() {
+    if (!m_task) {
+        return true;
+    }
+    m_stopping.store(true, std::memory_order_release);
+    m_task->notify();
+    const std::uint32_t start_ms = pros::millis();
+    while (!m_stopped.load() && pros::millis() - start_ms < kStopTimeoutMs) {
+        pros::delay(5);
+    }
+    return m_stopped.load();
+}
+
+void LogWriter::run() {
+    while (true) {
+        // Read the flag before draining: everything pushed before stop()
+        // is then guaranteed to be in the ring for this pass.
+        const bool stopping = m_stopping.load(std::memory_order_acquire);
+        Record record;
+        while (pop(&record)) {
+            append(record);
+        }
+
+        if (stopping) {
+            write_block(false);
+            write_frame(0);
+            write_block(true);
+            std::fclose(m_file);
+            m_file = nullptr;
+            m_stopped.store(true);
+            return;
+        }
+        if (pros::millis() - m_last_flush_ms >= m_flush_interval_ms) {
+            write_block(true);
+        }
+        pros::Task::notify_take(true, kIdleWaitMs);
+    }
+}
+
+bool LogWriter::pop(Record* out) {
+    const std::uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire)) {
+        return false;
+    }
+    *out = m_ring[tail & kRingMask];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+void LogWriter::append(const Record& record) {
+    if (m_block_used + record.size > ctrl_log::kMaxFramePayload) {
+        write_block(false);
+    }
+    std::memcpy(m_block + ctrl_log::kFrameHeaderSize + m_block_used, record.data, record.size);
+    m_block_used += record.size;
+    ++m_stats.records;
+}
+
+void LogWriter::write_block(bool flush) {
+    if (m_block_used == 0 && !flush) {
+        return;
+    }
+    const std::uint64_t start_us = pros::micros();
+    if (m_block_used > 0) {
+        write_frame(m_block_used);
+        m_block_used = 0;
+    }
+    if (flush) {
+        if (std::fflush(m_file) != 0) {
+            ++m_stats.failed_flushes;
+        }
+        m_last_flush_ms = pros::millis();
+    }
+    m_stats.max_write_us = std::max(m_stats.max_write_us, static_cast<std::uint32_t>(pros::micros() - start_us));
+}
+
+// An empty frame is the end marker stop() writes.
+void LogWriter::write_frame(std::size_t payload_bytes) {
+    const std::size_t size = ctrl_log::seal_frame(m_block, payload_bytes, m_frame_sequence++, m_session_id);
+    ++m_stats.writes;
+    if (std::fwrite(m_block, 1, size, m_file) != size) {
+        ++m_stats.short_writes;
+        return;
+    }
+    m_stats.bytes += static_cast<std::uint32_t>(size);
+}
+} // namespace logger
@@ -1,12 +1,25 @@
 #include "main.h"
+#include "bonkers/log_format.hpp"
+#include "bonkers/sd_path.hpp"
+#include "log_writer.hpp"
 
+#include <cinttypes>
+#include <cmath>
 #include <cstdio>
 #include <string>
 #include <vector>
 
 namespace {
-constexpr int kLogIntervalMs = 20;
-constexpr int kBufferLimit = 25;
+// Sampling period: 5, 10 or 20 ms. The loop wakes on a fixed schedule and
+// every sample carries its own pros::micros() timestamp.
+constexpr std::uint32_t kSamplePeriodMs = 10;
+static_assert(kSamplePeriodMs == 5 || kSamplePeriodMs == 10 || kSamplePeriodMs == 20,
+              "kSamplePeriodMs must be 5, 10 or 20");
+// Also record drive velocity and current and the IMU heading, so replays
+// can follow what the robot measured instead of integrating stick input.
+constexpr bool kCaptureTelemetry = false;
+constexpr std::uint32_t kLogFlushMs = 250;        // most a power cut can lose
+constexpr long kLogPreallocBytes = 1024L * 1024;  // 3.5 min at 5 ms with telemetry; grows past that
 constexpr int kDisplayIntervalMs = 100;
 constexpr int kHistoryStartLine = 3;
 constexpr int kHistoryLines = 5;
@@ -15,56 +28,166 @@ constexpr const char* kLogPrefix = "bonkers_log_";
 
 std::string make_log_path() {
     char path[128];
-    std::snprintf(path, sizeof(path), "%s%s%u.txt", kLogDir, kLogPrefix, pros::millis());
+    std::snprintf(path, sizeof(path), "%s%s%u.bbl", kLogDir, kLogPrefix, pros::millis());
     return std::string(path);
 }
 
-FILE* open_log_file(std::string* out_path) {
+FILE* open_log_file(std::string* out_path, std::uint32_t session_id) {
     if (out_path == nullptr) {
         return nullptr;
     }
 
     *out_path = make_log_path();
-    FILE* file = std::fopen(out_path->c_str(), "w");
+    FILE* file = sd::open(out_path->c_str(), "wb");
     if (!file) {
         return nullptr;
     }
 
+    ctrl_log::Header header{};
+    header.version = ctrl_log::kVersion;
+    header.period_ms = kSamplePeriodMs;
+    header.axis_channels[0] = ctrl_log::kAnalogRightX;
+    header.axis_channels[1] = ctrl_log::kAnalogRightY;
+    header.axis_channels[2] = ctrl_log::kAnalogLeftY;
+    header.axis_channels[3] = ctrl_log::kAnalogLeftX;
+    header.left_axis = 2;  // tank drive: left stick Y
+    header.right_axis = 1; // right stick Y
+    header.program_id = ctrl_log::kProgramBasicBonkers;
+    header.session_id = session_id;
+    header.flush_ms = kLogFlushMs;
+    header.telemetry = kCaptureTelemetry
+                           ? ctrl_log::kTelemetryVelocity | ctrl_log::kTelemetryCurrent | ctrl_log::kTelemetryHeading
+                           : 0;
+    std::uint8_t bytes[ctrl_log::kHeaderSize];
+    ctrl_log::write_header(header, bytes);
+    if (std::fwrite(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) {
+        std::fclose(file);
+        return nullptr;
+    }
+    // Claim the clusters now so the writer never extends the FAT chain
+    // mid-match. A card that refuses just grows the file as it goes.
+    if (!sd::preallocate(file, kLogPreallocBytes)) {
+        std::printf("[log] preallocation failed, writing unreserved\n");
+    }
     std::fflush(file);
 
     return file;
 }
 
+// Logged buttons in mask-bit order, with the history line shown on a press.
+struct LoggedButton {
+    pros::controller_digital_e_t button;
+    const char* history;
+};
+
+constexpr LoggedButton kLoggedButtons[ctrl_log::kButtonCount] = {
+    {pros::E_CONTROLLER_DIGITAL_L1, "BTN_L1 : INTAKE_IN"},
+    {pros::E_CONTROLLER_DIGITAL_L2, "BTN_L2 : INTAKE_OUT"},
+    {pros::E_CONTROLLER_DIGITAL_R1, "BTN_R1 : OUTTAKE_OUT"},
+    {pros::E_CONTROLLER_DIGITAL_R2, "BTN_R2 : OUTTAKE_IN"},
+    {pros::E_CONTROLLER_DIGITAL_UP, "BTN_UP : NO_ACTION"},
+    {pros::E_CONTROLLER_DIGITAL_DOWN, "BTN_DOWN : NO_ACTION"},
+    {pros::E_CONTROLLER_DIGITAL_LEFT, "BTN_LEFT : NO_ACTION"},
+    {pros::E_CONTROLLER_DIGITAL_RIGHT, "BTN_RIGHT : NO_ACTION"},
+    {pros::E_CONTROLLER_DIGITAL_X, "BTN_X : NO_ACTION"},
+    {pros::E_CONTROLLER_DIGITAL_B, "BTN_B : NO_ACTION"},
+    {pros::E_CONTROLLER_DIGITAL_Y, "BTN_Y : NO_ACTION"},
+    {pros::E_CONTROLLER_DIGITAL_A, "BTN_A : NO_ACTION"},
+};
+
 void display_line(std::int16_t line, const char* text) {
     pros::lcd::set_text(line, text);
     pros::screen::print(TEXT_MEDIUM, line + 1, "%s", text);
 }
 
-void log_event(FILE* file,
-               std::vector<std::string>& buffer,
-               const char* event,
-               const char* value) {
-    if (!file || !event || !value) {
-        return;
+logger::LogWriter g_log_writer;
+
+// The Tahera Sequence's drive and IMU ports. Only read, never commanded.
+pros::MotorGroup g_left_drive({-1, -3}, pros::v5::MotorGears::blue);
+pros::MotorGroup g_right_drive({4, 6}, pros::v5::MotorGears::blue);
+pros::Imu g_imu(11);
+
+// Loop period against kSamplePeriodMs, measured with pros::micros().
+struct LoopJitter {
+    std::uint64_t last_us = 0;
+    std::uint32_t ticks = 0;
+    std::uint32_t max_us = 0;
+
+    void tick() {
+        const std::uint64_t now_us = pros::micros();
+        if (last_us != 0) {
+            const std::int64_t period_us = static_cast<std::int64_t>(now_us - last_us);
+            const std::int64_t error_us = period_us - static_cast<std::int64_t>(kSamplePeriodMs) * 1000;
+            const std::uint32_t jitter_us = static_cast<std::uint32_t>(error_us < 0 ? -error_us : error_us);
+            max_us = jitter_us > max_us ? jitter_us : max_us;
+            ++ticks;
+        }
+        last_us = now_us;
     }
+};
 
-    char row[96];
-    const int written = std::snprintf(row, sizeof(row), "%s : %s\n", event, value);
-    if (written > 0) {
-        buffer.emplace_back(row, static_cast<std::size_t>(written));
+std::int8_t clamp_axis(int value) {
+    return static_cast<std::int8_t>(value < -127 ? -127 : (value > 127 ? 127 : value));
+}
+
+// Averages velocity and sums current over one side; false if any motor
+// did not answer.
+bool read_drive_side(const pros::MotorGroup& side, std::int16_t* velocity, std::uint16_t* current) {
+    const int count = side.size();
+    if (count <= 0) {
+        return false;
     }
+    double rpm = 0.0;
+    std::int32_t milliamps = 0;
+    for (int i = 0; i < count; ++i) {
+        const double motor_rpm = side.get_actual_velocity(static_cast<std::uint8_t>(i));
+        const std::int32_t motor_ma = side.get_current_draw(static_cast<std::uint8_t>(i));
+        if (motor_rpm == PROS_ERR_F || motor_ma == PROS_ERR) {
+            return false;
+        }
+        rpm += motor_rpm;
+        milliamps += motor_ma;
+    }
+    *velocity = static_cast<std::int16_t>(std::lround(rpm / count * 10.0));
+    *current = static_cast<std::uint16_t>(milliamps < 0 ? 0 : (milliamps > 0xFFFF ? 0xFFFF : milliamps));
+    return true;
 }
 
-void flush_buffer(FILE* file, std::vector<std::string>& buffer) {
-    if (!file || buffer.empty()) {
-        return;
+ctrl_log::Telemetry read_telemetry() {
+    ctrl_log::Telemetry telemetry{};
+    if (read_drive_side(g_left_drive, &telemetry.left_velocity, &telemetry.left_current)) {
+        telemetry.valid |= ctrl_log::kValidLeftDrive;
+    }
+    if (read_drive_side(g_right_drive, &telemetry.right_velocity, &telemetry.right_current)) {
+        telemetry.valid |= ctrl_log::kValidRightDrive;
     }
+    const double heading = g_imu.get_heading(); // PROS_ERR_F while calibrating
+    if (heading != PROS_ERR_F) {
+        telemetry.heading = static_cast<std::uint16_t>(std::lround(heading * 100.0) % 36000);
+        telemetry.valid |= ctrl_log::kValidImu;
+    }
+    return telemetry;
+}
 
-    for (const auto& line : buffer) {
-        std::fwrite(line.data(), 1, line.size(), file);
+void push_record(const ctrl_log::Sample& sample) {
+    std::uint8_t bytes[ctrl_log::kMaxRecordSize];
+    ctrl_log::write_sample(sample, bytes);
+    std::size_t size = ctrl_log::kSampleSize;
+    if (kCaptureTelemetry) {
+        ctrl_log::write_telemetry(read_telemetry(), bytes + size);
+        size += ctrl_log::kTelemetrySize;
     }
-    std::fflush(file);
-    buffer.clear();
+    g_log_writer.push(bytes, size);
+}
+
+void report_logging(const LoopJitter& jitter) {
+    const logger::WriterStats& stats = g_log_writer.stats();
+    std::printf("[log] %" PRIu32 " ticks at %" PRIu32 " ms, loop period max jitter %" PRIu32 " us\n", jitter.ticks,
+                kSamplePeriodMs, jitter.max_us);
+    std::printf("[log] writer: %" PRIu32 " records (%" PRIu32 " dropped), %" PRIu32 " bytes in %" PRIu32
+                " writes (%" PRIu32 " short, %" PRIu32 " failed flushes), slowest write %" PRIu32 " us\n",
+                stats.records, g_log_writer.dropped(), stats.bytes, stats.writes, stats.short_writes,
+                stats.failed_flushes, stats.max_write_us);
 }
 }
 
@@ -77,6 +200,9 @@ void initialize() {
     pros::screen::set_pen(0x00FFFFFF);
     pros::screen::erase();
     display_line(0, "Basic Bonkers Logger");
+    if (kCaptureTelemetry) {
+        g_imu.reset(); // calibrates in the background; headings are marked invalid until done
+    }
 }
 
 void disabled() {}
@@ -89,7 +215,10 @@ void opcontrol() {
     pros::Controller master(pros::E_CONTROLLER_MASTER);
 
     std::string log_path;
-    FILE* log_file = open_log_file(&log_path);
+    const std::uint32_t session_id = static_cast<std::uint32_t>(pros::micros());
+    FILE* log_file = open_log_file(&log_path, session_id);
+    sd::log_stats();
+    g_log_writer.start(log_file, session_id, kLogFlushMs);
 
     display_line(1, "Tap screen to save");
     display_line(2, log_file ? log_path.c_str() : "No SD card");
@@ -99,24 +228,13 @@ void opcontrol() {
 
     const std::uint32_t start_ms = pros::millis();
     std::uint32_t last_display_ms = start_ms;
-    std::vector<std::string> buffer;
-    buffer.reserve(kBufferLimit);
+    LoopJitter jitter;
     std::vector<std::string> history;
     history.reserve(kHistoryLines);
 
-    int last_btnL1 = -1;
-    int last_btnL2 = -1;
-    int last_btnR1 = -1;
-    int last_btnR2 = -1;
-    int last_btnA = -1;
-    int last_btnB = -1;
-    int last_btnX = -1;
-    int last_btnY = -1;
-    int last_btnUp = -1;
-    int last_btnDown = -1;
-    int last_btnLeft = -1;
-    int last_btnRight = -1;
+    std::uint16_t last_buttons = 0;
     std::int32_t last_press_count = -1;
+    std::uint8_t sequence = 0;
     auto add_history = [&](const std::string& entry) {
         if (history.size() >= kHistoryLines) {
             return;
@@ -125,102 +243,32 @@ void opcontrol() {
         display_line(kHistoryStartLine + static_cast<int>(history.size()) - 1, entry.c_str());
     };
 
+    const std::uint64_t start_us = pros::micros();
+    std::uint32_t wake_ms = pros::millis();
     while (true) {
-        const int axis1 = master.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X);
-        const int axis2 = master.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_Y);
-        const int axis3 = master.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
-        const int axis4 = master.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_X);
-
-        const int btnL1 = master.get_digital(pros::E_CONTROLLER_DIGITAL_L1);
-        const int btnL2 = master.get_digital(pros::E_CONTROLLER_DIGITAL_L2);
-        const int btnR1 = master.get_digital(pros::E_CONTROLLER_DIGITAL_R1);
-        const int btnR2 = master.get_digital(pros::E_CONTROLLER_DIGITAL_R2);
-        const int btnA = master.get_digital(pros::E_CONTROLLER_DIGITAL_A);
-        const int btnB = master.get_digital(pros::E_CONTROLLER_DIGITAL_B);
-        const int btnX = master.get_digital(pros::E_CONTROLLER_DIGITAL_X);
-        const int btnY = master.get_digital(pros::E_CONTROLLER_DIGITAL_Y);
-        const int btnUp = master.get_digital(pros::E_CONTROLLER_DIGITAL_UP);
-        const int btnDown = master.get_digital(pros::E_CONTROLLER_DIGITAL_DOWN);
-        const int btnLeft = master.get_digital(pros::E_CONTROLLER_DIGITAL_LEFT);
-        const int btnRight = master.get_digital(pros::E_CONTROLLER_DIGITAL_RIGHT);
-
-        if (log_file) {
-            char axis_buf[8];
-            std::snprintf(axis_buf, sizeof(axis_buf), "%d", axis1);
-            log_event(log_file, buffer, "AXIS1", axis_buf);
-            std::snprintf(axis_buf, sizeof(axis_buf), "%d", axis2);
-            log_event(log_file, buffer, "AXIS2", axis_buf);
-            std::snprintf(axis_buf, sizeof(axis_buf), "%d", axis3);
-            log_event(log_file, buffer, "AXIS3", axis_buf);
-            std::snprintf(axis_buf, sizeof(axis_buf), "%d", axis4);
-            log_event(log_file, buffer, "AXIS4", axis_buf);
-
-            if (btnL1 && last_btnL1 != 1) {
-                log_event(log_file, buffer, "BTN_L1", "INTAKE_IN");
-                add_history("BTN_L1 : INTAKE_IN");
-            }
-            if (btnL2 && last_btnL2 != 1) {
-                log_event(log_file, buffer, "BTN_L2", "INTAKE_OUT");
-                add_history("BTN_L2 : INTAKE_OUT");
+        jitter.tick();
+        ctrl_log::Sample sample{};
+        sample.time_us = static_cast<std::uint32_t>(pros::micros() - start_us);
+        sample.sequence = sequence++;
+        sample.axes[0] = clamp_axis(master.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X));
+        sample.axes[1] = clamp_axis(master.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_Y));
+        sample.axes[2] = clamp_axis(master.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y));
+        sample.axes[3] = clamp_axis(master.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_X));
+
+        for (int i = 0; i < ctrl_log::kButtonCount; ++i) {
+            if (master.get_digital(kLoggedButtons[i].button)) {
+                sample.buttons |= static_cast<std::uint16_t>(1u << i);
             }
-            if (btnR1 && last_btnR1 != 1) {
-                log_event(log_file, buffer, "BTN_R1", "OUTTAKE_OUT");
-                add_history("BTN_R1 : OUTTAKE_OUT");
-            }
-            if (btnR2 && last_btnR2 != 1) {
-                log_event(log_file, buffer, "BTN_R2", "OUTTAKE_IN");
-                add_history("BTN_R2 : OUTTAKE_IN");
-            }
-            if (btnA && last_btnA != 1) {
-                log_event(log_file, buffer, "BTN_A", "NO_ACTION");
-                add_history("BTN_A : NO_ACTION");
-            }
-            if (btnB && last_btnB != 1) {
-                log_event(log_file, buffer, "BTN_B", "NO_ACTION");
-                add_history("BTN_B : NO_ACTION");
-            }
-            if (btnX && last_btnX != 1) {
-                log_event(log_file, buffer, "BTN_X", "NO_ACTION");
-                add_history("BTN_X : NO_ACTION");
-            }
-            if (btnY && last_btnY != 1) {
-                log_event(log_file, buffer, "BTN_Y", "NO_ACTION");
-                add_history("BTN_Y : NO_ACTION");
-            }
-            if (btnUp && last_btnUp != 1) {
-                log_event(log_file, buffer, "BTN_UP", "NO_ACTION");
-                add_history("BTN_UP : NO_ACTION");
-            }
-            if (btnDown && last_btnDown != 1) {
-                log_event(log_file, buffer, "BTN_DOWN", "NO_ACTION");
-                add_history("BTN_DOWN : NO_ACTION");
-            }
-            if (btnLeft && last_btnLeft != 1) {
-                log_event(log_file, buffer, "BTN_LEFT", "NO_ACTION");
-                add_history("BTN_LEFT : NO_ACTION");
-            }
-            if (btnRight && last_btnRight != 1) {
-                log_event(log_file, buffer, "BTN_RIGHT", "NO_ACTION");
-                add_history("BTN_RIGHT : NO_ACTION");
-            }
-
-            if (buffer.size() >= kBufferLimit) {
-                flush_buffer(log_file, buffer);
+        }
+        if (log_file) {
+            const std::uint16_t pressed = static_cast<std::uint16_t>(sample.buttons & ~last_buttons);
+            for (int i = 0; i < ctrl_log::kButtonCount; ++i) {
+                if (pressed & (1u << i)) {
+                    add_history(kLoggedButtons[i].history);
+                }
             }
         }
-
-        last_btnL1 = btnL1;
-        last_btnL2 = btnL2;
-        last_btnR1 = btnR1;
-        last_btnR2 = btnR2;
-        last_btnA = btnA;
-        last_btnB = btnB;
-        last_btnX = btnX;
-        last_btnY = btnY;
-        last_btnUp = btnUp;
-        last_btnDown = btnDown;
-        last_btnLeft = btnLeft;
-        last_btnRight = btnRight;
+        last_buttons = sample.buttons;
 
         const std::uint32_t now_ms = pros::millis();
         if (now_ms - last_display_ms >= kDisplayIntervalMs) {
@@ -229,20 +277,24 @@ void opcontrol() {
         }
 
         const auto touch = pros::screen::touch_status();
-        if (touch.press_count != last_press_count && touch.touch_status == pros::E_TOUCH_PRESSED) {
+        const bool save_tapped = touch.press_count != last_press_count && touch.touch_status == pros::E_TOUCH_PRESSED;
+        if (save_tapped) {
             last_press_count = touch.press_count;
-            if (log_file) {
-                log_event(log_file, buffer, "SCREEN_TAP", "SAVE");
-            }
+            sample.flags |= ctrl_log::kFlagScreenTap;
+        }
+        if (log_file) {
+            push_record(sample);
+        }
+        if (save_tapped) {
             break;
         }
 
-        pros::delay(kLogIntervalMs);
+        pros::Task::delay_until(&wake_ms, kSamplePeriodMs);
     }
 
     if (log_file) {
-        flush_buffer(log_file, buffer);
-        std::fclose(log_file);
+        g_log_writer.stop();
+        report_logging(jitter);
     }
 
     pros::lcd::set_text(4, "Logging stopped");
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The brain build is -Os, which will not vectorize; build the per-channel
+// loops below at -O3 so they become NEON on the Cortex-A9.
+#if defined(__GNUC__) && !defined(__clang__)
+#define AREA_SCALER_VECTORIZE __attribute__((optimize("O3")))
+#else
+#define AREA_SCALER_VECTORIZE
+#endif
+
+namespace image {
+// Streaming box filter: every source pixel lands in exactly one target pixel
+// and each target pixel is the mean of its block. Source rows are summed
+// per column into planar accumulators (one add per channel per pixel, no
+// branches), and the horizontal sums and division happen once per target
+// row. Division is a 16.16 fixed-point reciprocal multiply.
+//
+// Usage: for each source row in screen order, call target_row(), flush()
+// when it changes, then add_*(). Flush once more after the last row.
+class AreaScaler {
+    public:
+        AreaScaler(int src_w, int src_h, int dst_w, int dst_h)
+            : m_src_w(src_w), m_src_h(src_h), m_dst_w(dst_w), m_dst_h(dst_h),
+              m_r(static_cast<std::size_t>(src_w), 0), m_g(static_cast<std::size_t>(src_w), 0),
+              m_b(static_cast<std::size_t>(src_w), 0), m_col_start(static_cast<std::size_t>(dst_w) + 1, 0),
+              m_inv(static_cast<std::size_t>(dst_w), 0) {
+            for (int c = 0; c <= dst_w; ++c) {
+                m_col_start[static_cast<std::size_t>(c)] =
+                    static_cast<int>((static_cast<std::int64_t>(c) * src_w) / dst_w);
+            }
+        }
+
+        // Target row a source row (counted top-down) contributes to.
+        int target_row(int src_y) const {
+            return static_cast<int>((static_cast<std::int64_t>(src_y) * m_dst_h) / m_src_h);
+        }
+
+        bool pending() const { return m_rows > 0; }
+
+        // Packed B,G,R[,X] source pixels (24/32-bit BMP byte order).
+        void add_bgr24(const std::uint8_t* pixels) { accumulate<3>(pixels); }
+        void add_bgr32(const std::uint8_t* pixels) { accumulate<4>(pixels); }
+
+        // Already-converted XRGB pixels (e.g. BI_BITFIELDS after unpacking).
+        AREA_SCALER_VECTORIZE void add_xrgb(const std::uint32_t* pixels) {
+            std::uint32_t* __restrict r = m_r.data();
+            std::uint32_t* __restrict g = m_g.data();
+            std::uint32_t* __restrict b = m_b.data();
+            const int width = m_src_w;
+            for (int x = 0; x < width; ++x) {
+                r[x] += (pixels[x] >> 16) & 0xFF;
+                g[x] += (pixels[x] >> 8) & 0xFF;
+                b[x] += pixels[x] & 0xFF;
+            }
+            ++m_rows;
+        }
+
+        // Writes dst_w averaged XRGB pixels and clears the accumulators.
+        void flush(std::uint32_t* out) {
+            if (m_rows == 0) {
+                return;
+            }
+            if (m_rows != m_inv_rows) {
+                // Rows per target only take two values (floor/ceil of the
+                // ratio), so the reciprocal table is rebuilt rarely.
+                for (int c = 0; c < m_dst_w; ++c) {
+                    const std::uint32_t n = static_cast<std::uint32_t>(m_col_start[c + 1] - m_col_start[c]) * m_rows;
+                    m_inv[static_cast<std::size_t>(c)] = (65536u + n / 2) / n;
+                }
+                m_inv_rows = m_rows;
+            }
+
+            for (int c = 0; c < m_dst_w; ++c) {
+                std::uint32_t sr = 0;
+                std::uint32_t sg = 0;
+                std::uint32_t sb = 0;
+                for (int x = m_col_start[c]; x < m_col_start[c + 1]; ++x) {
+                    sr += m_r[static_cast<std::size_t>(x)];
+                    sg += m_g[static_cast<std::size_t>(x)];
+                    sb += m_b[static_cast<std::size_t>(x)];
+                }
+                const std::uint32_t inv = m_inv[static_cast<std::size_t>(c)];
+                const std::uint32_t r = std::min<std::uint32_t>((sr * inv + 0x8000) >> 16, 255);
+                const std::uint32_t g = std::min<std::uint32_t>((sg * inv + 0x8000) >> 16, 255);
+                const std::uint32_t b = std::min<std::uint32_t>((sb * inv + 0x8000) >> 16, 255);
+                out[c] = (r << 16) | (g << 8) | b;
+            }
+
+            std::fill(m_r.begin(), m_r.end(), 0);
+            std::fill(m_g.begin(), m_g.end(), 0);
+            std::fill(m_b.begin(), m_b.end(), 0);
+            m_rows = 0;
+        }
+    private:
+        template <int Stride>
+        AREA_SCALER_VECTORIZE void accumulate(const std::uint8_t* pixels) {
+            std::uint32_t* __restrict r = m_r.data();
+            std::uint32_t* __restrict g = m_g.data();
+            std::uint32_t* __restrict b = m_b.data();
+            const int width = m_src_w;
+            for (int x = 0; x < width; ++x) {
+                b[x] += pixels[x * Stride];
+                g[x] += pixels[x * Stride + 1];
+                r[x] += pixels[x * Stride + 2];
+            }
+            ++m_rows;
+        }
+
+        int m_src_w;
+        int m_src_h;
+        int m_dst_w;
+        int m_dst_h;
+        std::uint32_t m_rows = 0;
+        std::uint32_t m_inv_rows = 0;
+        std::vector<std::uint32_t> m_r;
+        std::vector<std::uint32_t> m_g;
+        std::vector<std::uint32_t> m_b;
+        std::vector<int> m_col_start;
+        std::vector<std::uint32_t> m_inv;
+};
+} // namespace image
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "bonkers/plan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Tahera's startup settings. They live in small text files on the microSD
+// (ui_images.txt, controller_mapping.txt, auton_slot.txt and the plan
+// files), and tools/config_compile packs all of them into robot_config.bin
+// so the brain can load everything with one read and a CRC check. The
+// brain falls back to the text files when the bundle is missing or bad.
+//
+// robot_config.bin, little-endian:
+//   0  "BCFG"
+//   4  u8  version (kVersion)
+//   5  u8  0, u16 0
+//   8  u32 body size
+//   12 u32 CRC-32 of the body
+//   16 body: u8 image flags (kHas*), u8 active slot, u8 action count,
+//      u8 slot count, one u8 button per action, the splash, auton, driver
+//      and legacy run image strings (u8 length + bytes), then per slot
+//      u8 loaded, u16 GPS step count, u16 BASIC step count and the steps
+//      (u8 type, three i32 values), at most plan::kPlanCapacity per section.
+namespace config {
+constexpr char kBundleFile[] = "robot_config.bin";
+constexpr char kUiImagesFile[] = "ui_images.txt";
+constexpr char kButtonMapFile[] = "controller_mapping.txt";
+constexpr std::uint8_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 16;
+
+// Driver controls that can be remapped in controller_mapping.txt.
+enum class Action {
+    INTAKE_IN,
+    INTAKE_OUT,
+    OUTAKE_OUT,
+    OUTAKE_IN,
+    GPS_ENABLE,
+    GPS_DISABLE,
+    SIX_WHEEL_ON,
+    SIX_WHEEL_OFF
+};
+constexpr int kActionCount = 8;
+
+// Controller buttons by their pros::controller_digital_e_t value, so host
+// tools can build a bundle without the PROS headers.
+enum Button : std::uint8_t {
+    kButtonL1 = 6,
+    kButtonL2,
+    kButtonR1,
+    kButtonR2,
+    kButtonUp,
+    kButtonDown,
+    kButtonLeft,
+    kButtonRight,
+    kButtonX,
+    kButtonB,
+    kButtonY,
+    kButtonA
+};
+
+// Image flags: which keys ui_images.txt set.
+constexpr std::uint8_t kHasSplash = 0x01;
+constexpr std::uint8_t kHasAuton = 0x02;
+constexpr std::uint8_t kHasDriver = 0x04;
+constexpr std::uint8_t kHasRun = 0x08;
+
+// ui_images.txt entries as written; the brain maps them under /usd/Images/.
+struct Images {
+    std::uint8_t flags = 0;
+    std::string splash;
+    std::string auton;
+    std::string driver;
+    std::string run; // legacy RUN= key
+};
+
+// What Tahera replays for one slot: the slot file, or auton_plans.txt if
+// the slot file has no steps.
+struct SlotPlans {
+    bool loaded = false;
+    std::vector<plan::Step> gps;
+    std::vector<plan::Step> basic;
+};
+
+struct Config {
+    Images images;
+    std::uint8_t buttons[kActionCount];
+    int active_slot = 0;
+    SlotPlans slots[plan::kSlotCount];
+};
+
+const char* action_key(Action action);
+const char* button_name(std::uint8_t button);
+
+// The built-in mapping used when controller_mapping.txt leaves an action out.
+void default_buttons(std::uint8_t* buttons);
+
+// Parses ui_images.txt (KEY=name lines) into `out`, replacing its contents.
+// Keys are case-insensitive; unknown keys are reported under `name`.
+void read_images(FILE* file, Images* out, const char* name = nullptr);
+
+// Applies ACTION=BUTTON lines from controller_mapping.txt on top of
+// `buttons`. Both sides are case-insensitive; '#' comments are skipped and
+// unknown actions or buttons are reported under `name` and skipped.
+void read_buttons(FILE* file, std::uint8_t* buttons, const char* name = nullptr);
+
+// Loads a whole bundle with a single read. Returns false, leaving `out`
+// partly filled, if the file is short, from another version or fails its CRC.
+bool read_bundle(FILE* file, Config* out);
+
+// Serializes `config` into `out`. False, with nothing worth writing, if a
+// field is too long or a plan has more than plan::kPlanCapacity steps.
+// Encode before opening the file, so a bad config never truncates a good
+// bundle.
+bool encode_bundle(const Config& config, std::vector<std::uint8_t>* out);
+
+// Writes an encoded bundle in one fwrite; false on a write error.
+bool write_bundle(FILE* file, const std::vector<std::uint8_t>& bytes);
+} // namespace config
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (IEEE 802.3, reflected 0xEDB88320), the same checksum as zlib's
+// crc32(), so host tools can check files with any standard implementation.
+namespace crc {
+// Pass a previous result as `crc` to continue over more data; start at 0.
+std::uint32_t crc32(const void* data, std::size_t size, std::uint32_t crc = 0);
+} // namespace crc
@@ -0,0 +1,12 @@
+#pragma once
+
+// The 6WD drive every program and host tool models: 3.25" wheels on the
+// motor shafts and a 12" track, the same numbers the field viewer assumes.
+// The closed-loop plan steps, log_to_plan and plan_sim all read them here.
+namespace geometry {
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kWheelDiameterMm = 82.55;
+constexpr double kTrackWidthMm = 304.8;
+// Wheel travel per degree of motor encoder.
+constexpr double kMmPerMotorDegree = kWheelDiameterMm * kPi / 360.0;
+} // namespace geometry
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "bonkers/plan.hpp"
+#include "bonkers/plan_arena.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Turns a recorded drive into plan steps. The recorder keeps one Sample per
+// control period in a Ring; fit() then cuts the trace into the fewest
+// stretches whose left and right powers each stay within
+// FitOptions::power_error of one value, and writes each stretch as a step.
+// Straight runs, spins and forward curves become closed-loop steps measured
+// on the encoders and IMU, so playback does not depend on the battery;
+// stops become waits, and anything else, or too short to measure, a timed
+// TANK_MS.
+namespace trace {
+struct Sample {
+    std::int8_t left;  // drive powers as commanded, -127 to 127
+    std::int8_t right;
+    float left_mm;     // encoder distance, from any fixed zero
+    float right_mm;
+    float heading;     // IMU, degrees clockwise
+};
+
+struct FitOptions {
+    std::uint32_t sample_ms = 10;
+    // Most a step's power may differ from any sample it stands for.
+    int power_error = 8;
+    // Both sides at or under this is standing still.
+    int stop_power = 5;
+    // |left - right| (|left + right| for spins) still counted as even.
+    int straight_band = 10;
+    // Shorter straights and turns stay timed.
+    double min_mm = 20.0;
+    double min_deg = 5.0;
+    // False when the samples carry no encoder or IMU readings: every
+    // stretch of driving is then a TANK_MS.
+    bool closed_loop = true;
+};
+
+// The last Capacity samples; older ones are overwritten and counted.
+template <std::size_t Capacity>
+class Ring {
+    public:
+        void push(const Sample& sample) {
+            m_samples[m_next] = sample;
+            m_next = (m_next + 1) % Capacity;
+            if (m_size < Capacity) {
+                ++m_size;
+            } else {
+                ++m_overwritten;
+            }
+        }
+
+        void clear() {
+            m_next = 0;
+            m_size = 0;
+            m_overwritten = 0;
+        }
+
+        // Moves the samples, oldest first, to the start of the storage and
+        // returns them. Later pushes carry on overwriting the oldest.
+        const Sample* linearize() {
+            if (m_size == Capacity && m_next != 0) {
+                std::rotate(m_samples, m_samples + m_next, m_samples + Capacity);
+                m_next = 0;
+            }
+            return m_samples;
+        }
+
+        std::size_t size() const { return m_size; }
+        std::size_t overwritten() const { return m_overwritten; }
+    private:
+        Sample m_samples[Capacity];
+        std::size_t m_next = 0;
+        std::size_t m_size = 0;
+        std::size_t m_overwritten = 0;
+};
+
+// Appends the steps for `count` samples to `out`. Standing still before the
+// first and after the last movement is left out. Returns false if `out`
+// filled up first.
+bool fit(const Sample* samples, std::size_t count, const FitOptions& options, plan::PlanBuffer* out);
+
+// Fits samples[begin, end) as they are, standing still included. `count` is
+// the whole trace, so the last step can measure up to samples[end].
+bool fit_range(const Sample* samples, std::size_t count, std::size_t begin, std::size_t end,
+               const FitOptions& options, plan::PlanBuffer* out);
+
+// Both powers within options.stop_power.
+bool still(const Sample& sample, const FitOptions& options);
+} // namespace trace
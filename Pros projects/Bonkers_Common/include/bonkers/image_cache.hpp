@@ -0,0 +1,58 @@
+#pragma once
+
+#include "bonkers/image_decoder.hpp"
+#include "pros/rtos.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace image {
+constexpr std::size_t kFrameBytes = static_cast<std::size_t>(kScreenW) * kScreenH * sizeof(std::uint32_t);
+
+// Keeps decoded, screen-native frames in RAM so a redraw is one copy_area
+// instead of an SD read and an image decode. Frames past the byte budget are
+// evicted least-recently-used first.
+class Cache {
+    public:
+        Cache(std::size_t budget_bytes, OpenFn open_fn);
+
+        // Decodes the image into the cache if it is not already resident.
+        bool preload(const std::string& name);
+
+        // Blits a cached frame, decoding it first on a miss. Images that do
+        // not fit the budget are streamed from SD instead.
+        bool draw(const std::string& name, int x, int y);
+
+        // Blits a .vbi compiled into the program (see ASSET()). The blob is
+        // only decoded into the cache the first time it is needed.
+        bool draw_asset(const std::string& name, const std::uint8_t* data, std::size_t size, int x, int y);
+
+        void clear();
+        std::size_t bytes_used() const { return m_bytes_used; }
+    private:
+        struct Entry {
+            std::string name;
+            std::vector<std::uint32_t> pixels;
+            int width;
+            int height;
+            std::uint32_t last_used;
+        };
+
+        Entry* find(const std::string& name);
+        Entry* load(const std::string& name);
+        Entry* load_vbi(const std::string& name, const std::uint8_t* data, std::size_t size);
+        Entry* insert(const std::string& name, int width, int height);
+        void blit(const Entry& entry, int x, int y);
+        void evict_until_fits(std::size_t bytes);
+
+        std::size_t m_budget_bytes;
+        std::size_t m_bytes_used = 0;
+        std::uint32_t m_tick = 0;
+        OpenFn m_open;
+        std::vector<Entry> m_entries;
+        pros::Mutex m_mutex;
+};
+} // namespace image
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "bonkers/vbi_format.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace image {
+constexpr int kScreenW = 480;
+constexpr int kScreenH = 240;
+
+// Parsed BMP header plus the size the image will occupy on screen.
+struct BmpHeader {
+    std::uint32_t data_offset;
+    std::int32_t width;
+    std::int32_t height;      // always positive; see top_down
+    bool top_down;
+    std::uint16_t bpp;
+    bool bitfields;           // 32-bit BI_BITFIELDS with custom channel masks
+    std::uint32_t masks[3];   // red, green, blue
+    std::uint32_t row_size;   // padded source row in bytes
+    int target_w;             // clamped to kScreenW
+    int target_h;             // clamped to kScreenH
+};
+
+enum class Format { BMP, VBI };
+
+// Header of either supported format, sniffed from the file magic.
+struct ImageHeader {
+    Format format;
+    BmpHeader bmp;
+    vbi::Header vbi;
+    int target_w;
+    int target_h;
+};
+
+// Screen API calls and rows emitted by the most recent draw_image().
+struct DrawStats {
+    std::uint32_t rows;
+    std::uint32_t screen_calls;
+};
+
+// SD traffic of one file decode (pixel data only; the header is a single
+// small read). Decodes fill in the caller's copy, so background decodes do
+// not overwrite it.
+struct ReadStats {
+    std::uint32_t bytes;
+    std::uint32_t calls;
+    std::uint32_t micros;
+};
+
+// Receives one decoded screen row of XRGB pixels. Rows arrive in file order,
+// so bottom-up BMPs deliver the last screen row first.
+using RowFn = void (*)(void* ctx, int row, const std::uint32_t* pixels, int width);
+
+// Opens a file by name, normally sd::open, so callers share its path probing.
+using OpenFn = FILE* (*)(const char* name, const char* mode);
+
+// Reads and validates the header of a 24-bit or 32-bit BMP (BI_RGB, or
+// BI_BITFIELDS for 32-bit).
+bool read_bmp_header(FILE* file, BmpHeader* out);
+
+// Decodes the pixel array, area-averaging down to the screen when the image
+// is larger than it. Returns false if no row could be read. `stats`, if
+// given, receives the SD traffic.
+bool decode_bmp(FILE* file, const BmpHeader& header, RowFn on_row, void* ctx, ReadStats* stats = nullptr);
+
+// Reads a .vbi header (see vbi_format.hpp).
+bool read_vbi_header(FILE* file, vbi::Header* out);
+
+// Expands RLE/raw RGB565 rows; images are already screen-sized.
+bool decode_vbi(FILE* file, const vbi::Header& header, RowFn on_row, void* ctx, ReadStats* stats = nullptr);
+
+// Same as above for a .vbi held in memory, e.g. an ASSET() blob.
+bool decode_vbi(const std::uint8_t* data, std::size_t size, const vbi::Header& header, RowFn on_row, void* ctx);
+bool draw_vbi(const std::uint8_t* data, std::size_t size, int x, int y);
+
+// Sniffs the magic bytes and reads a BMP or VBI header from the file start.
+bool read_header(FILE* file, ImageHeader* out);
+bool decode(FILE* file, const ImageHeader& header, RowFn on_row, void* ctx, ReadStats* stats = nullptr);
+
+// Streams a BMP or VBI straight to the screen with one copy_area per row.
+bool draw_image(FILE* file, int x, int y, ReadStats* stats = nullptr);
+
+// Opens `name` with open_fn, streams it to the screen and logs the read stats.
+bool draw_file(OpenFn open_fn, const char* name, int x, int y);
+
+const DrawStats& last_draw_stats();
+
+// Prints `stats` for `name` to the terminal.
+void log_read_stats(const char* name, const ReadStats& stats);
+} // namespace image
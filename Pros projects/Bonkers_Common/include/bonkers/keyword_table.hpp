@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Compile-time perfect hash for the small keyword sets in the config and
+// plan files. The constructor tries hash seeds until every keyword lands in
+// its own slot, so a lookup is one hash and at most one compare. Build the
+// table constexpr and static_assert perfect().
+namespace text {
+// FNV-1a, then a final mix so the low bits used as the slot index depend on
+// every bit of the seed.
+constexpr std::uint32_t keyword_hash(const char* str, std::size_t len, std::uint32_t seed) {
+    std::uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (std::size_t i = 0; i < len; ++i) {
+        hash = (hash ^ static_cast<std::uint8_t>(str[i])) * 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x7FEB352Du;
+    hash ^= hash >> 15;
+    return hash;
+}
+
+constexpr std::size_t keyword_length(const char* str) {
+    std::size_t len = 0;
+    while (str[len] != '\0') {
+        ++len;
+    }
+    return len;
+}
+
+// Slots must be a power of two, comfortably above the keyword count.
+template <std::size_t Slots>
+class KeywordTable {
+        static_assert(Slots > 0 && (Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+    public:
+        // names[i] maps to the value i.
+        template <std::size_t N>
+        constexpr explicit KeywordTable(const char* const (&names)[N]) {
+            static_assert(N <= Slots, "more keywords than slots");
+            for (std::uint32_t seed = 0; seed < kMaxSeeds && !m_perfect; ++seed) {
+                m_perfect = place(names, N, seed);
+            }
+        }
+
+        constexpr bool perfect() const { return m_perfect; }
+
+        // Index of the keyword spelled by [str, str + len), or `missing`.
+        int find(const char* str, std::size_t len, int missing) const {
+            const Slot& slot = m_slots[keyword_hash(str, len, m_seed) & (Slots - 1)];
+            if (slot.name && slot.length == len && std::memcmp(slot.name, str, len) == 0) {
+                return slot.value;
+            }
+            return missing;
+        }
+    private:
+        static constexpr std::uint32_t kMaxSeeds = 4096;
+
+        struct Slot {
+            const char* name = nullptr;
+            std::size_t length = 0;
+            int value = 0;
+        };
+
+        constexpr bool place(const char* const* names, std::size_t count, std::uint32_t seed) {
+            for (Slot& slot : m_slots) {
+                slot = Slot{};
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                const std::size_t len = keyword_length(names[i]);
+                Slot& slot = m_slots[keyword_hash(names[i], len, seed) & (Slots - 1)];
+                if (slot.name) {
+                    return false;
+                }
+                slot = Slot{names[i], len, static_cast<int>(i)};
+            }
+            m_seed = seed;
+            return true;
+        }
+
+        Slot m_slots[Slots] = {};
+        std::uint32_t m_seed = 0;
+        bool m_perfect = false;
+};
+} // namespace text
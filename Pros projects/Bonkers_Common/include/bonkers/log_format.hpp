@@ -0,0 +1,303 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// Binary controller log written by Basic Bonkers: one fixed-size sample per
+// loop tick instead of a text line per axis and button edge.
+//
+// Layout (little-endian):
+//   header  24 bytes   "BBLG", u8 version, u8 header bytes, u16 sample
+//                      period ms, u8 x4 analog channel of axis1..4, u8 left
+//                      drive axis, u8 right drive axis, u16 program id,
+//                      u32 session id, u16 flush interval ms, u8 record
+//                      bytes, u8 telemetry mask
+//   frames             u16 payload bytes, u16 frame sequence, payload,
+//                      u32 CRC-32 of session id + frame header + payload
+//   records            a sample, then telemetry if the mask is non-zero
+//   sample  12 bytes   u32 us since the log started, i8 x4 axis1..4,
+//                      u16 button mask, u8 flags, u8 sequence
+//   telemetry 12 bytes i16 x2 left/right drive velocity (0.1 rpm), u16 x2
+//                      left/right drive current (mA), u16 IMU heading
+//                      (0.01 deg), u8 valid bits, u8 spare
+//
+// Each flush of the writer is one frame of whole samples, so a power cut
+// or card pull costs at most the unflushed tail: readers keep every frame
+// up to the first torn or failing one. A frame with no payload marks a
+// clean close. The file is preallocated on the card, so whatever follows
+// the last frame may be stale data; seeding the CRC with the session id
+// keeps frames left over from an older log from ever checking out.
+//
+// Version 1 (16-byte header, unframed) and version 2 logs still decode;
+// their samples carried a u16 ms delta and a spare u16 in place of the
+// timestamp. Readers skip any header bytes past the ones they know, so
+// later versions can grow the header without breaking older decoders.
+namespace ctrl_log {
+constexpr char kMagic[4] = {'B', 'B', 'L', 'G'};
+constexpr std::uint8_t kVersion = 3;
+constexpr std::size_t kHeaderSizeV1 = 16;
+constexpr std::size_t kHeaderSize = 24;
+constexpr std::size_t kSampleSize = 12;
+constexpr std::size_t kTelemetrySize = 12;
+constexpr std::size_t kMaxRecordSize = kSampleSize + kTelemetrySize;
+constexpr std::size_t kFrameHeaderSize = 4;
+constexpr std::size_t kFrameTrailerSize = 4;
+constexpr std::size_t kMaxFramePayload = 170 * kMaxRecordSize; // a whole frame fits a 4 KiB block
+constexpr std::size_t kMaxFrameSize = kFrameHeaderSize + kMaxFramePayload + kFrameTrailerSize;
+constexpr int kAxisCount = 4;
+
+// Analog channels, numbered like pros::controller_analog_e_t.
+constexpr std::uint8_t kAnalogLeftX = 0;
+constexpr std::uint8_t kAnalogLeftY = 1;
+constexpr std::uint8_t kAnalogRightX = 2;
+constexpr std::uint8_t kAnalogRightY = 3;
+
+// Button bits, in pros::controller_digital_e_t order starting at L1.
+constexpr std::uint16_t kButtonL1 = 1u << 0;
+constexpr std::uint16_t kButtonL2 = 1u << 1;
+constexpr std::uint16_t kButtonR1 = 1u << 2;
+constexpr std::uint16_t kButtonR2 = 1u << 3;
+constexpr std::uint16_t kButtonUp = 1u << 4;
+constexpr std::uint16_t kButtonDown = 1u << 5;
+constexpr std::uint16_t kButtonLeft = 1u << 6;
+constexpr std::uint16_t kButtonRight = 1u << 7;
+constexpr std::uint16_t kButtonX = 1u << 8;
+constexpr std::uint16_t kButtonB = 1u << 9;
+constexpr std::uint16_t kButtonY = 1u << 10;
+constexpr std::uint16_t kButtonA = 1u << 11;
+constexpr int kButtonCount = 12;
+
+// Sample flags.
+constexpr std::uint8_t kFlagScreenTap = 1u << 0; // last sample; the driver tapped SAVE
+
+// Telemetry mask bits: which readings the program meant to capture.
+constexpr std::uint8_t kTelemetryVelocity = 1u << 0;
+constexpr std::uint8_t kTelemetryCurrent = 1u << 1;
+constexpr std::uint8_t kTelemetryHeading = 1u << 2;
+
+// Telemetry valid bits: which devices answered for this record.
+constexpr std::uint8_t kValidLeftDrive = 1u << 0;
+constexpr std::uint8_t kValidRightDrive = 1u << 1;
+constexpr std::uint8_t kValidImu = 1u << 2;
+
+// Program ids match the brain slots in the README.
+constexpr std::uint16_t kProgramTahera = 1;
+constexpr std::uint16_t kProgramAutonPlanner = 2;
+constexpr std::uint16_t kProgramImageSelector = 3;
+constexpr std::uint16_t kProgramBasicBonkers = 4;
+
+struct Header {
+    std::uint8_t version;
+    std::uint16_t period_ms;
+    std::uint8_t axis_channels[kAxisCount]; // analog channel behind axis1..4
+    std::uint8_t left_axis;                 // 0-based axis index driving the left side
+    std::uint8_t right_axis;
+    std::uint16_t program_id;
+    std::uint32_t session_id;   // version 2+
+    std::uint16_t flush_ms;     // version 2+
+    std::uint8_t record_bytes;  // kSampleSize, plus kTelemetrySize with telemetry
+    std::uint8_t telemetry;     // kTelemetry* mask, version 3+
+};
+
+struct Sample {
+    std::uint32_t time_us; // since the log started; wraps after ~71 minutes
+    std::int8_t axes[kAxisCount];
+    std::uint16_t buttons;
+    std::uint8_t flags;
+    std::uint8_t sequence; // wraps; a jump means the writer dropped samples
+};
+
+struct Telemetry {
+    std::int16_t left_velocity;  // 0.1 rpm, averaged over the side's motors
+    std::int16_t right_velocity;
+    std::uint16_t left_current;  // mA, summed over the side's motors
+    std::uint16_t right_current;
+    std::uint16_t heading;       // 0.01 deg, 0..35999
+    std::uint8_t valid;          // kValid* bits
+};
+
+inline void put_u16(std::uint8_t* out, std::uint16_t value) {
+    out[0] = static_cast<std::uint8_t>(value & 0xFF);
+    out[1] = static_cast<std::uint8_t>(value >> 8);
+}
+
+inline void put_u32(std::uint8_t* out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<std::uint8_t>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+inline std::uint16_t get_u16(const std::uint8_t* bytes) {
+    return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+inline std::uint32_t get_u32(const std::uint8_t* bytes) {
+    return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+           (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+}
+
+// Writes a current-version header of kHeaderSize bytes.
+inline void write_header(const Header& header, std::uint8_t* out) {
+    std::memcpy(out, kMagic, sizeof(kMagic));
+    out[4] = kVersion;
+    out[5] = static_cast<std::uint8_t>(kHeaderSize);
+    put_u16(out + 6, header.period_ms);
+    std::memcpy(out + 8, header.axis_channels, kAxisCount);
+    out[12] = header.left_axis;
+    out[13] = header.right_axis;
+    put_u16(out + 14, header.program_id);
+    put_u32(out + 16, header.session_id);
+    put_u16(out + 20, header.flush_ms);
+    out[22] = header.telemetry ? static_cast<std::uint8_t>(kMaxRecordSize) : static_cast<std::uint8_t>(kSampleSize);
+    out[23] = header.telemetry;
+}
+
+// Parses `size` bytes of header. With only kHeaderSizeV1 bytes this still
+// reports `header_bytes`, the full length the file declares, so callers can
+// read the rest and parse again.
+inline bool parse_header(const std::uint8_t* bytes, std::size_t size, Header* out, std::size_t* header_bytes) {
+    if (!bytes || !out || size < kHeaderSizeV1 || std::memcmp(bytes, kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+    out->version = bytes[4];
+    if (header_bytes) {
+        *header_bytes = bytes[5];
+    }
+    out->period_ms = get_u16(bytes + 6);
+    std::memcpy(out->axis_channels, bytes + 8, kAxisCount);
+    out->left_axis = bytes[12];
+    out->right_axis = bytes[13];
+    out->program_id = get_u16(bytes + 14);
+    out->session_id = 0;
+    out->flush_ms = 0;
+    out->record_bytes = static_cast<std::uint8_t>(kSampleSize);
+    out->telemetry = 0;
+    if (out->version >= 2 && size >= kHeaderSize) {
+        out->session_id = get_u32(bytes + 16);
+        out->flush_ms = get_u16(bytes + 20);
+    }
+    if (out->version >= 3 && size >= kHeaderSize) {
+        out->record_bytes = bytes[22];
+        out->telemetry = bytes[23];
+    }
+    const std::size_t needed = out->version >= 2 ? kHeaderSize : kHeaderSizeV1;
+    const bool records_ok = out->record_bytes == (out->telemetry ? kMaxRecordSize : kSampleSize);
+    return out->version >= 1 && bytes[5] >= needed && out->left_axis < kAxisCount &&
+           out->right_axis < kAxisCount && records_ok;
+}
+
+inline void write_sample(const Sample& sample, std::uint8_t* out) {
+    put_u32(out, sample.time_us);
+    std::memcpy(out + 4, sample.axes, kAxisCount);
+    put_u16(out + 8, sample.buttons);
+    out[10] = sample.flags;
+    out[11] = sample.sequence;
+}
+
+inline void parse_sample(const std::uint8_t* bytes, Sample* out) {
+    out->time_us = get_u32(bytes);
+    std::memcpy(out->axes, bytes + 4, kAxisCount);
+    out->buttons = get_u16(bytes + 8);
+    out->flags = bytes[10];
+    out->sequence = bytes[11];
+}
+
+// Version 1-2 samples. The timestamp is left alone; `dt_ms` is the time
+// since the previous sample for the caller to accumulate.
+inline void parse_sample_v2(const std::uint8_t* bytes, Sample* out, std::uint16_t* dt_ms) {
+    *dt_ms = get_u16(bytes);
+    std::memcpy(out->axes, bytes + 2, kAxisCount);
+    out->buttons = get_u16(bytes + 6);
+    out->flags = bytes[8];
+    out->sequence = bytes[9];
+}
+
+inline void write_telemetry(const Telemetry& telemetry, std::uint8_t* out) {
+    put_u16(out, static_cast<std::uint16_t>(telemetry.left_velocity));
+    put_u16(out + 2, static_cast<std::uint16_t>(telemetry.right_velocity));
+    put_u16(out + 4, telemetry.left_current);
+    put_u16(out + 6, telemetry.right_current);
+    put_u16(out + 8, telemetry.heading);
+    out[10] = telemetry.valid;
+    out[11] = 0;
+}
+
+inline void parse_telemetry(const std::uint8_t* bytes, Telemetry* out) {
+    out->left_velocity = static_cast<std::int16_t>(get_u16(bytes));
+    out->right_velocity = static_cast<std::int16_t>(get_u16(bytes + 2));
+    out->left_current = get_u16(bytes + 4);
+    out->right_current = get_u16(bytes + 6);
+    out->heading = get_u16(bytes + 8);
+    out->valid = bytes[10];
+}
+
+// Completes a frame whose `payload_bytes` (at most kMaxFramePayload) are
+// already at frame + kFrameHeaderSize: fills in the header in front and
+// the CRC behind. Returns the frame's total size.
+std::size_t seal_frame(std::uint8_t* frame, std::size_t payload_bytes, std::uint16_t sequence,
+                       std::uint32_t session_id);
+
+// Why a reader stopped.
+enum class LogEnd {
+    CLOSED,   // clean close: the writer's empty end frame
+    UNCLOSED, // the file ends on a frame boundary without an end frame
+    TORN,     // the file ends partway through a frame
+    CORRUPT,  // a frame with a bad length, sequence or CRC
+};
+
+struct ScanStats {
+    std::uint32_t frames;     // good frames, end frame included
+    std::uint32_t samples;
+    std::uint32_t dropped;    // samples missing according to the sequence byte
+    std::uint32_t good_bytes; // file offset just past the last good frame
+    std::uint32_t tail_bytes; // bytes after good_bytes: unused preallocation or damage
+    LogEnd end;
+};
+
+// Walks a log record by record, stopping cleanly at the last good frame.
+class LogReader {
+    public:
+        // Reads the header. False if `file` is not a controller log.
+        bool open(FILE* file);
+
+        // Next sample, and its telemetry if `telemetry` is non-null (zeroed
+        // when the log has none). Older logs get timestamps rebuilt from
+        // their deltas. False at the end of the good data; stats() is
+        // final from then on.
+        bool next(Sample* sample, Telemetry* telemetry = nullptr);
+
+        const Header& header() const { return m_header; }
+        const ScanStats& stats() const { return m_stats; }
+    private:
+        bool next_frame();
+        void finish(LogEnd end);
+
+        FILE* m_file = nullptr;
+        Header m_header{};
+        ScanStats m_stats{};
+        std::uint8_t m_frame[kMaxFrameSize];
+        std::size_t m_payload_bytes = 0;
+        std::size_t m_pos = 0;
+        std::uint16_t m_frame_sequence = 0;
+        std::uint32_t m_time_us = 0;
+        std::uint8_t m_expected_sequence = 0;
+        bool m_done = true;
+};
+
+// Reads a whole log and writes the CSV the replay tools load:
+//   time_s,axis1,axis2,axis3,axis4,left_cmd,right_cmd,intake_action,
+//   outtake_action,buttons
+// followed, for logs with telemetry, by
+//   left_rpm,right_rpm,left_ma,right_ma,heading_deg
+// (empty where the device did not answer). Returns false if the file does
+// not start with a valid header.
+bool decode_csv(FILE* in, FILE* out, ScanStats* stats);
+
+// Held-button state as shown in the replay readouts ("" when idle).
+const char* intake_action(std::uint16_t buttons);
+const char* outtake_action(std::uint16_t buttons);
+
+const char* end_name(LogEnd end);
+} // namespace ctrl_log
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "bonkers/config_bundle.hpp"
+#include "bonkers/drive_geometry.hpp"
+#include "bonkers/drive_trace.hpp"
+#include "bonkers/plan_arena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Turns a practice run logged by Basic Bonkers into an auton plan. The log
+// is resampled to the control period, holding each logged sample until the
+// next one, and the drive is fitted into steps with trace::fit_range().
+// Wherever the roller buttons change, the drive fit is cut and an
+// INTAKE_ON, OUTTAKE_ON or INTAKE_OFF step goes in.
+//
+// Buttons mean what controller_mapping.txt makes them mean in Tahera. Plan
+// roller steps run both motors together, so INTAKE_IN or OUTAKE_OUT held
+// (each runs its motor forward) becomes INTAKE_ON, and INTAKE_OUT or
+// OUTAKE_IN becomes OUTTAKE_ON. When both are held, the intake's buttons win,
+// as they do in Tahera.
+//
+// Logs with drive velocity and IMU telemetry on every sample give
+// closed-loop steps, with distances integrated from the wheel speeds. Other
+// logs give timed TANK_MS steps.
+namespace log_plan {
+// The Auton Planner's LOG button imports this file from the card.
+constexpr char kImportFile[] = "auton_import.bbl";
+
+struct Options {
+    trace::FitOptions fit; // fit.sample_ms is the control period
+    double wheel_diameter_mm = geometry::kWheelDiameterMm;
+    std::uint8_t buttons[config::kActionCount]; // config::default_buttons(), then read_buttons()
+};
+
+// One logged sample.
+struct Input {
+    std::uint32_t time_us;
+    int left;              // drive powers, -127 to 127
+    int right;
+    std::uint16_t buttons; // ctrl_log::kButton* mask
+    bool measured;         // the telemetry below is valid
+    double left_rpm;
+    double right_rpm;
+    double heading;        // degrees clockwise
+};
+
+class Converter {
+    public:
+        explicit Converter(const Options& options) : m_options(options) {}
+
+        // Takes samples in log order.
+        void add(const Input& input);
+
+        // Appends the plan to `out`. Standing still with the rollers off
+        // before and after the run is left out. False if `out` filled up.
+        bool finish(plan::PlanBuffer* out);
+
+        // Control periods so far.
+        std::size_t samples() const { return m_samples.size(); }
+    private:
+        void push(std::uint32_t time_us);
+
+        Options m_options;
+        std::vector<trace::Sample> m_samples;
+        std::vector<std::int8_t> m_rollers; // per sample: 1 in, -1 out, 0 off
+        Input m_last{};
+        bool m_started = false;
+        bool m_measured = true; // every sample so far had telemetry
+        std::uint32_t m_next_us = 0;
+        double m_left_mm = 0; // at m_last
+        double m_right_mm = 0;
+};
+
+// Replaces `out` with the plan for a whole .bbl log. False, leaving `out`
+// as it was, if `file` is not a controller log; a plan that did not fit
+// shows in out->dropped().
+bool read_log(FILE* file, const Options& options, plan::PlanBuffer* out, std::size_t* samples = nullptr);
+} // namespace log_plan
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+// PID controller and settle detector shared by the closed-loop plan steps.
+// Neither reads a clock: callers pass the time, so the host tools can drive
+// them from a simulated one.
+namespace pid {
+struct Gains {
+    double kp;
+    double ki;
+    double kd;
+    // The integral only builds up while |error| is inside this band, and is
+    // cleared when the error changes sign, so it trims the last few units
+    // instead of winding up during the approach.
+    double integral_band;
+};
+
+class Controller {
+    public:
+        explicit Controller(const Gains& gains) : m_gains(gains) {}
+
+        // Forgets the integral and the previous error.
+        void reset();
+
+        // Output for `error` at `now_ms`. The first update after reset() has
+        // no derivative term.
+        double update(double error, std::uint32_t now_ms);
+    private:
+        Gains m_gains;
+        double m_integral = 0;
+        double m_prev_error = 0;
+        std::uint32_t m_prev_ms = 0;
+        bool m_started = false;
+};
+
+// Settled once |error| has stayed within `tolerance` for `hold_ms`.
+class Settle {
+    public:
+        Settle(double tolerance, std::uint32_t hold_ms) : m_tolerance(tolerance), m_hold_ms(hold_ms) {}
+
+        void reset() { m_inside = false; }
+
+        bool update(double error, std::uint32_t now_ms);
+    private:
+        double m_tolerance;
+        std::uint32_t m_hold_ms;
+        std::uint32_t m_entered_ms = 0;
+        bool m_inside = false;
+};
+} // namespace pid
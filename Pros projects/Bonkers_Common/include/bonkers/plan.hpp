@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+// Auton plans as saved by the Auton Planner and replayed by the Tahera
+// Sequence. A plan file holds a [GPS] and a [BASIC] section, one step per
+// line as TYPE,value1,value2[,value3]; lines starting with '#' are comments.
+//
+// Steps run one after another, except between PARALLEL and END_PARALLEL:
+// those steps start together, each value3 ms after the group starts (TANK_MS
+// has no offset), and the group ends when its last step does. The drive, the
+// intake and the outake can each follow a different step at once; a step
+// that starts on a motor already in use takes it over:
+//   PARALLEL,0,0,0
+//   DRIVE_MS,80,1200,0
+//   INTAKE_FOR_MS,127,800,200
+//   END_PARALLEL,0,0,0
+//
+// DRIVE_DIST, TURN_RELATIVE and ARC close the loop on the drive encoders
+// and the IMU, so they cover the same ground whatever the battery or drive
+// setup. Distances are in mm and angles in degrees, clockwise positive:
+//   DRIVE_DIST,600,100,0     600 mm forward at up to power 100 (0: default)
+//   TURN_RELATIVE,-90,0,0    quarter turn left at the default power
+//   ARC,90,500,0             quarter circle right, 500 mm radius, forward
+namespace plan {
+enum class StepType {
+    EMPTY,
+    DRIVE_MS,
+    TANK_MS,
+    TURN_HEADING,
+    WAIT_MS,
+    INTAKE_ON,
+    INTAKE_OFF,
+    OUTTAKE_ON,
+    OUTTAKE_OFF,
+    // New types go last: robot_config.bin stores the numeric type.
+    INTAKE_FOR_MS, // intake motor only: power, ms
+    OUTAKE_FOR_MS, // outake motor only: power, ms
+    PARALLEL,
+    END_PARALLEL,
+    DRIVE_DIST,    // mm, max power
+    TURN_RELATIVE, // degrees, max power
+    ARC            // degrees, radius in mm
+};
+constexpr int kStepTypeCount = 16;
+
+struct Step {
+    StepType type;
+    int value1; // speed or heading or ms
+    int value2; // duration for DRIVE_MS and *_FOR_MS, right speed for TANK_MS
+    int value3; // duration for TANK_MS; otherwise the start offset in a PARALLEL group
+};
+
+constexpr int kSlotCount = 3;
+// Steps each section of a plan holds on the brain. The Auton Planner and
+// Tahera size their arenas from it, so anything one saves the other loads
+// whole.
+constexpr std::size_t kPlanCapacity = 1024;
+constexpr char kSlotIndexFile[] = "auton_slot.txt";
+constexpr char kLegacyPlanFile[] = "auton_plans.txt";
+
+// Longest duration a step can usefully have: the whole auton period.
+constexpr int kMaxStepMs = 15000;
+// Longest distance or arc radius a step can usefully have: past the field
+// diagonal.
+constexpr int kMaxDistanceMm = 6000;
+
+const char* step_type_name(StepType type);
+
+// False if a value is outside what its step type can use: powers past
+// +/-127, durations or offsets below 0 or over kMaxStepMs, headings
+// outside 0-359, turns past a full circle, distances over kMaxDistanceMm.
+// Such steps still run, clamped, so this is for load-time warnings.
+bool step_in_range(const Step& step);
+
+// Unknown names parse as EMPTY so a typo skips a step instead of a plan.
+StepType parse_step_type(const char* token);
+
+// Cycle order used by the planner's TYPE button.
+StepType next_step_type(StepType type);
+StepType prev_step_type(StepType type);
+
+// auton_plans_slot<N>.txt for a 0-based slot; out-of-range slots map to 0.
+const char* slot_filename(int slot);
+
+// Parses both sections, replacing the vectors' contents. Returns false if
+// neither section has a step. Malformed lines are skipped and reported with
+// their line and column under `name` (see text::set_report).
+bool read_plans(FILE* file, std::vector<Step>* gps, std::vector<Step>* basic, const char* name = nullptr);
+
+// Writes both sections, every step including EMPTY ones.
+bool write_plans(FILE* file, const Step* gps, std::size_t gps_count, const Step* basic, std::size_t basic_count);
+
+// auton_slot.txt holds the 1-based slot; returns it 0-based, or 0 if the
+// file is unreadable or out of range.
+int read_slot(FILE* file);
+bool write_slot(FILE* file, int slot);
+} // namespace plan
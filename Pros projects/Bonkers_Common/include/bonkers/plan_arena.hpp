@@ -0,0 +1,77 @@
+#pragma once
+
+#include "bonkers/plan.hpp"
+
+#include <cstddef>
+#include <cstdio>
+
+// Plan storage that never touches the heap. An Arena is one block of steps
+// sized at build time; each plan carves a fixed-capacity PlanBuffer out of
+// it at startup, and the recorder, editor, loaders and savers all work on
+// that buffer in place.
+namespace plan {
+// A handle to steps inside an Arena; copies share the same storage.
+class PlanBuffer {
+    public:
+        PlanBuffer() = default;
+        PlanBuffer(Step* storage, std::size_t capacity) : m_steps(storage), m_capacity(capacity) {}
+
+        // O(1). False, counting the step as dropped, once the buffer is full.
+        bool push_back(const Step& step) {
+            if (m_size == m_capacity) {
+                ++m_dropped;
+                return false;
+            }
+            m_steps[m_size++] = step;
+            return true;
+        }
+
+        // Replaces the contents with up to capacity() of `steps`.
+        bool assign(const Step* steps, std::size_t count);
+
+        void clear() {
+            m_size = 0;
+            m_dropped = 0;
+        }
+
+        Step* data() { return m_steps; }
+        const Step* data() const { return m_steps; }
+        Step& operator[](std::size_t index) { return m_steps[index]; }
+        const Step& operator[](std::size_t index) const { return m_steps[index]; }
+        Step& back() { return m_steps[m_size - 1]; }
+        std::size_t size() const { return m_size; }
+        std::size_t capacity() const { return m_capacity; }
+        bool empty() const { return m_size == 0; }
+        bool full() const { return m_size == m_capacity; }
+
+        // Steps refused since the last clear() or assign().
+        std::size_t dropped() const { return m_dropped; }
+    private:
+        Step* m_steps = nullptr;
+        std::size_t m_capacity = 0;
+        std::size_t m_size = 0;
+        std::size_t m_dropped = 0;
+};
+
+template <std::size_t Capacity>
+class Arena {
+    public:
+        // Hands out the next `count` steps; the buffer is cut short if the
+        // arena has less left.
+        PlanBuffer carve(std::size_t count) {
+            const std::size_t take = count < Capacity - m_used ? count : Capacity - m_used;
+            PlanBuffer buffer(m_steps + m_used, take);
+            m_used += take;
+            return buffer;
+        }
+
+        std::size_t remaining() const { return Capacity - m_used; }
+    private:
+        Step m_steps[Capacity];
+        std::size_t m_used = 0;
+};
+
+// read_plans() straight into arena storage. Steps past a buffer's capacity
+// are dropped and counted in its dropped().
+bool read_plans(FILE* file, PlanBuffer* gps, PlanBuffer* basic, const char* name = nullptr);
+} // namespace plan
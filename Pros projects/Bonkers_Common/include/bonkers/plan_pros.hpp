@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// plan::Robot callbacks every brain program binds the same way: the PROS
+// clocks, the scheduler and the overrun log line. Motors and the IMU stay
+// with each program.
+namespace plan {
+std::uint32_t pros_millis(void* ctx);
+std::uint64_t pros_micros(void* ctx);
+// pros::Task::delay_until.
+void pros_delay_until(void* ctx, std::uint32_t* prev_ms, std::uint32_t delta_ms);
+// Prints "[auton] step N ended X us past its deadline", N counting from 1.
+void pros_overrun(void* ctx, std::size_t step, std::uint32_t late_us);
+} // namespace plan
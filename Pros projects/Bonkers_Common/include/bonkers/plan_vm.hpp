@@ -0,0 +1,138 @@
+#pragma once
+
+#include "bonkers/pid.hpp"
+#include "bonkers/plan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Runs auton plans. Steps are compiled once, when a plan is loaded, into a
+// flat list of instructions with motor powers and durations already
+// clamped, and EMPTY steps dropped. The interpreter dispatches each one
+// through a table and only looks at the abort flag and time budget between
+// instructions and inside waits and turns.
+//
+// A PARALLEL group compiles to a GROUP instruction followed by its
+// children. The group runs as a timeline: one loop wakes at the next child
+// start or end (at most kWaitSliceMs apart), and every child's start and
+// end times are measured from the group's start, so they land on the same
+// millisecond every run.
+//
+// DRIVE_DIST, TURN_REL and ARC are closed loop: a pid::Controller on the
+// encoder distance or the IMU heading, updated every kMotionTickMs, until
+// a pid::Settle says the error has stayed small. Each also has a timeout,
+// set at compile time from its estimated run time, so a robot pinned
+// against a wall still moves on.
+//
+// Time runs on a plan clock of absolute deadlines, counted from the start
+// of the run: a timed instruction ends its length after the previous one
+// was due to end, and every sleep is a delay_until() to the next deadline.
+// A task that wakes a millisecond late therefore makes that one boundary
+// late, not every one after it. Timed instructions that end more than
+// kOverrunReportUs late are reported through Robot::overrun.
+//
+// The VM never touches PROS directly: the robot is a set of callbacks, so
+// the brain programs and the host tools run exactly the same code.
+namespace plan {
+enum class Op : std::uint8_t {
+    DRIVE,   // set both sides, hold for `ms`, then brake the drive
+    TURN,    // turn in place to `heading` at up to `right` power, then brake
+    WAIT,    // hold the current outputs for `ms`
+    ROLLERS, // set both roller motors to `left` power; 0 brakes them
+    INTAKE,  // run the intake motor at `left` power for `ms`, then brake it
+    OUTAKE,  // run the outake motor at `left` power for `ms`, then brake it
+    GROUP,      // run the next `ms` instructions as one timeline
+    DRIVE_DIST, // drive `distance` mm straight at up to `right` power
+    TURN_REL,   // turn in place by `heading` degrees at up to `right` power
+    ARC         // turn by `heading` degrees along a `distance` mm radius
+};
+constexpr int kOpCount = 10;
+
+struct Instr {
+    Op op;
+    std::int8_t left;      // DRIVE: left power; ROLLERS, INTAKE, OUTAKE: power
+    std::int8_t right;     // DRIVE: right power; TURN: max power
+    std::int16_t heading;  // TURN: target, degrees as written in the plan; TURN_REL, ARC: change
+    std::int32_t distance; // DRIVE_DIST: mm, signed; ARC: radius, mm
+    std::uint32_t ms;      // DRIVE, WAIT, INTAKE, OUTAKE; GROUP: child count; closed loop: timeout
+    std::uint32_t at_ms;   // start offset inside a GROUP
+    std::uint16_t step = 0; // index of the plan step it came from
+};
+
+// Children past this many start a new group.
+constexpr std::size_t kMaxGroupSize = 16;
+
+// Turn controller shared by every program.
+constexpr double kTurnKp = 1.5;
+constexpr double kTurnToleranceDeg = 2.0;
+constexpr int kTurnMaxPower = 60;
+constexpr std::uint32_t kTurnPollMs = 20;
+
+// Waits are sliced so an abort lands within one slice.
+constexpr std::uint32_t kWaitSliceMs = 20;
+
+// One scheduler tick of lateness is normal; more is worth a log line.
+constexpr std::uint32_t kOverrunReportUs = 1000;
+
+// Closed-loop steps. Drive gains are power per mm, turn gains power per
+// degree; a power of 0 in the plan means the default here.
+constexpr pid::Gains kDriveGains = {0.4, 0.6, 0.025, 40.0};
+constexpr pid::Gains kTurnGains = {1.6, 2.0, 0.08, 8.0};
+constexpr double kHeadingHoldKp = 2.0; // DRIVE_DIST: power per degree off the start heading
+constexpr double kDriveToleranceMm = 10.0;
+constexpr double kTurnSettleDeg = 1.5;
+constexpr std::uint32_t kSettleMs = 100;
+constexpr std::uint32_t kMotionTickMs = 10;
+constexpr int kDriveMaxPower = 100;
+constexpr int kArcMaxPower = 80;
+
+// Everything the VM needs from a robot. `ctx` is passed back to each call.
+// `aborted` may be null when the caller has no abort path, and `micros` or
+// `overrun` when it does not want overrun reports. `delay_until` has the
+// semantics of pros::Task::delay_until: wake at *prev_ms + delta_ms, then
+// advance *prev_ms to that time. `millis` and `micros` may count from
+// different epochs.
+struct Robot {
+    void* ctx;
+    void (*drive)(void* ctx, int left, int right);
+    void (*brake_drive)(void* ctx);
+    void (*rollers)(void* ctx, int power);
+    void (*intake)(void* ctx, int power); // 0 brakes
+    void (*outake)(void* ctx, int power); // 0 brakes
+    void (*stop_all)(void* ctx);
+    double (*heading)(void* ctx);
+    std::uint32_t (*millis)(void* ctx);
+    void (*delay_until)(void* ctx, std::uint32_t* prev_ms, std::uint32_t delta_ms);
+    bool (*aborted)(void* ctx);
+    // Distance each side has driven, in mm, from any fixed zero.
+    double (*left_mm)(void* ctx);
+    double (*right_mm)(void* ctx);
+    double track_width_mm; // between the left and right wheels, for ARC
+    std::uint64_t (*micros)(void* ctx);
+    void (*overrun)(void* ctx, std::size_t step, std::uint32_t late_us);
+};
+
+// Turn rate and drive speed estimate_ms() assumes; roughly what the
+// controllers hold on the 6WD at kTurnMaxPower and at full power.
+constexpr double kTurnEstimateDegPerSec = 180.0;
+constexpr double kDriveEstimateMmPerSec = 1200.0;
+
+// Replaces `out` with the instructions for `count` steps. Steps between a
+// PARALLEL and the next PARALLEL or END_PARALLEL (or the plan's end) become
+// one GROUP, split every kMaxGroupSize children; empty groups are dropped.
+void compile(const Step* steps, std::size_t count, std::vector<Instr>* out);
+
+// Runs `code` until its end, an abort, or millis() reaching `end_ms` (0 for
+// no budget). When a timed instruction or a GROUP is cut short everything is
+// stopped; otherwise the outputs are left as the last instruction set them.
+// Returns false if the program did not finish.
+bool run(const std::vector<Instr>& code, const Robot& robot, std::uint32_t end_ms);
+
+// Expected run time of `code` in ms: DRIVEs, WAITs and roller runs in
+// full, each TURN at kTurnEstimateDegPerSec from the previous turn's target
+// (the first from `start_heading`), closed-loop steps at the estimate
+// speeds plus kSettleMs, and each GROUP as its longest child.
+// Used to flag plans that cannot finish in 15 s.
+std::uint32_t estimate_ms(const std::vector<Instr>& code, double start_heading = 0);
+} // namespace plan
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Opens files on the microSD by bare name ("auton_slot.txt") or by any of
+// the path spellings the programs have used over time. The first prefix
+// that works is remembered per name, and a name that could not be read is
+// remembered as missing, so optional files cost one probe per run instead
+// of dozens of fopen calls and retry sleeps. The card is probed once.
+namespace sd {
+struct Stats {
+    std::uint32_t fopen_calls;   // every std::fopen attempt, hit or miss
+    std::uint32_t cache_hits;    // opens served by a remembered prefix
+    std::uint32_t cached_misses; // reads refused because the name is known missing
+};
+
+// Same contract as std::fopen. Writes that succeed update the cache, so a
+// file created this run can be read back by name.
+FILE* open(const char* name, const char* mode);
+
+// Extends an open, writable file to `bytes` and seeks back, so FatFs links
+// the clusters up front rather than mid-write. The new space is not zeroed.
+bool preallocate(FILE* file, long bytes);
+
+// True if a card was present when first asked.
+bool mounted();
+
+// Forgets every remembered path and re-probes the card on next use; call
+// after the card may have been swapped or edited externally.
+void reset();
+
+// True for paths already under /usd/Images/ (with or without the leading slash).
+bool is_images_path(const std::string& path);
+
+// Maps a config entry ("jerkbot.bmp", "/usd/old/jerkbot.bmp") to its
+// /usd/Images/ path; empty stays empty.
+std::string coerce_images_path(const std::string& path);
+
+const Stats& stats();
+
+// Prints stats() to the terminal.
+void log_stats();
+} // namespace sd
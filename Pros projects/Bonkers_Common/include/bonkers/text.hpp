@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+// Small string helpers for the config and plan files on the microSD.
+namespace text {
+// False if either argument is null.
+bool starts_with(const char* str, const char* prefix);
+
+// Case-insensitive; `suffix` must be lowercase (".bmp").
+bool ends_with_ci(const std::string& value, const char* suffix);
+
+// Strips trailing '\n' and '\r' in place, as left behind by fgets.
+void chomp_line(char* line);
+
+// Hands out a file's lines in place from one caller-owned buffer, reading
+// the file in buffer-sized chunks. Lines come back NUL-terminated without
+// their line ending, so a Cursor can split them without copying or
+// allocating. A UTF-8 byte order mark at the start of the file is skipped.
+class LineReader {
+    public:
+        LineReader(FILE* file, char* buffer, std::size_t capacity);
+
+        // The next line, or nullptr at the end of the file. A line longer
+        // than capacity - 1 bytes is cut there and its rest skipped.
+        char* next();
+
+        // 1-based number of the line last returned.
+        int line() const { return m_line; }
+
+        // True if the line last returned filled the buffer, so anything
+        // past capacity - 1 bytes was skipped.
+        bool cut() const { return m_cut; }
+    private:
+        bool fill();
+        char* take(char* line);
+        void skip_rest();
+
+        FILE* m_file;
+        char* m_buffer;
+        std::size_t m_capacity;
+        std::size_t m_begin = 0;
+        std::size_t m_end = 0;
+        int m_line = 0;
+        bool m_eof = false;
+        bool m_cut = false;
+        bool m_skip = false;
+};
+
+// Splits one line in place. Tokens are trimmed and NUL-terminated by
+// overwriting their delimiter; columns are 1-based for error reports.
+class Cursor {
+    public:
+        // `first_column` is the column of line[0] when `line` is part of a
+        // longer physical line.
+        explicit Cursor(char* line, int first_column = 1)
+            : m_line(line), m_pos(line), m_first_column(first_column) {}
+
+        void skip_spaces();
+
+        // True if only spaces are left.
+        bool at_end();
+
+        // The text up to `delimiter` (consumed) or the end of the line.
+        // `found` reports whether the delimiter was there.
+        char* token(char delimiter, std::size_t* length, bool* found = nullptr);
+
+        // A decimal integer as %d reads one: leading spaces, an optional
+        // sign, then digits. Values past int's range are clamped.
+        bool integer(int* out);
+
+        // Consumes `ch` after optional spaces.
+        bool consume(char ch);
+
+        int column() const { return static_cast<int>(m_pos - m_line) + m_first_column; }
+        char* rest() { return m_pos; }
+    private:
+        char* m_line;
+        char* m_pos;
+        int m_first_column;
+};
+
+// Uppercases in place.
+void uppercase(char* str);
+
+// Parse errors go to the terminal as "[tag] name:line:column: message"
+// unless another sink is installed; nullptr silences them (fuzzing, benches).
+using ReportFn = void (*)(const char* tag, const char* name, int line, int column, const char* message);
+void set_report(ReportFn fn);
+void report(const char* tag, const char* name, int line, int column, const char* message);
+} // namespace text
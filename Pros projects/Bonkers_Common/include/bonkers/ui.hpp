@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Touch-screen buttons shared by the brain menus.
+namespace ui {
+struct Rect {
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
+// Edges count as inside, matching the outline draw_button() paints.
+inline bool hit_test(const Rect& r, int x, int y) {
+    return x >= r.x && x <= (r.x + r.w) && y >= r.y && y <= (r.y + r.h);
+}
+
+// Outlined button with a left-aligned medium label.
+void draw_button(const Rect& r, const char* label, std::uint32_t color);
+} // namespace ui
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// VBI ("V5 brain image") is a screen-native image format: RGB565 pixels,
+// rows stored top-down, each row run-length encoded on its own so it can be
+// expanded straight into a copy_area row buffer.
+//
+// Layout (little-endian):
+//   header  16 bytes   "VBI1", u16 width, u16 height, u8 pixel format,
+//                      u8 codec, u16 reserved, u32 payload bytes
+//   rows    height x   u16 encoded length, then that many bytes
+//
+// RLE packets: a control byte c. If c & 0x80, the next pixel repeats
+// (c & 0x7F) + 1 times; otherwise c + 1 literal pixels follow.
+namespace vbi {
+constexpr char kMagic[4] = {'V', 'B', 'I', '1'};
+constexpr std::size_t kHeaderSize = 16;
+constexpr std::uint8_t kPixelRgb565 = 1;
+constexpr std::uint8_t kCodecRaw = 0;
+constexpr std::uint8_t kCodecRle = 1;
+constexpr int kMaxRun = 128;
+constexpr int kMaxWidth = 480;
+constexpr int kMaxHeight = 240;
+// Worst case for one RLE row: a control byte per 128 literal pixels.
+constexpr std::size_t kMaxRowBytes = (kMaxWidth / kMaxRun + 1) + kMaxWidth * 2;
+
+struct Header {
+    std::uint16_t width;
+    std::uint16_t height;
+    std::uint8_t pixel_format;
+    std::uint8_t codec;
+    std::uint32_t payload_size;
+};
+
+inline bool has_magic(const std::uint8_t* bytes) {
+    return std::memcmp(bytes, kMagic, sizeof(kMagic)) == 0;
+}
+
+inline bool parse_header(const std::uint8_t* bytes, Header* out) {
+    if (!bytes || !out || !has_magic(bytes)) {
+        return false;
+    }
+    out->width = static_cast<std::uint16_t>(bytes[4] | (bytes[5] << 8));
+    out->height = static_cast<std::uint16_t>(bytes[6] | (bytes[7] << 8));
+    out->pixel_format = bytes[8];
+    out->codec = bytes[9];
+    out->payload_size = static_cast<std::uint32_t>(bytes[12]) | (static_cast<std::uint32_t>(bytes[13]) << 8) |
+                        (static_cast<std::uint32_t>(bytes[14]) << 16) |
+                        (static_cast<std::uint32_t>(bytes[15]) << 24);
+    return out->width > 0 && out->height > 0 && out->width <= kMaxWidth && out->height <= kMaxHeight &&
+           out->pixel_format == kPixelRgb565 && (out->codec == kCodecRaw || out->codec == kCodecRle);
+}
+
+inline void write_header(const Header& header, std::uint8_t* out) {
+    std::memcpy(out, kMagic, sizeof(kMagic));
+    out[4] = static_cast<std::uint8_t>(header.width & 0xFF);
+    out[5] = static_cast<std::uint8_t>(header.width >> 8);
+    out[6] = static_cast<std::uint8_t>(header.height & 0xFF);
+    out[7] = static_cast<std::uint8_t>(header.height >> 8);
+    out[8] = header.pixel_format;
+    out[9] = header.codec;
+    out[10] = 0;
+    out[11] = 0;
+    for (int i = 0; i < 4; ++i) {
+        out[12 + i] = static_cast<std::uint8_t>((header.payload_size >> (8 * i)) & 0xFF);
+    }
+}
+
+inline std::uint16_t to_rgb565(std::uint32_t xrgb) {
+    const std::uint32_t r = (xrgb >> 16) & 0xFF;
+    const std::uint32_t g = (xrgb >> 8) & 0xFF;
+    const std::uint32_t b = xrgb & 0xFF;
+    return static_cast<std::uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+// Widens with bit replication so pure white stays 0xFFFFFF.
+inline std::uint32_t to_xrgb(std::uint16_t rgb565) {
+    const std::uint32_t r5 = (rgb565 >> 11) & 0x1F;
+    const std::uint32_t g6 = (rgb565 >> 5) & 0x3F;
+    const std::uint32_t b5 = rgb565 & 0x1F;
+    const std::uint32_t r = (r5 << 3) | (r5 >> 2);
+    const std::uint32_t g = (g6 << 2) | (g6 >> 4);
+    const std::uint32_t b = (b5 << 3) | (b5 >> 2);
+    return (r << 16) | (g << 8) | b;
+}
+
+// Expands one encoded row into XRGB pixels. Returns false on a malformed
+// row (overrun of either buffer or a short row).
+inline bool decode_row(const std::uint8_t* src, std::size_t len, std::uint8_t codec, std::uint32_t* dst,
+                       int width) {
+    if (codec == kCodecRaw) {
+        if (len != static_cast<std::size_t>(width) * 2) {
+            return false;
+        }
+        for (int i = 0; i < width; ++i) {
+            dst[i] = to_xrgb(static_cast<std::uint16_t>(src[i * 2] | (src[i * 2 + 1] << 8)));
+        }
+        return true;
+    }
+
+    std::size_t pos = 0;
+    int col = 0;
+    while (pos < len && col < width) {
+        const std::uint8_t control = src[pos++];
+        const int count = (control & 0x7F) + 1;
+        if (col + count > width) {
+            return false;
+        }
+        if (control & 0x80) {
+            if (pos + 2 > len) {
+                return false;
+            }
+            const std::uint32_t color = to_xrgb(static_cast<std::uint16_t>(src[pos] | (src[pos + 1] << 8)));
+            pos += 2;
+            for (int i = 0; i < count; ++i) {
+                dst[col++] = color;
+            }
+        } else {
+            if (pos + static_cast<std::size_t>(count) * 2 > len) {
+                return false;
+            }
+            for (int i = 0; i < count; ++i) {
+                dst[col++] = to_xrgb(static_cast<std::uint16_t>(src[pos] | (src[pos + 1] << 8)));
+                pos += 2;
+            }
+        }
+    }
+    return col == width;
+}
+} // namespace vbi
@@ -0,0 +1,331 @@
+#include "bonkers/config_bundle.hpp"
+
+#include "bonkers/crc32.hpp"
+#include "bonkers/keyword_table.hpp"
+#include "bonkers/text.hpp"
+
+#include <cstring>
+
+namespace config {
+namespace {
+constexpr char kMagic[4] = {'B', 'C', 'F', 'G'};
+constexpr std::size_t kStepBytes = 13;
+constexpr std::size_t kMaxStringBytes = 255;
+// Every field at its largest: four image names and three slots of two full
+// plans (about 80 KB). Anything bigger is not a bundle.
+constexpr std::size_t kMaxBundleBytes =
+    kHeaderSize + 4 + kActionCount + 4 * (1 + kMaxStringBytes) +
+    plan::kSlotCount * (5 + 2 * plan::kPlanCapacity * kStepBytes);
+
+constexpr const char* kActionKeys[kActionCount] = {
+    "INTAKE_IN", "INTAKE_OUT", "OUTAKE_OUT", "OUTAKE_IN", "GPS_ENABLE", "GPS_DISABLE", "SIX_WHEEL_ON", "SIX_WHEEL_OFF",
+};
+
+constexpr std::uint8_t kDefaultButtons[kActionCount] = {
+    kButtonL1, kButtonL2, kButtonR1, kButtonR2, kButtonA, kButtonB, kButtonY, kButtonX,
+};
+
+// Same order as Button, starting at kButtonL1.
+constexpr const char* kButtonNames[] = {"L1", "L2", "R1", "R2", "UP", "DOWN", "LEFT", "RIGHT", "X", "B", "Y", "A"};
+constexpr int kButtonCount = static_cast<int>(sizeof(kButtonNames) / sizeof(kButtonNames[0]));
+static_assert(kButtonL1 + kButtonCount - 1 == kButtonA, "one name per Button");
+
+bool valid_button(std::uint8_t button) {
+    return button >= kButtonL1 && button <= kButtonA;
+}
+
+constexpr text::KeywordTable<16> kActionTable(kActionKeys);
+static_assert(kActionTable.perfect(), "action keys need a collision-free seed");
+constexpr text::KeywordTable<32> kButtonTable(kButtonNames);
+static_assert(kButtonTable.perfect(), "button names need a collision-free seed");
+
+// Same order as the kHas* flags.
+constexpr const char* kImageKeys[] = {"SPLASH", "AUTON", "DRIVER", "RUN"};
+constexpr text::KeywordTable<8> kImageTable(kImageKeys);
+static_assert(kImageTable.perfect(), "image keys need a collision-free seed");
+static_assert(kHasRun == 1u << 3, "image key index i sets flag bit i");
+
+// Both text files are a handful of short KEY=value lines.
+constexpr std::size_t kLineBufferSize = 256;
+
+// One KEY=value line, split in place with the key uppercased. False for
+// blank lines and comments, and (reported) for lines without '='.
+bool split_entry(char* line, const char* name, int line_number, char** key, std::size_t* key_length,
+                 char** value, std::size_t* value_length, int* value_column) {
+    text::Cursor cursor(line);
+    if (cursor.at_end() || *cursor.rest() == '#') {
+        return false;
+    }
+    bool found = false;
+    *key = cursor.token('=', key_length, &found);
+    if (!found) {
+        text::report("config", name, line_number, cursor.column(), "expected KEY=value; line skipped");
+        return false;
+    }
+    text::uppercase(*key);
+    cursor.skip_spaces();
+    *value_column = cursor.column();
+    *value = cursor.token('\0', value_length);
+    return true;
+}
+
+void put_u16(std::vector<std::uint8_t>* out, std::uint16_t value) {
+    out->push_back(static_cast<std::uint8_t>(value & 0xFF));
+    out->push_back(static_cast<std::uint8_t>(value >> 8));
+}
+
+void put_u32(std::vector<std::uint8_t>* out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out->push_back(static_cast<std::uint8_t>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+bool put_string(std::vector<std::uint8_t>* out, const std::string& value) {
+    if (value.size() > kMaxStringBytes) {
+        return false;
+    }
+    out->push_back(static_cast<std::uint8_t>(value.size()));
+    out->insert(out->end(), value.begin(), value.end());
+    return true;
+}
+
+void put_steps(std::vector<std::uint8_t>* out, const std::vector<plan::Step>& steps) {
+    for (const plan::Step& step : steps) {
+        out->push_back(static_cast<std::uint8_t>(step.type));
+        put_u32(out, static_cast<std::uint32_t>(step.value1));
+        put_u32(out, static_cast<std::uint32_t>(step.value2));
+        put_u32(out, static_cast<std::uint32_t>(step.value3));
+    }
+}
+
+// Bounds-checked walk over the body; any overrun sets `ok` false and
+// every later read returns zeros.
+struct Reader {
+    const std::uint8_t* pos;
+    std::size_t left;
+    bool ok;
+
+    const std::uint8_t* take(std::size_t count) {
+        if (!ok || count > left) {
+            ok = false;
+            return nullptr;
+        }
+        const std::uint8_t* bytes = pos;
+        pos += count;
+        left -= count;
+        return bytes;
+    }
+
+    std::uint8_t u8() {
+        const std::uint8_t* bytes = take(1);
+        return bytes ? bytes[0] : 0;
+    }
+
+    std::uint16_t u16() {
+        const std::uint8_t* bytes = take(2);
+        return bytes ? static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8)) : 0;
+    }
+
+    std::uint32_t u32() {
+        const std::uint8_t* bytes = take(4);
+        if (!bytes) {
+            return 0;
+        }
+        return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+               (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+    }
+
+    void string(std::string* out) {
+        const std::uint8_t len = u8();
+        const std::uint8_t* bytes = take(len);
+        if (bytes) {
+            out->assign(reinterpret_cast<const char*>(bytes), len);
+        }
+    }
+
+    void steps(std::size_t count, std::vector<plan::Step>* out) {
+        out->clear();
+        if (!ok || count * kStepBytes > left) {
+            ok = false;
+            return;
+        }
+        out->reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint8_t type = u8();
+            plan::Step step;
+            step.type = type < plan::kStepTypeCount ? static_cast<plan::StepType>(type) : plan::StepType::EMPTY;
+            step.value1 = static_cast<std::int32_t>(u32());
+            step.value2 = static_cast<std::int32_t>(u32());
+            step.value3 = static_cast<std::int32_t>(u32());
+            out->push_back(step);
+        }
+    }
+};
+} // namespace
+
+const char* action_key(Action action) {
+    const int index = static_cast<int>(action);
+    return index >= 0 && index < kActionCount ? kActionKeys[index] : "";
+}
+
+const char* button_name(std::uint8_t button) {
+    return valid_button(button) ? kButtonNames[button - kButtonL1] : "?";
+}
+
+void default_buttons(std::uint8_t* buttons) {
+    std::memcpy(buttons, kDefaultButtons, sizeof(kDefaultButtons));
+}
+
+void read_images(FILE* file, Images* out, const char* name) {
+    *out = Images{};
+    if (!file) {
+        return;
+    }
+    std::string* const fields[] = {&out->splash, &out->auton, &out->driver, &out->run};
+    char buffer[kLineBufferSize];
+    text::LineReader reader(file, buffer, sizeof(buffer));
+    while (char* line = reader.next()) {
+        char* key;
+        char* value;
+        std::size_t key_length;
+        std::size_t value_length;
+        int value_column;
+        if (!split_entry(line, name, reader.line(), &key, &key_length, &value, &value_length, &value_column)) {
+            continue;
+        }
+        const int index = kImageTable.find(key, key_length, -1);
+        if (index < 0) {
+            text::report("config", name, reader.line(), 1, "unknown image key; expected SPLASH, AUTON, DRIVER or RUN");
+            continue;
+        }
+        fields[index]->assign(value, value_length);
+        out->flags |= static_cast<std::uint8_t>(1u << index);
+    }
+}
+
+void read_buttons(FILE* file, std::uint8_t* buttons, const char* name) {
+    if (!file) {
+        return;
+    }
+    char buffer[kLineBufferSize];
+    text::LineReader reader(file, buffer, sizeof(buffer));
+    while (char* line = reader.next()) {
+        char* key;
+        char* value;
+        std::size_t key_length;
+        std::size_t value_length;
+        int value_column;
+        if (!split_entry(line, name, reader.line(), &key, &key_length, &value, &value_length, &value_column)) {
+            continue;
+        }
+        const int action = kActionTable.find(key, key_length, -1);
+        if (action < 0) {
+            text::report("config", name, reader.line(), 1, "unknown action; line skipped");
+            continue;
+        }
+        text::uppercase(value);
+        const int button = kButtonTable.find(value, value_length, -1);
+        if (button < 0) {
+            text::report("config", name, reader.line(), value_column, "unknown button; mapping left as it was");
+            continue;
+        }
+        buttons[action] = static_cast<std::uint8_t>(kButtonL1 + button);
+    }
+}
+
+bool read_bundle(FILE* file, Config* out) {
+    if (!file || std::fseek(file, 0, SEEK_END) != 0) {
+        return false;
+    }
+    const long size = std::ftell(file);
+    if (size < static_cast<long>(kHeaderSize) || size > static_cast<long>(kMaxBundleBytes) ||
+        std::fseek(file, 0, SEEK_SET) != 0) {
+        return false;
+    }
+    std::vector<std::uint8_t> bytes(static_cast<std::size_t>(size));
+    if (std::fread(bytes.data(), 1, bytes.size(), file) != bytes.size()) {
+        return false;
+    }
+
+    Reader header{bytes.data(), kHeaderSize, true};
+    if (std::memcmp(header.take(sizeof(kMagic)), kMagic, sizeof(kMagic)) != 0 || header.u8() != kVersion) {
+        return false;
+    }
+    header.take(3);
+    const std::uint32_t body_size = header.u32();
+    const std::uint32_t body_crc = header.u32();
+    const std::uint8_t* body = bytes.data() + kHeaderSize;
+    if (body_size != bytes.size() - kHeaderSize || crc::crc32(body, body_size) != body_crc) {
+        return false;
+    }
+
+    Reader in{body, body_size, true};
+    out->images.flags = in.u8();
+    out->active_slot = in.u8();
+    const std::uint8_t action_count = in.u8();
+    const std::uint8_t slot_count = in.u8();
+    if (action_count != kActionCount || slot_count != plan::kSlotCount || out->active_slot >= plan::kSlotCount) {
+        return false;
+    }
+    for (std::uint8_t& button : out->buttons) {
+        button = in.u8();
+        if (!valid_button(button)) {
+            return false;
+        }
+    }
+    in.string(&out->images.splash);
+    in.string(&out->images.auton);
+    in.string(&out->images.driver);
+    in.string(&out->images.run);
+    for (SlotPlans& slot : out->slots) {
+        slot.loaded = in.u8() != 0;
+        const std::uint16_t gps_count = in.u16();
+        const std::uint16_t basic_count = in.u16();
+        in.steps(gps_count, &slot.gps);
+        in.steps(basic_count, &slot.basic);
+    }
+    return in.ok && in.left == 0;
+}
+
+bool encode_bundle(const Config& config, std::vector<std::uint8_t>* out) {
+    if (config.active_slot < 0 || config.active_slot >= plan::kSlotCount) {
+        return false;
+    }
+    std::vector<std::uint8_t>& bytes = *out;
+    bytes.assign(kHeaderSize, 0);
+    bytes.push_back(config.images.flags);
+    bytes.push_back(static_cast<std::uint8_t>(config.active_slot));
+    bytes.push_back(kActionCount);
+    bytes.push_back(plan::kSlotCount);
+    bytes.insert(bytes.end(), config.buttons, config.buttons + kActionCount);
+    const bool ok = put_string(&bytes, config.images.splash) && put_string(&bytes, config.images.auton) &&
+              put_string(&bytes, config.images.driver) && put_string(&bytes, config.images.run);
+    for (const SlotPlans& slot : config.slots) {
+        if (slot.gps.size() > plan::kPlanCapacity || slot.basic.size() > plan::kPlanCapacity) {
+            return false;
+        }
+        bytes.push_back(slot.loaded ? 1 : 0);
+        put_u16(&bytes, static_cast<std::uint16_t>(slot.gps.size()));
+        put_u16(&bytes, static_cast<std::uint16_t>(slot.basic.size()));
+        put_steps(&bytes, slot.gps);
+        put_steps(&bytes, slot.basic);
+    }
+    if (!ok || bytes.size() > kMaxBundleBytes) {
+        return false;
+    }
+
+    const std::uint32_t body_size = static_cast<std::uint32_t>(bytes.size() - kHeaderSize);
+    std::vector<std::uint8_t> header;
+    header.insert(header.end(), kMagic, kMagic + sizeof(kMagic));
+    header.push_back(kVersion);
+    header.insert(header.end(), 3, 0);
+    put_u32(&header, body_size);
+    put_u32(&header, crc::crc32(bytes.data() + kHeaderSize, body_size));
+    std::memcpy(bytes.data(), header.data(), kHeaderSize);
+    return true;
+}
+
+bool write_bundle(FILE* file, const std::vector<std::uint8_t>& bytes) {
+    return file && std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() && std::fflush(file) == 0;
+}
+} // namespace config
@@ -0,0 +1,30 @@
+#include "bonkers/crc32.hpp"
+
+#include <array>
+
+namespace crc {
+namespace {
+constexpr std::array<std::uint32_t, 256> make_table() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t value = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+        }
+        table[i] = value;
+    }
+    return table;
+}
+
+constexpr std::array<std::uint32_t, 256> kTable = make_table();
+} // namespace
+
+std::uint32_t crc32(const void* data, std::size_t size, std::uint32_t crc) {
+    const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = kTable[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+} // namespace crc
@@ -0,0 +1,187 @@
+#include "bonkers/drive_trace.hpp"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace trace {
+namespace {
+using plan::Step;
+using plan::StepType;
+
+enum class Motion { STOP, STRAIGHT, SPIN, CURVE };
+
+// Samples fitted to one pair of powers, or several such runs going the same
+// way that become one closed-loop step.
+struct Span {
+    Motion motion = Motion::STOP;
+    std::size_t begin = 0;
+    std::size_t end = 0; // one past the last sample
+    long left_sum = 0;   // power times samples
+    long right_sum = 0;
+    int peak = 0;        // largest |power|
+};
+
+Motion classify(int left, int right, const FitOptions& options) {
+    if (std::abs(left) <= options.stop_power && std::abs(right) <= options.stop_power) {
+        return Motion::STOP;
+    }
+    if (left * right > 0 && std::abs(left - right) <= options.straight_band) {
+        return Motion::STRAIGHT;
+    }
+    if (left * right < 0 && std::abs(left + right) <= options.straight_band) {
+        return Motion::SPIN;
+    }
+    return Motion::CURVE;
+}
+
+// Straights and spins the same way become one step; so do stops.
+bool extends(const Span& span, Motion motion, int left, const FitOptions& options) {
+    if (span.motion != motion) {
+        return false;
+    }
+    if (motion == Motion::STOP) {
+        return true;
+    }
+    if (!options.closed_loop || motion == Motion::CURVE) {
+        return false;
+    }
+    return (span.left_sum > 0) == (left > 0);
+}
+
+// Unwrapped heading change from sample `begin` to `last`, clockwise.
+double turned(const Sample* samples, std::size_t begin, std::size_t last) {
+    double total = 0;
+    for (std::size_t i = begin + 1; i <= last; ++i) {
+        double change = samples[i].heading - samples[i - 1].heading;
+        if (change > 180) change -= 360;
+        if (change < -180) change += 360;
+        total += change;
+    }
+    return total;
+}
+
+// Pushes `step`, split into several if its amount (value3 for TANK_MS,
+// value1 otherwise) is past `limit`.
+bool push_parts(Step step, int limit, plan::PlanBuffer* out) {
+    int& amount = step.type == StepType::TANK_MS ? step.value3 : step.value1;
+    int remaining = amount;
+    while (std::abs(remaining) > limit) {
+        amount = remaining > 0 ? limit : -limit;
+        if (!out->push_back(step)) {
+            return false;
+        }
+        remaining -= amount;
+    }
+    amount = remaining;
+    return out->push_back(step);
+}
+
+bool push_span(const Sample* samples, std::size_t count, const Span& span, const FitOptions& options,
+               plan::PlanBuffer* out) {
+    const long length = static_cast<long>(span.end - span.begin);
+    const int ms = static_cast<int>(length * options.sample_ms);
+    if (span.motion == Motion::STOP) {
+        return push_parts({StepType::WAIT_MS, ms, 0, 0}, plan::kMaxStepMs, out);
+    }
+    const Step timed{StepType::TANK_MS, static_cast<int>(span.left_sum / length),
+                     static_cast<int>(span.right_sum / length), ms};
+    if (!options.closed_loop) {
+        return push_parts(timed, plan::kMaxStepMs, out);
+    }
+
+    // Positions are read as each power is set, so a span's movement shows
+    // up by the first sample after it.
+    const std::size_t last = std::min(span.end, count - 1);
+    const double travelled = (samples[last].left_mm - samples[span.begin].left_mm + samples[last].right_mm -
+                              samples[span.begin].right_mm) / 2;
+    const double turn = turned(samples, span.begin, last);
+    const int degrees = static_cast<int>(std::lround(turn));
+    switch (span.motion) {
+        case Motion::STRAIGHT:
+            if (std::abs(travelled) >= options.min_mm) {
+                return push_parts({StepType::DRIVE_DIST, static_cast<int>(std::lround(travelled)), span.peak, 0},
+                                  plan::kMaxDistanceMm, out);
+            }
+            break;
+        case Motion::SPIN:
+            if (std::abs(turn) >= options.min_deg) {
+                return push_parts({StepType::TURN_RELATIVE, degrees, span.peak, 0}, 360, out);
+            }
+            break;
+        case Motion::CURVE: {
+            const double radius = travelled / (std::abs(turn) * 3.14159265358979323846 / 180.0);
+            if (travelled >= options.min_mm && std::abs(turn) >= options.min_deg && std::abs(degrees) <= 360 &&
+                radius <= plan::kMaxDistanceMm) {
+                return out->push_back({StepType::ARC, degrees, static_cast<int>(std::lround(radius)), 0});
+            }
+            break;
+        }
+        case Motion::STOP:
+            break;
+    }
+    return push_parts(timed, plan::kMaxStepMs, out);
+}
+} // namespace
+
+bool still(const Sample& sample, const FitOptions& options) {
+    return classify(sample.left, sample.right, options) == Motion::STOP;
+}
+
+bool fit(const Sample* samples, std::size_t count, const FitOptions& options, plan::PlanBuffer* out) {
+    std::size_t begin = 0;
+    std::size_t end = count;
+    while (begin < end && still(samples[begin], options)) {
+        ++begin;
+    }
+    while (end > begin && still(samples[end - 1], options)) {
+        --end;
+    }
+    return fit_range(samples, count, begin, end, options, out);
+}
+
+bool fit_range(const Sample* samples, std::size_t count, std::size_t begin, std::size_t end,
+               const FitOptions& options, plan::PlanBuffer* out) {
+    // Growing each run for as long as it fits is the fewest runs for a
+    // bound on the largest error; each run's power is its midrange.
+    Span span;
+    bool open = false;
+    for (std::size_t first = begin; first < end;) {
+        int left_min = samples[first].left;
+        int left_max = left_min;
+        int right_min = samples[first].right;
+        int right_max = right_min;
+        std::size_t next = first + 1;
+        for (; next < end; ++next) {
+            const int left = samples[next].left;
+            const int right = samples[next].right;
+            if (std::max(left_max, left) - std::min(left_min, left) > 2 * options.power_error ||
+                std::max(right_max, right) - std::min(right_min, right) > 2 * options.power_error) {
+                break;
+            }
+            left_min = std::min(left_min, left);
+            left_max = std::max(left_max, left);
+            right_min = std::min(right_min, right);
+            right_max = std::max(right_max, right);
+        }
+        const int left = (left_min + left_max) / 2;
+        const int right = (right_min + right_max) / 2;
+        const Motion motion = classify(left, right, options);
+
+        if (!open || !extends(span, motion, left, options)) {
+            if (open && !push_span(samples, count, span, options, out)) {
+                return false;
+            }
+            span = Span{};
+            span.motion = motion;
+            span.begin = first;
+            open = true;
+        }
+        span.end = next;
+        span.left_sum += static_cast<long>(left) * static_cast<long>(next - first);
+        span.right_sum += static_cast<long>(right) * static_cast<long>(next - first);
+        span.peak = std::max({span.peak, std::abs(left), std::abs(right)});
+        first = next;
+    }
+    return !open || push_span(samples, count, span, options, out);
+}
+} // namespace trace
@@ -0,0 +1,167 @@
+#include "bonkers/image_cache.hpp"
+
+#include "pros/screen.hpp"
+
+#include <algorithm>
+
+namespace image {
+namespace {
+struct FrameSink {
+    std::uint32_t* pixels;
+    int width;
+};
+
+void store_row(void* ctx, int row, const std::uint32_t* pixels, int width) {
+    const auto* sink = static_cast<const FrameSink*>(ctx);
+    std::copy(pixels, pixels + width, sink->pixels + static_cast<std::size_t>(row) * sink->width);
+}
+} // namespace
+
+Cache::Cache(std::size_t budget_bytes, OpenFn open_fn)
+    : m_budget_bytes(budget_bytes), m_open(open_fn) {}
+
+bool Cache::preload(const std::string& name) {
+    if (name.empty()) {
+        return false;
+    }
+    m_mutex.take();
+    const bool ok = find(name) != nullptr || load(name) != nullptr;
+    m_mutex.give();
+    return ok;
+}
+
+bool Cache::draw(const std::string& name, int x, int y) {
+    if (name.empty()) {
+        return false;
+    }
+
+    m_mutex.take();
+    Entry* entry = find(name);
+    if (!entry) {
+        entry = load(name);
+    }
+    if (entry) {
+        entry->last_used = ++m_tick;
+        blit(*entry, x, y);
+        m_mutex.give();
+        return true;
+    }
+    m_mutex.give();
+    return draw_file(m_open, name.c_str(), x, y);
+}
+
+bool Cache::draw_asset(const std::string& name, const std::uint8_t* data, std::size_t size, int x, int y) {
+    if (name.empty() || !data) {
+        return false;
+    }
+
+    m_mutex.take();
+    Entry* entry = find(name);
+    if (!entry) {
+        entry = load_vbi(name, data, size);
+    }
+    if (entry) {
+        entry->last_used = ++m_tick;
+        blit(*entry, x, y);
+        m_mutex.give();
+        return true;
+    }
+    m_mutex.give();
+    return draw_vbi(data, size, x, y);
+}
+
+void Cache::clear() {
+    m_mutex.take();
+    m_entries.clear();
+    m_bytes_used = 0;
+    m_mutex.give();
+}
+
+Cache::Entry* Cache::find(const std::string& name) {
+    for (auto& entry : m_entries) {
+        if (entry.name == name) {
+            entry.last_used = ++m_tick;
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+Cache::Entry* Cache::load(const std::string& name) {
+    FILE* file = m_open ? m_open(name.c_str(), "rb") : nullptr;
+    if (!file) {
+        return nullptr;
+    }
+
+    ImageHeader header{};
+    if (!read_header(file, &header)) {
+        std::fclose(file);
+        return nullptr;
+    }
+
+    Entry* entry = insert(name, header.target_w, header.target_h);
+    if (!entry) {
+        std::fclose(file);
+        return nullptr;
+    }
+    FrameSink sink{entry->pixels.data(), entry->width};
+    ReadStats stats{};
+    const bool ok = decode(file, header, store_row, &sink, &stats);
+    std::fclose(file);
+    log_read_stats(name.c_str(), stats);
+    if (!ok) {
+        m_bytes_used -= entry->pixels.size() * sizeof(std::uint32_t);
+        m_entries.pop_back();
+        return nullptr;
+    }
+    return entry;
+}
+
+Cache::Entry* Cache::load_vbi(const std::string& name, const std::uint8_t* data, std::size_t size) {
+    vbi::Header header{};
+    if (size < vbi::kHeaderSize || !vbi::parse_header(data, &header)) {
+        return nullptr;
+    }
+    Entry* entry = insert(name, header.width, header.height);
+    if (!entry) {
+        return nullptr;
+    }
+    FrameSink sink{entry->pixels.data(), entry->width};
+    if (!decode_vbi(data, size, header, store_row, &sink)) {
+        m_bytes_used -= entry->pixels.size() * sizeof(std::uint32_t);
+        m_entries.pop_back();
+        return nullptr;
+    }
+    return entry;
+}
+
+Cache::Entry* Cache::insert(const std::string& name, int width, int height) {
+    const std::size_t pixel_count = static_cast<std::size_t>(width) * height;
+    const std::size_t bytes = pixel_count * sizeof(std::uint32_t);
+    if (bytes > m_budget_bytes) {
+        return nullptr;
+    }
+    evict_until_fits(bytes);
+    m_entries.push_back(Entry{name, std::vector<std::uint32_t>(pixel_count, 0), width, height, ++m_tick});
+    m_bytes_used += bytes;
+    return &m_entries.back();
+}
+
+void Cache::blit(const Entry& entry, int x, int y) {
+    pros::screen::copy_area(static_cast<std::int16_t>(x),
+                            static_cast<std::int16_t>(y),
+                            static_cast<std::int16_t>(x + entry.width - 1),
+                            static_cast<std::int16_t>(y + entry.height - 1),
+                            const_cast<std::uint32_t*>(entry.pixels.data()),
+                            entry.width);
+}
+
+void Cache::evict_until_fits(std::size_t bytes) {
+    while (!m_entries.empty() && m_bytes_used + bytes > m_budget_bytes) {
+        auto oldest = std::min_element(m_entries.begin(), m_entries.end(),
+                                       [](const Entry& a, const Entry& b) { return a.last_used < b.last_used; });
+        m_bytes_used -= oldest->pixels.size() * sizeof(std::uint32_t);
+        m_entries.erase(oldest);
+    }
+}
+} // namespace image
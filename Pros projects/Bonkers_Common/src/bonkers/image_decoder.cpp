@@ -0,0 +1,486 @@
+#include "bonkers/image_decoder.hpp"
+
+#include "bonkers/area_scaler.hpp"
+
+#include "pros/rtos.hpp"
+#include "pros/screen.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <vector>
+
+namespace image {
+namespace {
+constexpr std::uint32_t kBiRgb = 0;
+constexpr std::uint32_t kBiBitfields = 3;
+
+// Pixel data is pulled from SD in sector-aligned chunks into one shared
+// buffer and rows are converted straight out of it; FatFS handles a few big
+// reads far better than one fread per 1-2 KB row. A row too big for the
+// buffer (over ~10.9k pixels at 24 bpp) is read on its own instead.
+constexpr std::size_t kSectorBytes = 512;
+constexpr std::size_t kChunkBytes = 64 * kSectorBytes;
+
+DrawStats g_draw_stats{};
+std::uint8_t g_chunk[kChunkBytes];
+pros::Mutex g_chunk_mutex;
+
+template <typename T>
+T read_le(const std::uint8_t* bytes) {
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+// Extracts one BI_BITFIELDS channel and widens or narrows it to 8 bits.
+struct Channel {
+    std::uint32_t mask;
+    int shift;
+    int bits;
+
+    explicit Channel(std::uint32_t m) : mask(m), shift(0), bits(0) {
+        if (mask == 0) {
+            return;
+        }
+        while (((mask >> shift) & 1U) == 0) {
+            ++shift;
+        }
+        while (shift + bits < 32 && ((mask >> (shift + bits)) & 1U) != 0) {
+            ++bits;
+        }
+    }
+
+    std::uint32_t to8(std::uint32_t pixel) const {
+        if (bits == 0) {
+            return 0;
+        }
+        const std::uint32_t value = (pixel & mask) >> shift;
+        if (bits >= 8) {
+            return value >> (bits - 8);
+        }
+        return (value * 255U) / ((1U << bits) - 1U);
+    }
+};
+
+// Hands out contiguous runs of bytes from a file (through g_chunk) or from
+// an in-memory blob. A file reader owns g_chunk for its lifetime and, when
+// given `stats`, fills them in as it goes out of scope.
+class ChunkReader {
+    public:
+        ChunkReader(FILE* file, ReadStats* stats) : m_file(file), m_stats_out(stats) {
+            g_chunk_mutex.take();
+            m_start_us = pros::micros();
+        }
+
+        ChunkReader(const std::uint8_t* data, std::size_t size) : m_data(data), m_size(size) {}
+
+        ~ChunkReader() {
+            if (m_file) {
+                g_chunk_mutex.give();
+                if (m_stats_out) {
+                    m_stats.micros = static_cast<std::uint32_t>(pros::micros() - m_start_us);
+                    *m_stats_out = m_stats;
+                }
+            }
+        }
+
+        ChunkReader(const ChunkReader&) = delete;
+        ChunkReader& operator=(const ChunkReader&) = delete;
+
+        bool seek(std::size_t offset) {
+            m_pos = 0;
+            m_len = 0;
+            if (!m_file) {
+                m_pos = offset;
+                return offset <= m_size;
+            }
+            m_file_pos = offset;
+            return std::fseek(m_file, static_cast<long>(offset), SEEK_SET) == 0;
+        }
+
+        // Pointer to the next `len` bytes, valid until the next call; null at
+        // end of data.
+        const std::uint8_t* next(std::size_t len) {
+            if (!m_file) {
+                if (len > m_size - m_pos) {
+                    return nullptr;
+                }
+                const std::uint8_t* out = m_data + m_pos;
+                m_pos += len;
+                return out;
+            }
+            if (len > kChunkBytes) {
+                return read_direct(len);
+            }
+            if (m_len - m_pos < len && !refill(len)) {
+                return nullptr;
+            }
+            const std::uint8_t* out = g_chunk + m_pos;
+            m_pos += len;
+            return out;
+        }
+    private:
+        bool refill(std::size_t len) {
+            const std::size_t tail = m_len - m_pos;
+            std::memmove(g_chunk, g_chunk + m_pos, tail);
+            m_pos = 0;
+            m_len = tail;
+
+            // End each read on a sector boundary so later reads stay aligned.
+            std::size_t want = kChunkBytes - tail;
+            const std::size_t misalign = (m_file_pos + want) % kSectorBytes;
+            if (misalign < want && want - misalign >= len - tail) {
+                want -= misalign;
+            }
+            const std::size_t got = std::fread(g_chunk + tail, 1, want, m_file);
+            count_read(got);
+            m_len += got;
+            return m_len >= len;
+        }
+
+        // Whatever g_chunk still holds, then the rest of the run straight
+        // from the file into m_large.
+        const std::uint8_t* read_direct(std::size_t len) {
+            const std::size_t tail = m_len - m_pos;
+            m_large.resize(len);
+            std::memcpy(m_large.data(), g_chunk + m_pos, tail);
+            m_pos = 0;
+            m_len = 0;
+            const std::size_t got = std::fread(m_large.data() + tail, 1, len - tail, m_file);
+            count_read(got);
+            return got == len - tail ? m_large.data() : nullptr;
+        }
+
+        void count_read(std::size_t got) {
+            ++m_stats.calls;
+            m_stats.bytes += static_cast<std::uint32_t>(got);
+            m_file_pos += got;
+        }
+
+        FILE* m_file = nullptr;
+        const std::uint8_t* m_data = nullptr;
+        std::size_t m_size = 0;
+        std::size_t m_pos = 0;
+        std::size_t m_len = 0;
+        std::size_t m_file_pos = 0;
+        std::vector<std::uint8_t> m_large;
+        ReadStats m_stats{};
+        ReadStats* m_stats_out = nullptr;
+        std::uint64_t m_start_us = 0;
+};
+
+bool decode_vbi_rows(ChunkReader& source, const vbi::Header& header, RowFn on_row, void* ctx) {
+    if (!on_row || !source.seek(vbi::kHeaderSize)) {
+        return false;
+    }
+
+    std::uint32_t row_buf[vbi::kMaxWidth];
+    bool any_row = false;
+    for (int row = 0; row < header.height; ++row) {
+        const std::uint8_t* len_bytes = source.next(2);
+        if (!len_bytes) {
+            break;
+        }
+        const std::size_t len = static_cast<std::size_t>(len_bytes[0] | (len_bytes[1] << 8));
+        const std::uint8_t* encoded = len <= vbi::kMaxRowBytes ? source.next(len) : nullptr;
+        if (!encoded) {
+            break;
+        }
+        if (!vbi::decode_row(encoded, len, header.codec, row_buf, header.width)) {
+            break;
+        }
+        any_row = true;
+        on_row(ctx, row, row_buf, header.width);
+    }
+    return any_row;
+}
+
+struct ScreenSink {
+    int x;
+    int y;
+};
+
+void blit_row(void* ctx, int row, const std::uint32_t* pixels, int width) {
+    const auto* sink = static_cast<const ScreenSink*>(ctx);
+    ++g_draw_stats.rows;
+    const int y_row = sink->y + row;
+    if (y_row < 0 || y_row >= kScreenH) {
+        return;
+    }
+    pros::screen::copy_area(static_cast<std::int16_t>(sink->x),
+                            static_cast<std::int16_t>(y_row),
+                            static_cast<std::int16_t>(sink->x + width - 1),
+                            static_cast<std::int16_t>(y_row),
+                            const_cast<std::uint32_t*>(pixels),
+                            width);
+    ++g_draw_stats.screen_calls;
+}
+
+// Oversized BMPs: area-average every source row instead of sampling, so
+// photos do not alias. Rows are emitted once each target row is complete.
+bool decode_bmp_scaled(ChunkReader& source, const BmpHeader& header, RowFn on_row, void* ctx) {
+    const std::int32_t width = header.width;
+    const std::int32_t abs_height = header.height;
+    const Channel red(header.masks[0]);
+    const Channel green(header.masks[1]);
+    const Channel blue(header.masks[2]);
+
+    AreaScaler scaler(width, abs_height, header.target_w, header.target_h);
+    std::vector<std::uint32_t> unpacked(header.bitfields ? static_cast<std::size_t>(width) : 0);
+    std::vector<std::uint32_t> row_buf(static_cast<std::size_t>(header.target_w));
+
+    bool any_row = false;
+    int current = -1;
+    for (std::int32_t row_idx = 0; row_idx < abs_height; ++row_idx) {
+        const std::uint8_t* row = source.next(header.row_size);
+        if (!row) {
+            break;
+        }
+
+        const std::int32_t draw_y = header.top_down ? row_idx : (abs_height - 1 - row_idx);
+        const int target_row = scaler.target_row(draw_y);
+        if (target_row != current && scaler.pending()) {
+            scaler.flush(row_buf.data());
+            on_row(ctx, current, row_buf.data(), header.target_w);
+            any_row = true;
+        }
+        current = target_row;
+
+        if (header.bitfields) {
+            for (std::int32_t x = 0; x < width; ++x) {
+                const std::uint32_t pixel = read_le<std::uint32_t>(&row[static_cast<std::size_t>(x) * 4]);
+                unpacked[static_cast<std::size_t>(x)] =
+                    (red.to8(pixel) << 16) | (green.to8(pixel) << 8) | blue.to8(pixel);
+            }
+            scaler.add_xrgb(unpacked.data());
+        } else if (header.bpp == 32) {
+            scaler.add_bgr32(row);
+        } else {
+            scaler.add_bgr24(row);
+        }
+    }
+
+    if (scaler.pending()) {
+        scaler.flush(row_buf.data());
+        on_row(ctx, current, row_buf.data(), header.target_w);
+        any_row = true;
+    }
+    return any_row;
+}
+} // namespace
+
+bool read_bmp_header(FILE* file, BmpHeader* out) {
+    if (!file || !out) {
+        return false;
+    }
+
+    // File header, BITMAPINFOHEADER, and the three 32-bit masks that follow
+    // it (or sit inside a V4/V5 header) for BI_BITFIELDS.
+    std::uint8_t header[66];
+    if (std::fread(header, 1, 54, file) != 54) {
+        return false;
+    }
+    if (header[0] != 'B' || header[1] != 'M') {
+        return false;
+    }
+
+    const std::uint32_t data_offset = read_le<std::uint32_t>(&header[10]);
+    const std::int32_t width = read_le<std::int32_t>(&header[18]);
+    const std::int32_t height = read_le<std::int32_t>(&header[22]);
+    const std::uint16_t bpp = read_le<std::uint16_t>(&header[28]);
+    const std::uint32_t compression = read_le<std::uint32_t>(&header[30]);
+
+    const bool compression_ok = (compression == kBiRgb) || (compression == kBiBitfields && bpp == 32);
+    if ((bpp != 24 && bpp != 32) || !compression_ok || width <= 0 || height == 0) {
+        return false;
+    }
+
+    out->masks[0] = 0x00FF0000;
+    out->masks[1] = 0x0000FF00;
+    out->masks[2] = 0x000000FF;
+    out->bitfields = false;
+    if (compression == kBiBitfields) {
+        if (std::fread(&header[54], 1, 12, file) != 12) {
+            return false;
+        }
+        for (int i = 0; i < 3; ++i) {
+            out->masks[i] = read_le<std::uint32_t>(&header[54 + i * 4]);
+        }
+        out->bitfields = out->masks[0] != 0x00FF0000 || out->masks[1] != 0x0000FF00 ||
+                         out->masks[2] != 0x000000FF;
+    }
+
+    out->data_offset = data_offset;
+    out->width = width;
+    out->top_down = height < 0;
+    out->height = out->top_down ? -height : height;
+    out->bpp = bpp;
+    out->row_size = ((static_cast<std::uint32_t>(bpp / 8) * width + 3) / 4) * 4;
+    out->target_w = std::min(static_cast<int>(width), kScreenW);
+    out->target_h = std::min(static_cast<int>(out->height), kScreenH);
+    return true;
+}
+
+bool decode_bmp(FILE* file, const BmpHeader& header, RowFn on_row, void* ctx, ReadStats* stats) {
+    if (!file || !on_row) {
+        return false;
+    }
+
+    const std::uint32_t bytes_per_pixel = header.bpp / 8;
+    const std::int32_t width = header.width;
+    const std::int32_t abs_height = header.height;
+    const int target_w = header.target_w;
+    const int target_h = header.target_h;
+    const bool scale = target_w != width || target_h != abs_height;
+    const Channel red(header.masks[0]);
+    const Channel green(header.masks[1]);
+    const Channel blue(header.masks[2]);
+
+    ChunkReader source(file, stats);
+    if (!source.seek(header.data_offset)) {
+        return false;
+    }
+    if (scale) {
+        return decode_bmp_scaled(source, header, on_row, ctx);
+    }
+
+    std::vector<std::uint32_t> row_buf(static_cast<std::size_t>(target_w));
+
+    bool any_row = false;
+    for (std::int32_t row_idx = 0; row_idx < abs_height; ++row_idx) {
+        const std::uint8_t* row = source.next(header.row_size);
+        if (!row) {
+            break;
+        }
+        any_row = true;
+
+        const int target_row = header.top_down ? row_idx : (abs_height - 1 - row_idx);
+        for (int col = 0; col < target_w; ++col) {
+            const std::size_t idx = static_cast<std::size_t>(col) * bytes_per_pixel;
+            if (header.bitfields) {
+                const std::uint32_t pixel = read_le<std::uint32_t>(&row[idx]);
+                row_buf[static_cast<std::size_t>(col)] =
+                    (red.to8(pixel) << 16) | (green.to8(pixel) << 8) | blue.to8(pixel);
+                continue;
+            }
+            const std::uint8_t b = row[idx];
+            const std::uint8_t g = row[idx + 1];
+            const std::uint8_t r = row[idx + 2];
+            row_buf[static_cast<std::size_t>(col)] = (static_cast<std::uint32_t>(r) << 16) |
+                                                     (static_cast<std::uint32_t>(g) << 8) |
+                                                     static_cast<std::uint32_t>(b);
+        }
+
+        on_row(ctx, target_row, row_buf.data(), target_w);
+    }
+
+    return any_row;
+}
+
+bool read_vbi_header(FILE* file, vbi::Header* out) {
+    if (!file || !out) {
+        return false;
+    }
+    std::uint8_t header[vbi::kHeaderSize];
+    if (std::fread(header, 1, sizeof(header), file) != sizeof(header)) {
+        return false;
+    }
+    return vbi::parse_header(header, out);
+}
+
+bool decode_vbi(FILE* file, const vbi::Header& header, RowFn on_row, void* ctx, ReadStats* stats) {
+    if (!file) {
+        return false;
+    }
+    ChunkReader source(file, stats);
+    return decode_vbi_rows(source, header, on_row, ctx);
+}
+
+bool decode_vbi(const std::uint8_t* data, std::size_t size, const vbi::Header& header, RowFn on_row, void* ctx) {
+    if (!data) {
+        return false;
+    }
+    ChunkReader source(data, size);
+    return decode_vbi_rows(source, header, on_row, ctx);
+}
+
+bool draw_vbi(const std::uint8_t* data, std::size_t size, int x, int y) {
+    g_draw_stats = {};
+    vbi::Header header{};
+    if (!data || size < vbi::kHeaderSize || !vbi::parse_header(data, &header)) {
+        return false;
+    }
+    ScreenSink sink{x, y};
+    return decode_vbi(data, size, header, blit_row, &sink);
+}
+
+bool read_header(FILE* file, ImageHeader* out) {
+    if (!file || !out) {
+        return false;
+    }
+    std::uint8_t magic[4];
+    if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) || std::fseek(file, 0, SEEK_SET) != 0) {
+        return false;
+    }
+
+    if (vbi::has_magic(magic)) {
+        out->format = Format::VBI;
+        if (!read_vbi_header(file, &out->vbi)) {
+            return false;
+        }
+        out->target_w = out->vbi.width;
+        out->target_h = out->vbi.height;
+        return true;
+    }
+
+    out->format = Format::BMP;
+    if (!read_bmp_header(file, &out->bmp)) {
+        return false;
+    }
+    out->target_w = out->bmp.target_w;
+    out->target_h = out->bmp.target_h;
+    return true;
+}
+
+bool decode(FILE* file, const ImageHeader& header, RowFn on_row, void* ctx, ReadStats* stats) {
+    if (header.format == Format::VBI) {
+        return decode_vbi(file, header.vbi, on_row, ctx, stats);
+    }
+    return decode_bmp(file, header.bmp, on_row, ctx, stats);
+}
+
+bool draw_image(FILE* file, int x, int y, ReadStats* stats) {
+    g_draw_stats = {};
+    ImageHeader header{};
+    if (!read_header(file, &header)) {
+        return false;
+    }
+    ScreenSink sink{x, y};
+    return decode(file, header, blit_row, &sink, stats);
+}
+
+bool draw_file(OpenFn open_fn, const char* name, int x, int y) {
+    FILE* file = open_fn ? open_fn(name, "rb") : nullptr;
+    if (!file) {
+        return false;
+    }
+    ReadStats stats{};
+    const bool ok = draw_image(file, x, y, &stats);
+    std::fclose(file);
+    log_read_stats(name, stats);
+    return ok;
+}
+
+const DrawStats& last_draw_stats() {
+    return g_draw_stats;
+}
+
+void log_read_stats(const char* name, const ReadStats& stats) {
+    const std::uint64_t bytes_per_s =
+        stats.micros ? static_cast<std::uint64_t>(stats.bytes) * 1000000u / stats.micros : 0;
+    const std::uint32_t kib_per_s = static_cast<std::uint32_t>(bytes_per_s / 1024u);
+    std::printf("[image] %s: %" PRIu32 " bytes in %" PRIu32 " reads, %" PRIu32 " us (%" PRIu32 " KiB/s)\n",
+                name ? name : "?", stats.bytes, stats.calls, stats.micros, kib_per_s);
+}
+} // namespace image
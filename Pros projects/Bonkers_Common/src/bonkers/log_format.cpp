@@ -0,0 +1,230 @@
+#include "bonkers/log_format.hpp"
+
+#include "bonkers/crc32.hpp"
+
+namespace ctrl_log {
+namespace {
+constexpr std::size_t kMaxHeaderRead = 64;
+
+bool skip_bytes(FILE* in, std::size_t count) {
+    std::uint8_t scratch[64];
+    while (count > 0) {
+        const std::size_t chunk = count < sizeof(scratch) ? count : sizeof(scratch);
+        if (std::fread(scratch, 1, chunk, in) != chunk) {
+            return false;
+        }
+        count -= chunk;
+    }
+    return true;
+}
+
+std::uint32_t frame_crc(const std::uint8_t* frame, std::size_t payload_bytes, std::uint32_t session_id) {
+    std::uint8_t session[4];
+    put_u32(session, session_id);
+    return crc::crc32(frame, kFrameHeaderSize + payload_bytes, crc::crc32(session, sizeof(session)));
+}
+
+// An empty cell for readings not captured or from devices that did not answer.
+void put_cell(FILE* out, bool present, double value, int decimals) {
+    if (present) {
+        std::fprintf(out, ",%.*f", decimals, value);
+    } else {
+        std::fputc(',', out);
+    }
+}
+
+void write_telemetry_csv(FILE* out, std::uint8_t mask, const Telemetry& telemetry) {
+    const bool velocity = (mask & kTelemetryVelocity) != 0;
+    const bool current = (mask & kTelemetryCurrent) != 0;
+    const bool left = (telemetry.valid & kValidLeftDrive) != 0;
+    const bool right = (telemetry.valid & kValidRightDrive) != 0;
+    put_cell(out, velocity && left, telemetry.left_velocity / 10.0, 1);
+    put_cell(out, velocity && right, telemetry.right_velocity / 10.0, 1);
+    put_cell(out, current && left, telemetry.left_current, 0);
+    put_cell(out, current && right, telemetry.right_current, 0);
+    put_cell(out, (mask & kTelemetryHeading) && (telemetry.valid & kValidImu), telemetry.heading / 100.0, 2);
+}
+} // namespace
+
+std::size_t seal_frame(std::uint8_t* frame, std::size_t payload_bytes, std::uint16_t sequence,
+                       std::uint32_t session_id) {
+    put_u16(frame, static_cast<std::uint16_t>(payload_bytes));
+    put_u16(frame + 2, sequence);
+    put_u32(frame + kFrameHeaderSize + payload_bytes, frame_crc(frame, payload_bytes, session_id));
+    return kFrameHeaderSize + payload_bytes + kFrameTrailerSize;
+}
+
+bool LogReader::open(FILE* file) {
+    m_file = file;
+    m_stats = ScanStats{};
+    m_payload_bytes = 0;
+    m_pos = 0;
+    m_frame_sequence = 0;
+    m_time_us = 0;
+    m_expected_sequence = 0;
+    m_done = true;
+
+    std::uint8_t bytes[kMaxHeaderRead];
+    std::size_t header_bytes = 0;
+    if (!file || std::fread(bytes, 1, kHeaderSizeV1, file) != kHeaderSizeV1 ||
+        !parse_header(bytes, kHeaderSizeV1, &m_header, &header_bytes)) {
+        return false;
+    }
+    const std::size_t known = header_bytes < sizeof(bytes) ? header_bytes : sizeof(bytes);
+    if (std::fread(bytes + kHeaderSizeV1, 1, known - kHeaderSizeV1, file) != known - kHeaderSizeV1 ||
+        !skip_bytes(file, header_bytes - known) || !parse_header(bytes, known, &m_header, nullptr)) {
+        return false;
+    }
+    m_stats.good_bytes = static_cast<std::uint32_t>(header_bytes);
+    m_done = false;
+    return true;
+}
+
+bool LogReader::next(Sample* sample, Telemetry* telemetry) {
+    if (m_done) {
+        return false;
+    }
+    const std::uint8_t* record = nullptr;
+    std::uint8_t unframed[kSampleSize];
+    if (m_header.version < 2) {
+        const std::size_t got = std::fread(unframed, 1, kSampleSize, m_file);
+        if (got != kSampleSize) {
+            finish(got == 0 ? LogEnd::UNCLOSED : LogEnd::TORN);
+            return false;
+        }
+        record = unframed;
+        m_stats.good_bytes += kSampleSize;
+    } else {
+        while (m_pos == m_payload_bytes) {
+            if (!next_frame()) {
+                return false;
+            }
+        }
+        record = m_frame + kFrameHeaderSize + m_pos;
+        m_pos += m_header.record_bytes;
+    }
+
+    if (m_header.version < 3) {
+        std::uint16_t dt_ms = 0;
+        parse_sample_v2(record, sample, &dt_ms);
+        m_time_us += dt_ms * 1000u;
+        sample->time_us = m_time_us;
+    } else {
+        parse_sample(record, sample);
+    }
+    if (telemetry) {
+        *telemetry = Telemetry{};
+        if (m_header.telemetry) {
+            parse_telemetry(record + kSampleSize, telemetry);
+        }
+    }
+
+    if (m_stats.samples > 0) {
+        m_stats.dropped += static_cast<std::uint8_t>(sample->sequence - m_expected_sequence);
+    }
+    m_expected_sequence = static_cast<std::uint8_t>(sample->sequence + 1);
+    ++m_stats.samples;
+    return true;
+}
+
+bool LogReader::next_frame() {
+    const std::size_t got = std::fread(m_frame, 1, kFrameHeaderSize, m_file);
+    if (got < kFrameHeaderSize) {
+        finish(got == 0 ? LogEnd::UNCLOSED : LogEnd::TORN);
+        return false;
+    }
+    const std::size_t payload_bytes = get_u16(m_frame);
+    if (payload_bytes > kMaxFramePayload || payload_bytes % m_header.record_bytes != 0 ||
+        get_u16(m_frame + 2) != m_frame_sequence) {
+        finish(LogEnd::CORRUPT);
+        return false;
+    }
+    const std::size_t rest = payload_bytes + kFrameTrailerSize;
+    if (std::fread(m_frame + kFrameHeaderSize, 1, rest, m_file) != rest) {
+        finish(LogEnd::TORN);
+        return false;
+    }
+    if (get_u32(m_frame + kFrameHeaderSize + payload_bytes) != frame_crc(m_frame, payload_bytes, m_header.session_id)) {
+        finish(LogEnd::CORRUPT);
+        return false;
+    }
+
+    ++m_stats.frames;
+    m_stats.good_bytes += static_cast<std::uint32_t>(kFrameHeaderSize + rest);
+    ++m_frame_sequence;
+    if (payload_bytes == 0) {
+        finish(LogEnd::CLOSED);
+        return false;
+    }
+    m_payload_bytes = payload_bytes;
+    m_pos = 0;
+    return true;
+}
+
+void LogReader::finish(LogEnd end) {
+    m_done = true;
+    m_stats.end = end;
+    m_stats.tail_bytes = 0;
+    if (std::fseek(m_file, 0, SEEK_END) == 0) {
+        const long size = std::ftell(m_file);
+        if (size > static_cast<long>(m_stats.good_bytes)) {
+            m_stats.tail_bytes = static_cast<std::uint32_t>(size - static_cast<long>(m_stats.good_bytes));
+        }
+    }
+}
+
+const char* intake_action(std::uint16_t buttons) {
+    if (buttons & kButtonL1) {
+        return "IN";
+    }
+    return (buttons & kButtonL2) ? "OUT" : "";
+}
+
+const char* outtake_action(std::uint16_t buttons) {
+    if (buttons & kButtonR1) {
+        return "OUT";
+    }
+    return (buttons & kButtonR2) ? "IN" : "";
+}
+
+const char* end_name(LogEnd end) {
+    switch (end) {
+        case LogEnd::CLOSED:
+            return "closed cleanly";
+        case LogEnd::UNCLOSED:
+            return "not closed";
+        case LogEnd::TORN:
+            return "torn last frame";
+        case LogEnd::CORRUPT:
+            return "bad frame";
+    }
+    return "?";
+}
+
+bool decode_csv(FILE* in, FILE* out, ScanStats* stats) {
+    LogReader reader;
+    if (!out || !reader.open(in)) {
+        return false;
+    }
+
+    const Header& header = reader.header();
+    std::fprintf(out, "time_s,axis1,axis2,axis3,axis4,left_cmd,right_cmd,intake_action,outtake_action,buttons%s\n",
+                 header.telemetry ? ",left_rpm,right_rpm,left_ma,right_ma,heading_deg" : "");
+    Sample sample;
+    Telemetry telemetry;
+    while (reader.next(&sample, &telemetry)) {
+        std::fprintf(out, "%.6f,%d,%d,%d,%d,%d,%d,%s,%s,%u", sample.time_us / 1e6, sample.axes[0], sample.axes[1],
+                     sample.axes[2], sample.axes[3], sample.axes[header.left_axis], sample.axes[header.right_axis],
+                     intake_action(sample.buttons), outtake_action(sample.buttons),
+                     static_cast<unsigned>(sample.buttons));
+        if (header.telemetry) {
+            write_telemetry_csv(out, header.telemetry, telemetry);
+        }
+        std::fputc('\n', out);
+    }
+    if (stats) {
+        *stats = reader.stats();
+    }
+    return true;
+}
+} // namespace ctrl_log
@@ -0,0 +1,140 @@
+#include "bonkers/log_plan.hpp"
+
+#include "bonkers/log_format.hpp"
+
+namespace log_plan {
+namespace {
+using plan::Step;
+using plan::StepType;
+
+static_assert(ctrl_log::kButtonL1 == 1u << (config::kButtonL1 - config::kButtonL1) &&
+                  ctrl_log::kButtonA == 1u << (config::kButtonA - config::kButtonL1),
+              "log button bits follow the config button order");
+
+using geometry::kPi;
+
+bool held(std::uint16_t mask, const std::uint8_t* buttons, config::Action action) {
+    const int button = buttons[static_cast<int>(action)];
+    return button >= config::kButtonL1 && button <= config::kButtonA && (mask & (1u << (button - config::kButtonL1)));
+}
+
+std::int8_t roller_direction(std::uint16_t mask, const std::uint8_t* buttons) {
+    if (held(mask, buttons, config::Action::INTAKE_IN)) {
+        return 1;
+    }
+    if (held(mask, buttons, config::Action::INTAKE_OUT)) {
+        return -1;
+    }
+    if (held(mask, buttons, config::Action::OUTAKE_OUT)) {
+        return 1;
+    }
+    return held(mask, buttons, config::Action::OUTAKE_IN) ? -1 : 0;
+}
+
+Step roller_step(int direction) {
+    if (direction > 0) {
+        return {StepType::INTAKE_ON, 0, 0, 0};
+    }
+    return {direction < 0 ? StepType::OUTTAKE_ON : StepType::INTAKE_OFF, 0, 0, 0};
+}
+} // namespace
+
+void Converter::push(std::uint32_t time_us) {
+    // Between samples the wheels are taken to hold the last logged speed.
+    const double mm_per_rpm_us = m_options.wheel_diameter_mm * kPi / 60e6;
+    const double since_us = static_cast<double>(time_us - m_last.time_us);
+    const trace::Sample sample = {
+        static_cast<std::int8_t>(m_last.left < -127 ? -127 : (m_last.left > 127 ? 127 : m_last.left)),
+        static_cast<std::int8_t>(m_last.right < -127 ? -127 : (m_last.right > 127 ? 127 : m_last.right)),
+        static_cast<float>(m_left_mm + m_last.left_rpm * mm_per_rpm_us * since_us),
+        static_cast<float>(m_right_mm + m_last.right_rpm * mm_per_rpm_us * since_us),
+        static_cast<float>(m_last.heading)};
+    m_samples.push_back(sample);
+    m_rollers.push_back(roller_direction(m_last.buttons, m_options.buttons));
+}
+
+void Converter::add(const Input& input) {
+    if (!m_started) {
+        m_started = true;
+        m_next_us = input.time_us;
+    } else {
+        const std::uint32_t period_us = m_options.fit.sample_ms * 1000;
+        while (static_cast<std::int32_t>(input.time_us - m_next_us) > 0) {
+            push(m_next_us);
+            m_next_us += period_us;
+        }
+        if (m_last.measured) {
+            const double mm_per_rpm_us = m_options.wheel_diameter_mm * kPi / 60e6;
+            const double elapsed_us = static_cast<double>(input.time_us - m_last.time_us);
+            m_left_mm += m_last.left_rpm * mm_per_rpm_us * elapsed_us;
+            m_right_mm += m_last.right_rpm * mm_per_rpm_us * elapsed_us;
+        }
+    }
+    m_measured = m_measured && input.measured;
+    m_last = input;
+}
+
+bool Converter::finish(plan::PlanBuffer* out) {
+    if (m_started) {
+        push(m_next_us);
+    }
+    trace::FitOptions fit = m_options.fit;
+    fit.closed_loop = fit.closed_loop && m_measured;
+
+    const std::size_t count = m_samples.size();
+    const auto idle = [&](std::size_t i) { return m_rollers[i] == 0 && trace::still(m_samples[i], fit); };
+    std::size_t begin = 0;
+    std::size_t end = count;
+    while (begin < end && idle(begin)) {
+        ++begin;
+    }
+    while (end > begin && idle(end - 1)) {
+        --end;
+    }
+
+    std::int8_t rollers = 0;
+    for (std::size_t first = begin; first < end;) {
+        if (m_rollers[first] != rollers) {
+            rollers = m_rollers[first];
+            if (!out->push_back(roller_step(rollers))) {
+                return false;
+            }
+        }
+        std::size_t next = first + 1;
+        while (next < end && m_rollers[next] == rollers) {
+            ++next;
+        }
+        if (!trace::fit_range(m_samples.data(), count, first, next, fit, out)) {
+            return false;
+        }
+        first = next;
+    }
+    return rollers == 0 || out->push_back(roller_step(0));
+}
+
+bool read_log(FILE* file, const Options& options, plan::PlanBuffer* out, std::size_t* samples) {
+    ctrl_log::LogReader reader;
+    if (!reader.open(file)) {
+        return false;
+    }
+    const ctrl_log::Header& header = reader.header();
+    const bool telemetry = (header.telemetry & ctrl_log::kTelemetryVelocity) &&
+                           (header.telemetry & ctrl_log::kTelemetryHeading);
+    constexpr std::uint8_t kAllValid = ctrl_log::kValidLeftDrive | ctrl_log::kValidRightDrive | ctrl_log::kValidImu;
+
+    out->clear();
+    Converter converter(options);
+    ctrl_log::Sample sample;
+    ctrl_log::Telemetry measured;
+    while (reader.next(&sample, &measured)) {
+        converter.add({sample.time_us, sample.axes[header.left_axis], sample.axes[header.right_axis], sample.buttons,
+                       telemetry && (measured.valid & kAllValid) == kAllValid, measured.left_velocity / 10.0,
+                       measured.right_velocity / 10.0, measured.heading / 100.0});
+    }
+    converter.finish(out);
+    if (samples) {
+        *samples = converter.samples();
+    }
+    return true;
+}
+} // namespace log_plan
@@ -0,0 +1,41 @@
+#include "bonkers/pid.hpp"
+
+#include <cmath>
+
+namespace pid {
+void Controller::reset() {
+    m_integral = 0;
+    m_prev_error = 0;
+    m_started = false;
+}
+
+double Controller::update(double error, std::uint32_t now_ms) {
+    double derivative = 0;
+    if (m_started && now_ms > m_prev_ms) {
+        const double dt = (now_ms - m_prev_ms) / 1000.0;
+        derivative = (error - m_prev_error) / dt;
+        if (std::abs(error) < m_gains.integral_band) {
+            m_integral += error * dt;
+        }
+    }
+    if ((error > 0) != (m_prev_error > 0)) {
+        m_integral = 0;
+    }
+    m_prev_error = error;
+    m_prev_ms = now_ms;
+    m_started = true;
+    return m_gains.kp * error + m_gains.ki * m_integral + m_gains.kd * derivative;
+}
+
+bool Settle::update(double error, std::uint32_t now_ms) {
+    if (std::abs(error) > m_tolerance) {
+        m_inside = false;
+        return false;
+    }
+    if (!m_inside) {
+        m_inside = true;
+        m_entered_ms = now_ms;
+    }
+    return now_ms - m_entered_ms >= m_hold_ms;
+}
+} // namespace pid
@@ -0,0 +1,247 @@
+#include "bonkers/plan.hpp"
+
+#include "bonkers/keyword_table.hpp"
+#include "bonkers/plan_arena.hpp"
+#include "bonkers/text.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace plan {
+namespace {
+constexpr const char* kSlotFiles[kSlotCount] = {
+    "auton_plans_slot1.txt",
+    "auton_plans_slot2.txt",
+    "auton_plans_slot3.txt",
+};
+
+// Same order as StepType; the planner's TYPE button walks this list.
+constexpr const char* kStepNames[] = {
+    "EMPTY",
+    "DRIVE_MS",
+    "TANK_MS",
+    "TURN_HEADING",
+    "WAIT_MS",
+    "INTAKE_ON",
+    "INTAKE_OFF",
+    "OUTTAKE_ON",
+    "OUTTAKE_OFF",
+    "INTAKE_FOR_MS",
+    "OUTAKE_FOR_MS",
+    "PARALLEL",
+    "END_PARALLEL",
+    "DRIVE_DIST",
+    "TURN_RELATIVE",
+    "ARC",
+};
+static_assert(sizeof(kStepNames) / sizeof(kStepNames[0]) == kStepTypeCount, "one name per StepType");
+
+constexpr text::KeywordTable<32> kStepTable(kStepNames);
+static_assert(kStepTable.perfect(), "step names need a collision-free seed");
+
+enum class Section { NONE, GPS, BASIC };
+
+// Same order as Section.
+constexpr const char* kSectionNames[] = {"", "GPS", "BASIC"};
+constexpr text::KeywordTable<4> kSectionTable(kSectionNames);
+static_assert(kSectionTable.perfect(), "section names need a collision-free seed");
+
+// Lines are parsed in place from this buffer; a longer line is cut.
+constexpr std::size_t kLineBufferSize = 2048;
+
+// Where a record sits in the file, for error reports.
+struct Source {
+    const char* name;
+    int line;
+    int column;
+};
+
+void report(const Source& where, int column, const char* message) {
+    text::report("plan", where.name, where.line, column, message);
+}
+
+// Plans is std::vector<Step> or PlanBuffer.
+template <typename Plans>
+void parse_record(char* record, const Source& where, Section* section, Plans* gps, Plans* basic) {
+    text::Cursor cursor(record, where.column);
+    if (cursor.at_end() || *cursor.rest() == '#') {
+        return;
+    }
+    if (cursor.consume('[')) {
+        const int column = cursor.column();
+        std::size_t length = 0;
+        bool closed = false;
+        const char* name = cursor.token(']', &length, &closed);
+        const int index = closed ? kSectionTable.find(name, length, 0) : 0;
+        *section = static_cast<Section>(index);
+        if (index == 0) {
+            report(where, column, "unknown section; steps up to the next [GPS] or [BASIC] are skipped");
+        }
+        return;
+    }
+
+    const int type_column = cursor.column();
+    std::size_t length = 0;
+    bool more = false;
+    const char* name = cursor.token(',', &length, &more);
+    const int type = kStepTable.find(name, length, -1);
+
+    // TYPE,value1,value2[,value3]
+    int values[3] = {0, 0, 0};
+    int count = 0;
+    while (more && count < 3 && cursor.integer(&values[count])) {
+        ++count;
+        more = cursor.consume(',');
+    }
+    if (count < 2) {
+        report(where, cursor.column(), "expected TYPE,value1,value2[,value3]; step skipped");
+        return;
+    }
+    if (!cursor.at_end()) {
+        report(where, cursor.column(), "extra text after the step ignored");
+    }
+    if (type < 0) {
+        report(where, type_column, "unknown step type; loaded as EMPTY");
+    }
+
+    const Step step{type < 0 ? StepType::EMPTY : static_cast<StepType>(type), values[0], values[1], values[2]};
+    if (*section == Section::GPS) {
+        gps->push_back(step);
+    } else if (*section == Section::BASIC) {
+        basic->push_back(step);
+    } else {
+        report(where, type_column, "step outside a [GPS] or [BASIC] section skipped");
+    }
+}
+
+void write_section(FILE* file, const char* header, const Step* steps, std::size_t count) {
+    std::fprintf(file, "%s\n", header);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Step& step = steps[i];
+        std::fprintf(file, "%s,%d,%d,%d\n", step_type_name(step.type), step.value1, step.value2, step.value3);
+    }
+}
+
+template <typename Plans>
+bool read_plans_into(FILE* file, Plans* gps, Plans* basic, const char* name) {
+    gps->clear();
+    basic->clear();
+    if (!file) {
+        return false;
+    }
+
+    Section section = Section::NONE;
+    char buffer[kLineBufferSize];
+    text::LineReader reader(file, buffer, sizeof(buffer));
+    while (char* line = reader.next()) {
+        if (reader.cut()) {
+            report({name, reader.line(), 0}, static_cast<int>(kLineBufferSize) - 1,
+                   "line fills the read buffer; anything past it is ignored");
+        }
+        // Planner builds before this library wrote a literal backslash-n
+        // instead of a newline, leaving the whole file on one line; treat
+        // it as a separator so those slot files still load.
+        char* record = line;
+        while (char* escape = std::strstr(record, "\\n")) {
+            *escape = '\0';
+            parse_record(record, {name, reader.line(), static_cast<int>(record - line) + 1}, &section, gps, basic);
+            record = escape + 2;
+        }
+        parse_record(record, {name, reader.line(), static_cast<int>(record - line) + 1}, &section, gps, basic);
+    }
+    return !(gps->empty() && basic->empty());
+}
+} // namespace
+
+const char* step_type_name(StepType type) {
+    const int index = static_cast<int>(type);
+    return index >= 0 && index < kStepTypeCount ? kStepNames[index] : "UNKNOWN";
+}
+
+bool step_in_range(const Step& step) {
+    const auto power = [](int value) { return value >= -127 && value <= 127; };
+    const auto duration = [](int value) { return value >= 0 && value <= kMaxStepMs; };
+    const auto max_power = [](int value) { return value >= 0 && value <= 127; };
+    const auto turn = [](int value) { return value >= -360 && value <= 360; };
+    if (step.type != StepType::TANK_MS && !duration(step.value3)) {
+        return false;
+    }
+    switch (step.type) {
+        case StepType::DRIVE_MS:
+        case StepType::INTAKE_FOR_MS:
+        case StepType::OUTAKE_FOR_MS:
+            return power(step.value1) && duration(step.value2);
+        case StepType::TANK_MS:
+            return power(step.value1) && power(step.value2) && duration(step.value3);
+        case StepType::TURN_HEADING:
+            return step.value1 >= 0 && step.value1 < 360;
+        case StepType::WAIT_MS:
+            return duration(step.value1);
+        case StepType::DRIVE_DIST:
+            return std::abs(step.value1) <= kMaxDistanceMm && max_power(step.value2);
+        case StepType::TURN_RELATIVE:
+            return turn(step.value1) && max_power(step.value2);
+        case StepType::ARC:
+            return turn(step.value1) && step.value2 >= 0 && step.value2 <= kMaxDistanceMm;
+        default:
+            return true;
+    }
+}
+
+StepType parse_step_type(const char* token) {
+    return static_cast<StepType>(kStepTable.find(token, std::strlen(token), 0));
+}
+
+StepType next_step_type(StepType type) {
+    return static_cast<StepType>((static_cast<int>(type) + 1) % kStepTypeCount);
+}
+
+StepType prev_step_type(StepType type) {
+    return static_cast<StepType>((static_cast<int>(type) + kStepTypeCount - 1) % kStepTypeCount);
+}
+
+const char* slot_filename(int slot) {
+    return kSlotFiles[slot >= 0 && slot < kSlotCount ? slot : 0];
+}
+
+bool read_plans(FILE* file, std::vector<Step>* gps, std::vector<Step>* basic, const char* name) {
+    return read_plans_into(file, gps, basic, name);
+}
+
+bool read_plans(FILE* file, PlanBuffer* gps, PlanBuffer* basic, const char* name) {
+    return read_plans_into(file, gps, basic, name);
+}
+
+bool PlanBuffer::assign(const Step* steps, std::size_t count) {
+    clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        push_back(steps[i]);
+    }
+    return m_dropped == 0;
+}
+
+bool write_plans(FILE* file, const Step* gps, std::size_t gps_count, const Step* basic, std::size_t basic_count) {
+    if (!file) {
+        return false;
+    }
+    write_section(file, "[GPS]", gps, gps_count);
+    write_section(file, "[BASIC]", basic, basic_count);
+    return std::ferror(file) == 0;
+}
+
+int read_slot(FILE* file) {
+    int slot = 0;
+    if (!file || std::fscanf(file, "%d", &slot) != 1 || slot < 1 || slot > kSlotCount) {
+        return 0;
+    }
+    return slot - 1;
+}
+
+bool write_slot(FILE* file, int slot) {
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "%d\n", slot + 1);
+    return std::ferror(file) == 0;
+}
+} // namespace plan
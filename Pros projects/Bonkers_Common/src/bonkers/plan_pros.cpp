@@ -0,0 +1,24 @@
+#include "bonkers/plan_pros.hpp"
+
+#include "pros/rtos.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace plan {
+std::uint32_t pros_millis(void*) {
+    return pros::millis();
+}
+
+std::uint64_t pros_micros(void*) {
+    return pros::micros();
+}
+
+void pros_delay_until(void*, std::uint32_t* prev_ms, std::uint32_t delta_ms) {
+    pros::Task::delay_until(prev_ms, delta_ms);
+}
+
+void pros_overrun(void*, std::size_t step, std::uint32_t late_us) {
+    std::printf("[auton] step %zu ended %" PRIu32 " us past its deadline\n", step + 1, late_us);
+}
+} // namespace plan
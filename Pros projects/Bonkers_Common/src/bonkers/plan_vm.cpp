@@ -0,0 +1,580 @@
+#include "bonkers/plan_vm.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace plan {
+namespace {
+struct Context {
+    const Robot& robot;
+    std::uint32_t end_ms;
+    // The plan clock: the last wake-up the VM scheduled, in millis(). Every
+    // instruction starts from it, so a timed one ends exactly its length
+    // after the previous one ended on paper, however late the task actually
+    // woke along the way.
+    std::uint32_t wake_ms;
+    // millis() and micros() read together when the run started. The two
+    // clocks need not share an epoch, so lateness is measured from here.
+    std::uint32_t start_ms;
+    std::uint64_t start_us;
+
+    bool time_up() const {
+        if (robot.aborted && robot.aborted(robot.ctx)) {
+            return true;
+        }
+        return end_ms != 0 && robot.millis(robot.ctx) >= end_ms;
+    }
+
+    void sleep_until(std::uint32_t deadline_ms) {
+        if (deadline_ms > wake_ms) {
+            robot.delay_until(robot.ctx, &wake_ms, deadline_ms - wake_ms);
+        }
+    }
+
+    // Waits until `deadline_ms` in kWaitSliceMs slices. False if the abort
+    // flag or the budget cut it short.
+    bool wait_until(std::uint32_t deadline_ms) {
+        while (wake_ms < deadline_ms) {
+            if (time_up()) {
+                return false;
+            }
+            sleep_until(std::min(wake_ms + kWaitSliceMs, deadline_ms));
+        }
+        return true;
+    }
+
+    // Next control-loop period. A loop that fell a whole period behind
+    // restarts its schedule from now instead of running the missed updates
+    // back to back.
+    void tick(std::uint32_t period_ms) {
+        const std::uint32_t now = robot.millis(robot.ctx);
+        if (now >= wake_ms + period_ms) {
+            wake_ms = now;
+        }
+        sleep_until(wake_ms + period_ms);
+    }
+
+    // Reports a timed instruction that ended more than kOverrunReportUs past
+    // its deadline.
+    void check_overrun(const Instr& instr, std::uint32_t deadline_ms) const {
+        if (!robot.micros || !robot.overrun) {
+            return;
+        }
+        const std::uint64_t due_us = start_us + static_cast<std::uint64_t>(deadline_ms - start_ms) * 1000;
+        const std::uint64_t now_us = robot.micros(robot.ctx);
+        if (now_us > due_us + kOverrunReportUs) {
+            robot.overrun(robot.ctx, instr.step, static_cast<std::uint32_t>(now_us - due_us));
+        }
+    }
+};
+
+std::int8_t power(int value) {
+    return static_cast<std::int8_t>(std::max(-127, std::min(127, value)));
+}
+
+std::uint32_t duration(int ms) {
+    return ms > 0 ? static_cast<std::uint32_t>(ms) : 0;
+}
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Wraps a heading difference into [-180, 180] once, like the old executor.
+double wrap_error(double error) {
+    if (error > 180) error -= 360;
+    if (error < -180) error += 360;
+    return error;
+}
+
+// One turn controller update; false once the heading is within tolerance.
+bool turn_step(const Instr& instr, Context& vm) {
+    const double error = wrap_error(instr.heading - vm.robot.heading(vm.robot.ctx));
+    if (std::abs(error) < kTurnToleranceDeg) {
+        return false;
+    }
+    int speed = static_cast<int>(error * kTurnKp);
+    speed = std::max<int>(-instr.right, std::min<int>(instr.right, speed));
+    vm.robot.drive(vm.robot.ctx, speed, -speed);
+    return true;
+}
+
+bool closed_loop(Op op) {
+    return op == Op::DRIVE_DIST || op == Op::TURN_REL || op == Op::ARC;
+}
+
+int clamp_power(double value, int max_power) {
+    return static_cast<int>(std::lround(std::max<double>(-max_power, std::min<double>(max_power, value))));
+}
+
+// Closed-loop state for DRIVE_DIST, TURN_REL and ARC.
+struct Motion {
+    pid::Controller controller{kDriveGains};
+    pid::Settle settle{kDriveToleranceMm, kSettleMs};
+    double start_left = 0;
+    double start_right = 0;
+    double last_heading = 0;
+    double turned = 0; // since begin(), unwrapped, clockwise positive
+    std::uint32_t start_ms = 0;
+
+    void begin(const Instr& instr, Context& vm, std::uint32_t now) {
+        const bool drive = instr.op != Op::TURN_REL;
+        controller = pid::Controller(instr.op == Op::TURN_REL ? kTurnGains : kDriveGains);
+        settle = pid::Settle(drive ? kDriveToleranceMm : kTurnSettleDeg, kSettleMs);
+        start_left = vm.robot.left_mm(vm.robot.ctx);
+        start_right = vm.robot.right_mm(vm.robot.ctx);
+        last_heading = vm.robot.heading(vm.robot.ctx);
+        turned = 0;
+        start_ms = now;
+    }
+
+    // One control update. False, leaving the drive as it was, once the
+    // error has settled or the step has used up its timeout.
+    bool update(const Instr& instr, Context& vm, std::uint32_t now) {
+        const double heading = vm.robot.heading(vm.robot.ctx);
+        turned += wrap_error(heading - last_heading);
+        last_heading = heading;
+
+        const int max_power = instr.right;
+        const double travelled = (vm.robot.left_mm(vm.robot.ctx) - start_left +
+                                  vm.robot.right_mm(vm.robot.ctx) - start_right) / 2;
+        double error = 0;
+        double left = 0;
+        double right = 0;
+        if (instr.op == Op::DRIVE_DIST) {
+            // Straight: hold the start heading.
+            error = instr.distance - travelled;
+            const double power = clamp_power(controller.update(error, now), max_power);
+            const double steer = kHeadingHoldKp * -turned;
+            left = power + steer;
+            right = power - steer;
+        } else if (instr.op == Op::TURN_REL) {
+            // In place: hold the center where it started.
+            error = instr.heading - turned;
+            const double power = clamp_power(controller.update(error, now), max_power);
+            const double hold = kDriveGains.kp * -travelled;
+            left = power + hold;
+            right = -power + hold;
+        } else {
+            // Along the arc: the controller drives the center's remaining
+            // arc length, the outer and inner wheels keep the ratio for the
+            // radius, and the heading is steered to match the distance
+            // covered so far.
+            const double direction = instr.heading >= 0 ? 1.0 : -1.0;
+            const double radians = std::abs(instr.heading) * kPi / 180.0;
+            error = radians * instr.distance - travelled;
+            const double outer = clamp_power(controller.update(error, now), max_power);
+            const double half_track = vm.robot.track_width_mm / 2;
+            const double inner = outer * (instr.distance - half_track) / (instr.distance + half_track);
+            const double expected_turn = direction * travelled / instr.distance * 180.0 / kPi;
+            const double steer = kHeadingHoldKp * (expected_turn - turned);
+            left = (direction > 0 ? outer : inner) + steer;
+            right = (direction > 0 ? inner : outer) - steer;
+        }
+
+        if (settle.update(error, now) || now - start_ms >= instr.ms) {
+            return false;
+        }
+        vm.robot.drive(vm.robot.ctx, clamp_power(left, 127), clamp_power(right, 127));
+        return true;
+    }
+};
+
+// Handlers return the next instruction, or nullptr when the budget ran out
+// mid-instruction.
+const Instr* op_drive(const Instr* pc, const Instr*, Context& vm) {
+    const std::uint32_t deadline = vm.wake_ms + pc->ms;
+    vm.robot.drive(vm.robot.ctx, pc->left, pc->right);
+    if (!vm.wait_until(deadline)) {
+        vm.robot.stop_all(vm.robot.ctx);
+        return nullptr;
+    }
+    vm.robot.brake_drive(vm.robot.ctx);
+    vm.check_overrun(*pc, deadline);
+    return pc + 1;
+}
+
+const Instr* op_turn(const Instr* pc, const Instr*, Context& vm) {
+    bool finished = true;
+    while (true) {
+        if (vm.time_up()) {
+            finished = false;
+            break;
+        }
+        if (!turn_step(*pc, vm)) {
+            break;
+        }
+        vm.tick(kTurnPollMs);
+    }
+    vm.robot.brake_drive(vm.robot.ctx);
+    return finished ? pc + 1 : nullptr;
+}
+
+const Instr* op_wait(const Instr* pc, const Instr*, Context& vm) {
+    const std::uint32_t deadline = vm.wake_ms + pc->ms;
+    if (!vm.wait_until(deadline)) {
+        vm.robot.stop_all(vm.robot.ctx);
+        return nullptr;
+    }
+    vm.check_overrun(*pc, deadline);
+    return pc + 1;
+}
+
+const Instr* op_rollers(const Instr* pc, const Instr*, Context& vm) {
+    vm.robot.rollers(vm.robot.ctx, pc->left);
+    return pc + 1;
+}
+
+const Instr* run_motor(const Instr* pc, void (*motor)(void* ctx, int power), Context& vm) {
+    const std::uint32_t deadline = vm.wake_ms + pc->ms;
+    motor(vm.robot.ctx, pc->left);
+    if (!vm.wait_until(deadline)) {
+        vm.robot.stop_all(vm.robot.ctx);
+        return nullptr;
+    }
+    motor(vm.robot.ctx, 0);
+    vm.check_overrun(*pc, deadline);
+    return pc + 1;
+}
+
+const Instr* op_motion(const Instr* pc, const Instr*, Context& vm) {
+    Motion motion;
+    motion.begin(*pc, vm, vm.robot.millis(vm.robot.ctx));
+    while (true) {
+        if (vm.time_up()) {
+            vm.robot.stop_all(vm.robot.ctx);
+            return nullptr;
+        }
+        if (!motion.update(*pc, vm, vm.robot.millis(vm.robot.ctx))) {
+            break;
+        }
+        vm.tick(kMotionTickMs);
+    }
+    vm.robot.brake_drive(vm.robot.ctx);
+    return pc + 1;
+}
+
+const Instr* op_intake(const Instr* pc, const Instr*, Context& vm) {
+    return run_motor(pc, vm.robot.intake, vm);
+}
+
+const Instr* op_outake(const Instr* pc, const Instr*, Context& vm) {
+    return run_motor(pc, vm.robot.outake, vm);
+}
+
+// --- GROUP timeline. ---
+// A child owns its motor from its start; when it ends it only brakes that
+// motor if no later child has taken it over. ROLLERS takes over both roller
+// motors but is a latch: it never brakes them itself.
+enum Channel { kDriveChannel, kIntakeChannel, kOutakeChannel, kChannelCount, kNoChannel = kChannelCount };
+
+Channel channel_of(Op op) {
+    switch (op) {
+        case Op::DRIVE:
+        case Op::TURN:
+        case Op::DRIVE_DIST:
+        case Op::TURN_REL:
+        case Op::ARC:
+            return kDriveChannel;
+        case Op::INTAKE:
+            return kIntakeChannel;
+        case Op::OUTAKE:
+            return kOutakeChannel;
+        default:
+            return kNoChannel;
+    }
+}
+
+struct Lane {
+    const Instr* instr = nullptr;
+    std::uint32_t next_ms = 0; // start, end or next control update, from the group start
+    bool started = false;
+    bool done = false;
+    Motion motion;
+};
+
+// TURN and the closed-loop ops run until they settle, not for a set time.
+bool polled(Op op) {
+    return op == Op::TURN || closed_loop(op);
+}
+
+void start_lane(const Instr& instr, Context& vm) {
+    switch (instr.op) {
+        case Op::DRIVE:
+            vm.robot.drive(vm.robot.ctx, instr.left, instr.right);
+            break;
+        case Op::ROLLERS:
+            vm.robot.rollers(vm.robot.ctx, instr.left);
+            break;
+        case Op::INTAKE:
+            vm.robot.intake(vm.robot.ctx, instr.left);
+            break;
+        case Op::OUTAKE:
+            vm.robot.outake(vm.robot.ctx, instr.left);
+            break;
+        default:
+            break;
+    }
+}
+
+void finish_lane(const Instr& instr, int lane, const int* owners, Context& vm) {
+    const Channel channel = channel_of(instr.op);
+    if (channel == kNoChannel || owners[channel] != lane) {
+        return;
+    }
+    if (channel == kDriveChannel) {
+        vm.robot.brake_drive(vm.robot.ctx);
+    } else if (channel == kIntakeChannel) {
+        vm.robot.intake(vm.robot.ctx, 0);
+    } else {
+        vm.robot.outake(vm.robot.ctx, 0);
+    }
+}
+
+// Starts, updates and ends every lane due at `now`. Returns false once all
+// lanes are done; otherwise lowers `wake` to the next time one is due.
+bool advance_lanes(Lane* lanes, int count, std::uint32_t now, int* owners, std::uint32_t* wake,
+                   Context& vm) {
+    bool busy = false;
+    for (int i = 0; i < count; ++i) {
+        Lane& lane = lanes[i];
+        const Instr& instr = *lane.instr;
+        if (lane.done) {
+            continue;
+        }
+        if (!lane.started) {
+            if (now < lane.next_ms) {
+                *wake = std::min(*wake, lane.next_ms);
+                busy = true;
+                continue;
+            }
+            lane.started = true;
+            const Channel channel = channel_of(instr.op);
+            if (channel != kNoChannel) {
+                owners[channel] = i;
+            } else if (instr.op == Op::ROLLERS) {
+                owners[kIntakeChannel] = i;
+                owners[kOutakeChannel] = i;
+            }
+            start_lane(instr, vm);
+            if (closed_loop(instr.op)) {
+                lane.motion.begin(instr, vm, now);
+            }
+            lane.next_ms = polled(instr.op) ? now : instr.at_ms + instr.ms;
+        }
+        if (polled(instr.op)) {
+            if (now >= lane.next_ms) {
+                if (owners[kDriveChannel] != i) {
+                    lane.done = true; // a later drive step took the wheels
+                } else if (instr.op == Op::TURN ? turn_step(instr, vm) : lane.motion.update(instr, vm, now)) {
+                    lane.next_ms = now + (instr.op == Op::TURN ? kTurnPollMs : kMotionTickMs);
+                } else {
+                    lane.done = true;
+                }
+            }
+        } else if (instr.op == Op::ROLLERS || now >= lane.next_ms) {
+            lane.done = true;
+        }
+        if (lane.done) {
+            finish_lane(instr, i, owners, vm);
+        } else {
+            *wake = std::min(*wake, lane.next_ms);
+            busy = true;
+        }
+    }
+    return busy;
+}
+
+const Instr* op_group(const Instr* pc, const Instr* end, Context& vm) {
+    const std::size_t available = static_cast<std::size_t>(end - pc - 1);
+    const int count = static_cast<int>(std::min({static_cast<std::size_t>(pc->ms), available, kMaxGroupSize}));
+    Lane lanes[kMaxGroupSize];
+    for (int i = 0; i < count; ++i) {
+        lanes[i].instr = pc + 1 + i;
+        lanes[i].next_ms = pc[1 + i].at_ms;
+    }
+    int owners[kChannelCount] = {-1, -1, -1};
+
+    // Offsets count from when the group starts on the plan clock.
+    const std::uint32_t start_ms = vm.wake_ms;
+    while (true) {
+        if (vm.time_up()) {
+            vm.robot.stop_all(vm.robot.ctx);
+            return nullptr;
+        }
+        const std::uint32_t now = vm.robot.millis(vm.robot.ctx) - start_ms;
+        std::uint32_t wake = now + kWaitSliceMs;
+        if (!advance_lanes(lanes, count, now, owners, &wake, vm)) {
+            return pc + 1 + count;
+        }
+        vm.sleep_until(start_ms + std::max(wake, now + 1));
+    }
+}
+
+using Handler = const Instr* (*)(const Instr* pc, const Instr* end, Context& vm);
+
+// Indexed by Op.
+constexpr Handler kHandlers[kOpCount] = {op_drive,  op_turn,  op_wait,   op_rollers, op_intake,
+                                         op_outake, op_group, op_motion, op_motion,  op_motion};
+
+// Expected run time of a closed-loop instruction, at the estimate speeds
+// scaled by its power limit.
+double motion_estimate_ms(const Instr& instr) {
+    const double power = std::max<int>(instr.right, 1);
+    double seconds = 0;
+    if (instr.op == Op::TURN_REL) {
+        seconds = std::abs(instr.heading) / (kTurnEstimateDegPerSec * power / kTurnMaxPower);
+    } else {
+        const double mm = instr.op == Op::ARC ? std::abs(instr.heading) * kPi / 180.0 * instr.distance
+                                              : std::abs(instr.distance);
+        seconds = mm / (kDriveEstimateMmPerSec * power / 127.0);
+    }
+    return seconds * 1000.0 + kSettleMs;
+}
+
+// Closed-loop steps give up after twice their estimate, plus this.
+constexpr std::uint32_t kMotionTimeoutPadMs = 500;
+
+Instr closed_loop_instr(Op op, int max_power, int degrees, int distance) {
+    Instr instr{op,
+                0,
+                power(max_power),
+                static_cast<std::int16_t>(std::max(-360, std::min(360, degrees))),
+                std::max(-kMaxDistanceMm, std::min(kMaxDistanceMm, distance)),
+                0,
+                0};
+    instr.ms = static_cast<std::uint32_t>(2 * motion_estimate_ms(instr)) + kMotionTimeoutPadMs;
+    return instr;
+}
+
+Instr compile_step(const Step& step) {
+    switch (step.type) {
+        case StepType::DRIVE_MS:
+            return {Op::DRIVE, power(step.value1), power(step.value1), 0, 0, duration(step.value2), 0};
+        case StepType::TANK_MS:
+            return {Op::DRIVE, power(step.value1), power(step.value2), 0, 0, duration(step.value3), 0};
+        case StepType::TURN_HEADING:
+            return {Op::TURN, 0, kTurnMaxPower,
+                    static_cast<std::int16_t>(std::max(-32768, std::min(32767, step.value1))), 0, 0, 0};
+        case StepType::WAIT_MS:
+            return {Op::WAIT, 0, 0, 0, 0, duration(step.value1), 0};
+        case StepType::INTAKE_ON:
+            return {Op::ROLLERS, 127, 0, 0, 0, 0, 0};
+        case StepType::OUTTAKE_ON:
+            return {Op::ROLLERS, -127, 0, 0, 0, 0, 0};
+        case StepType::INTAKE_FOR_MS:
+            return {Op::INTAKE, power(step.value1), 0, 0, 0, duration(step.value2), 0};
+        case StepType::OUTAKE_FOR_MS:
+            return {Op::OUTAKE, power(step.value1), 0, 0, 0, duration(step.value2), 0};
+        case StepType::DRIVE_DIST:
+            return closed_loop_instr(Op::DRIVE_DIST, step.value2 > 0 ? step.value2 : kDriveMaxPower, 0, step.value1);
+        case StepType::TURN_RELATIVE:
+            return closed_loop_instr(Op::TURN_REL, step.value2 > 0 ? step.value2 : kTurnMaxPower, step.value1, 0);
+        case StepType::ARC:
+            // A zero radius is a turn in place.
+            return closed_loop_instr(step.value2 > 0 ? Op::ARC : Op::TURN_REL, kArcMaxPower, step.value1,
+                                     step.value2);
+        default:
+            return {Op::ROLLERS, 0, 0, 0, 0, 0, 0};
+    }
+}
+} // namespace
+
+void compile(const Step* steps, std::size_t count, std::vector<Instr>* out) {
+    out->clear();
+    out->reserve(count);
+    // Index of the open GROUP instruction, if any.
+    std::size_t group = 0;
+    bool in_group = false;
+    const auto step_index = [](std::size_t i) {
+        return static_cast<std::uint16_t>(std::min<std::size_t>(i, UINT16_MAX));
+    };
+    // A GROUP carries the index of its PARALLEL step, or of the step after
+    // the previous group filled up.
+    const auto open_group = [&](std::size_t i) {
+        out->push_back({Op::GROUP, 0, 0, 0, 0, 0, 0, step_index(i)});
+        group = out->size() - 1;
+        in_group = true;
+    };
+    const auto close_group = [&]() {
+        if (in_group && (*out)[group].ms == 0) {
+            out->pop_back();
+        }
+        in_group = false;
+    };
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const Step& step = steps[i];
+        if (step.type == StepType::EMPTY) {
+            continue;
+        }
+        if (step.type == StepType::PARALLEL || step.type == StepType::END_PARALLEL) {
+            close_group();
+            if (step.type == StepType::PARALLEL) {
+                open_group(i);
+            }
+            continue;
+        }
+        Instr instr = compile_step(step);
+        instr.step = step_index(i);
+        if (!in_group) {
+            out->push_back(instr);
+            continue;
+        }
+        instr.at_ms = step.type == StepType::TANK_MS ? 0 : duration(step.value3);
+        out->push_back(instr);
+        if (++(*out)[group].ms == kMaxGroupSize) {
+            open_group(i + 1);
+        }
+    }
+    close_group();
+}
+
+bool run(const std::vector<Instr>& code, const Robot& robot, std::uint32_t end_ms) {
+    const std::uint64_t start_us = robot.micros ? robot.micros(robot.ctx) : 0;
+    const std::uint32_t start_ms = robot.millis(robot.ctx);
+    Context vm{robot, end_ms, start_ms, start_ms, start_us};
+    const Instr* pc = code.data();
+    const Instr* end = pc + code.size();
+    while (pc != end) {
+        if (vm.time_up()) {
+            return false;
+        }
+        pc = kHandlers[static_cast<int>(pc->op)](pc, end, vm);
+        if (!pc) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::uint32_t estimate_ms(const std::vector<Instr>& code, double start_heading) {
+    double heading = start_heading;
+    const auto instr_ms = [&heading](const Instr& instr) {
+        if (closed_loop(instr.op)) {
+            heading += instr.heading;
+            return motion_estimate_ms(instr);
+        }
+        if (instr.op != Op::TURN) {
+            return static_cast<double>(instr.ms);
+        }
+        const double error = wrap_error(std::fmod(instr.heading - heading, 360.0));
+        heading = instr.heading;
+        return std::abs(error) * 1000.0 / kTurnEstimateDegPerSec;
+    };
+
+    double total = 0;
+    for (std::size_t i = 0; i < code.size(); ++i) {
+        if (code[i].op != Op::GROUP) {
+            total += instr_ms(code[i]);
+            continue;
+        }
+        const std::size_t count = std::min<std::size_t>(code[i].ms, code.size() - i - 1);
+        double longest = 0;
+        for (std::size_t j = i + 1; j <= i + count; ++j) {
+            longest = std::max(longest, code[j].at_ms + instr_ms(code[j]));
+        }
+        total += longest;
+        i += count;
+    }
+    return static_cast<std::uint32_t>(total + 0.5);
+}
+} // namespace plan
@@ -0,0 +1,180 @@
+#include "bonkers/sd_path.hpp"
+
+#include "bonkers/text.hpp"
+
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+namespace sd {
+namespace {
+// Tried in order. "/" only applies to names spelled "usd/..."; the empty
+// prefix covers names that are already full paths.
+constexpr const char* kPrefixes[] = {
+    "",
+    "/",
+    "/usd/",
+    "usd/",
+    "/usd/Images/",
+    "/usd/images/",
+    "usd/Images/",
+    "usd/images/",
+};
+constexpr int kPrefixCount = static_cast<int>(sizeof(kPrefixes) / sizeof(kPrefixes[0]));
+constexpr int kMissing = -1;
+
+enum class Mount { UNKNOWN, ABSENT, PRESENT };
+
+struct Resolved {
+    std::string name;
+    int prefix;
+};
+
+pros::Mutex g_mutex;
+std::vector<Resolved> g_resolved;
+Mount g_mount = Mount::UNKNOWN;
+Stats g_stats{};
+
+bool applies(int prefix, const char* name) {
+    return prefix != 1 || text::starts_with(name, "usd/");
+}
+
+FILE* try_open(int prefix, const char* name, const char* mode) {
+    char path[128];
+    std::snprintf(path, sizeof(path), "%s%s", kPrefixes[prefix], name);
+    ++g_stats.fopen_calls;
+    return std::fopen(path, mode);
+}
+
+Resolved* find(const char* name) {
+    for (auto& entry : g_resolved) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void remember(const char* name, int prefix) {
+    Resolved* entry = find(name);
+    if (entry) {
+        entry->prefix = prefix;
+    } else {
+        g_resolved.push_back(Resolved{name, prefix});
+    }
+}
+
+bool mounted_locked() {
+    if (g_mount == Mount::UNKNOWN) {
+        g_mount = pros::usd::is_installed() ? Mount::PRESENT : Mount::ABSENT;
+        if (g_mount == Mount::PRESENT) {
+            // Listing the root once wakes the filesystem before the first fopen.
+            char buffer[64] = {0};
+            pros::usd::list_files("/", buffer, sizeof(buffer));
+        }
+    }
+    return g_mount == Mount::PRESENT;
+}
+} // namespace
+
+FILE* open(const char* name, const char* mode) {
+    if (!name || !mode || name[0] == '\0') {
+        return nullptr;
+    }
+
+    g_mutex.take();
+    if (!mounted_locked()) {
+        g_mutex.give();
+        return nullptr;
+    }
+
+    const bool reading = mode[0] == 'r';
+    const Resolved* known = find(name);
+    if (known && known->prefix == kMissing && reading) {
+        ++g_stats.cached_misses;
+        g_mutex.give();
+        return nullptr;
+    }
+    if (known && known->prefix != kMissing) {
+        FILE* file = try_open(known->prefix, name, mode);
+        if (file) {
+            ++g_stats.cache_hits;
+            g_mutex.give();
+            return file;
+        }
+    }
+
+    for (int prefix = 0; prefix < kPrefixCount; ++prefix) {
+        if (!applies(prefix, name)) {
+            continue;
+        }
+        FILE* file = try_open(prefix, name, mode);
+        if (file) {
+            remember(name, prefix);
+            g_mutex.give();
+            return file;
+        }
+    }
+
+    if (reading) {
+        remember(name, kMissing);
+    }
+    g_mutex.give();
+    return nullptr;
+}
+
+bool preallocate(FILE* file, long bytes) {
+    if (!file) {
+        return false;
+    }
+    const long pos = std::ftell(file);
+    if (pos < 0 || pos >= bytes) {
+        return pos >= 0;
+    }
+    const bool extended =
+        std::fseek(file, bytes - 1, SEEK_SET) == 0 && std::fputc(0, file) != EOF && std::fflush(file) == 0;
+    return std::fseek(file, pos, SEEK_SET) == 0 && extended;
+}
+
+bool mounted() {
+    g_mutex.take();
+    const bool present = mounted_locked();
+    g_mutex.give();
+    return present;
+}
+
+void reset() {
+    g_mutex.take();
+    g_resolved.clear();
+    g_mount = Mount::UNKNOWN;
+    g_mutex.give();
+}
+
+bool is_images_path(const std::string& path) {
+    return text::starts_with(path.c_str(), "/usd/Images/") || text::starts_with(path.c_str(), "usd/Images/");
+}
+
+std::string coerce_images_path(const std::string& path) {
+    if (path.empty() || is_images_path(path)) {
+        return path;
+    }
+    const std::size_t slash = path.find_last_of('/');
+    const std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    if (name.empty()) {
+        return "";
+    }
+    return std::string("/usd/Images/") + name;
+}
+
+const Stats& stats() {
+    return g_stats;
+}
+
+void log_stats() {
+    std::printf("[sd] %" PRIu32 " fopen calls, %" PRIu32 " cache hits, %" PRIu32 " cached misses\n",
+                g_stats.fopen_calls, g_stats.cache_hits, g_stats.cached_misses);
+}
+} // namespace sd
@@ -0,0 +1,211 @@
+#include "bonkers/text.hpp"
+
+#include <cctype>
+#include <climits>
+#include <cstring>
+
+namespace text {
+namespace {
+void print_report(const char* tag, const char* name, int line, int column, const char* message) {
+    std::printf("[%s] %s:%d:%d: %s\n", tag, name ? name : "?", line, column, message);
+}
+
+ReportFn g_report = print_report;
+
+bool is_space(char ch) {
+    return ch == ' ' || ch == '\t';
+}
+} // namespace
+
+bool starts_with(const char* str, const char* prefix) {
+    if (!str || !prefix) {
+        return false;
+    }
+    return std::strncmp(str, prefix, std::strlen(prefix)) == 0;
+}
+
+bool ends_with_ci(const std::string& value, const char* suffix) {
+    const std::size_t len = std::strlen(suffix);
+    if (value.size() < len) {
+        return false;
+    }
+    const char* tail = value.data() + value.size() - len;
+    for (std::size_t i = 0; i < len; ++i) {
+        if (std::tolower(static_cast<unsigned char>(tail[i])) != suffix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void chomp_line(char* line) {
+    if (!line) {
+        return;
+    }
+    std::size_t len = std::strlen(line);
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+        line[--len] = '\0';
+    }
+}
+
+LineReader::LineReader(FILE* file, char* buffer, std::size_t capacity)
+    : m_file(file), m_buffer(buffer), m_capacity(capacity), m_eof(file == nullptr || capacity < 2) {
+    fill();
+    if (m_end - m_begin >= 3 && std::memcmp(m_buffer, "\xEF\xBB\xBF", 3) == 0) {
+        m_begin = 3;
+    }
+}
+
+// Moves the unread tail to the front and tops the buffer up with one read.
+bool LineReader::fill() {
+    if (m_eof) {
+        return false;
+    }
+    const std::size_t tail = m_end - m_begin;
+    std::memmove(m_buffer, m_buffer + m_begin, tail);
+    m_begin = 0;
+    m_end = tail;
+    const std::size_t room = m_capacity - 1 - m_end;
+    const std::size_t got = room > 0 ? std::fread(m_buffer + m_end, 1, room, m_file) : 0;
+    m_end += got;
+    if (got < room) {
+        m_eof = true;
+    }
+    return got > 0;
+}
+
+char* LineReader::next() {
+    m_cut = false;
+    if (m_skip) {
+        skip_rest();
+    }
+    while (true) {
+        char* start = m_buffer + m_begin;
+        const std::size_t unread = m_end - m_begin;
+        if (char* newline = static_cast<char*>(std::memchr(start, '\n', unread))) {
+            *newline = '\0';
+            m_begin = static_cast<std::size_t>(newline - m_buffer) + 1;
+            return take(start);
+        }
+        if (!m_eof && unread < m_capacity - 1) {
+            fill();
+            continue;
+        }
+        if (unread == 0) {
+            return nullptr;
+        }
+
+        // The last line without a newline, or a line that fills the whole
+        // buffer; the rest of an overlong line is skipped on the next call.
+        m_buffer[m_end] = '\0';
+        m_begin = m_end;
+        m_cut = !m_eof;
+        m_skip = m_cut;
+        return take(start);
+    }
+}
+
+char* LineReader::take(char* line) {
+    ++m_line;
+    chomp_line(line);
+    return line;
+}
+
+void LineReader::skip_rest() {
+    m_skip = false;
+    while (true) {
+        const char* start = m_buffer + m_begin;
+        if (const char* newline = static_cast<const char*>(std::memchr(start, '\n', m_end - m_begin))) {
+            m_begin = static_cast<std::size_t>(newline - m_buffer) + 1;
+            return;
+        }
+        m_begin = m_end;
+        if (!fill()) {
+            return;
+        }
+    }
+}
+
+void Cursor::skip_spaces() {
+    while (is_space(*m_pos)) {
+        ++m_pos;
+    }
+}
+
+bool Cursor::at_end() {
+    skip_spaces();
+    return *m_pos == '\0';
+}
+
+char* Cursor::token(char delimiter, std::size_t* length, bool* found) {
+    skip_spaces();
+    char* start = m_pos;
+    while (*m_pos != '\0' && *m_pos != delimiter) {
+        ++m_pos;
+    }
+    char* end = m_pos;
+    const bool hit = *m_pos == delimiter && delimiter != '\0';
+    if (hit) {
+        *m_pos++ = '\0';
+    }
+    while (end > start && is_space(end[-1])) {
+        --end;
+    }
+    *end = '\0';
+    if (length) {
+        *length = static_cast<std::size_t>(end - start);
+    }
+    if (found) {
+        *found = hit;
+    }
+    return start;
+}
+
+bool Cursor::integer(int* out) {
+    skip_spaces();
+    const char* pos = m_pos;
+    const bool negative = *pos == '-';
+    if (*pos == '-' || *pos == '+') {
+        ++pos;
+    }
+    if (!std::isdigit(static_cast<unsigned char>(*pos))) {
+        return false;
+    }
+    long long value = 0;
+    while (std::isdigit(static_cast<unsigned char>(*pos))) {
+        if (value <= INT_MAX) {
+            value = value * 10 + (*pos - '0');
+        }
+        ++pos;
+    }
+    value = negative ? -value : value;
+    *out = value > INT_MAX ? INT_MAX : value < INT_MIN ? INT_MIN : static_cast<int>(value);
+    m_pos = const_cast<char*>(pos);
+    return true;
+}
+
+bool Cursor::consume(char ch) {
+    skip_spaces();
+    if (*m_pos != ch) {
+        return false;
+    }
+    ++m_pos;
+    return true;
+}
+
+void uppercase(char* str) {
+    for (; *str != '\0'; ++str) {
+        *str = static_cast<char>(std::toupper(static_cast<unsigned char>(*str)));
+    }
+}
+
+void set_report(ReportFn fn) {
+    g_report = fn;
+}
+
+void report(const char* tag, const char* name, int line, int column, const char* message) {
+    if (g_report) {
+        g_report(tag, name, line, column, message);
+    }
+}
+} // namespace text
@@ -0,0 +1,11 @@
+#include "bonkers/ui.hpp"
+
+#include "pros/screen.hpp"
+
+namespace ui {
+void draw_button(const Rect& r, const char* label, std::uint32_t color) {
+    pros::screen::set_pen(color);
+    pros::screen::draw_rect(r.x, r.y, r.x + r.w, r.y + r.h);
+    pros::screen::print(pros::E_TEXT_MEDIUM, r.x + 6, r.y + 8, label);
+}
+} // namespace ui
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "bonkers/image_decoder.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace image {
+// Files larger than this are never offered; decoding them takes too long.
+constexpr std::uint32_t kMaxImageFileBytes = 8u * 1024u * 1024u;
+constexpr std::int32_t kMaxImageSide = 4096;
+
+enum class IndexStatus { OK, BROKEN, OVERSIZED };
+
+// What the index remembers about one image so the selector never has to
+// open it just to list it.
+struct IndexEntry {
+    std::string name;            // file name inside the directory
+    std::uint32_t size;          // file size in bytes
+    std::uint32_t fingerprint;   // hash of size + leading bytes; stands in for an mtime
+    Format format;
+    IndexStatus status;
+};
+
+// Keeps `<dir>/.index` in sync with the .bmp/.vbi files in a directory.
+// A refresh lists the directory once. Each image already in the index is
+// opened only to check its size and leading bytes against its fingerprint;
+// new images and ones overwritten under the same name are probed in full,
+// and then the file is rewritten.
+class DirectoryIndex {
+    public:
+        // list_dir is the pros::usd::list_files path ("/Images"); path_prefix
+        // is what fopen needs ("/usd/Images").
+        DirectoryIndex(const char* list_dir, const char* path_prefix);
+
+        // Returns false if the directory could not be listed.
+        bool refresh();
+
+        const std::vector<IndexEntry>& entries() const { return m_entries; }
+
+        // Full paths of the images that passed validation, in listing order.
+        std::vector<std::string> usable_paths() const;
+
+        // Images probed in full by the most recent refresh().
+        int last_probe_count() const { return m_probed; }
+    private:
+        bool list_names(std::vector<std::string>* names);
+        bool load(std::uint32_t* listing_hash);
+        bool save(std::uint32_t listing_hash) const;
+        IndexEntry probe(const std::string& name) const;
+        bool unchanged(const IndexEntry& entry) const;
+        std::string full_path(const std::string& name) const;
+
+        std::string m_list_dir;
+        std::string m_prefix;
+        std::vector<IndexEntry> m_entries;
+        int m_probed = 0;
+};
+} // namespace image
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "bonkers/image_decoder.hpp"
+#include "pros/rtos.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace image {
+constexpr int kThumbScale = 5;
+constexpr int kThumbW = kScreenW / kThumbScale;
+constexpr int kThumbH = kScreenH / kThumbScale;
+
+// Decodes images on a low-priority task so the UI only ever blits. The
+// focused image and its neighbours are kept in a small ring of full frames,
+// and every decode also leaves a downscaled thumbnail behind for the grid.
+//
+// Refocusing drops everything still queued, so fast tapping never backs up
+// behind stale loads. A decode already in flight finishes and lands in the
+// ring if there is room; results from before set_images() are discarded.
+class Prefetcher {
+    public:
+        explicit Prefetcher(OpenFn open_fn);
+
+        void start();
+
+        // Replaces the image list and forgets every decoded frame/thumbnail.
+        void set_images(const std::vector<std::string>& paths);
+
+        // Makes `index` current and queues it, then next, then previous.
+        void focus(int index);
+
+        // Queues missing thumbnails for images [first, first + count).
+        void request_thumbnails(int first, int count);
+
+        // Blit a decoded frame/thumbnail; false if it is not ready yet.
+        bool draw_frame(int index, int x, int y);
+        bool draw_thumbnail(int index, int x, int y);
+
+        // Bumped after every finished decode so the UI knows to redraw.
+        std::uint32_t completed() const { return m_completed.load(); }
+
+        // Held by the worker while it reads SD; take it before other SD I/O.
+        pros::Mutex& io_mutex() { return m_io_mutex; }
+    private:
+        static constexpr int kFrameSlots = 3;
+
+        struct Job {
+            int index;
+            bool keep_frame;
+            std::uint32_t list_id;
+        };
+
+        struct Slot {
+            int index = -1;
+            std::vector<std::uint32_t> pixels;
+        };
+
+        struct Thumb {
+            bool ready = false;
+            bool failed = false;
+            std::vector<std::uint32_t> pixels;
+        };
+
+        void run();
+        bool next_job(Job* out, std::string* path);
+        bool decode_into_scratch(const std::string& path);
+        void make_thumbnail(std::vector<std::uint32_t>* out) const;
+        void store(const Job& job, bool ok, std::vector<std::uint32_t>&& thumb);
+        Slot* find_slot(int index);
+        Slot* free_slot();
+        bool in_window(int index) const;
+        void enqueue(int index, bool keep_frame);
+        void blit(const std::uint32_t* pixels, int x, int y, int w, int h);
+
+        OpenFn m_open;
+        std::vector<std::string> m_paths;
+        std::deque<Job> m_queue;
+        Slot m_slots[kFrameSlots];
+        std::vector<Thumb> m_thumbs;
+        std::vector<std::uint32_t> m_scratch;
+        int m_focus = -1;
+        std::uint32_t m_list_id = 0;
+        std::atomic<std::uint32_t> m_completed{0};
+        pros::Mutex m_mutex;
+        pros::Mutex m_io_mutex;
+        std::optional<pros::Task> m_task;
+};
+} // namespace image
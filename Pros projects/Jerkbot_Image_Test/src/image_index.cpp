@@ -0,0 +1,269 @@
+#include "image_index.hpp"
+
+#include "bonkers/text.hpp"
+
+#include "pros/error.h"
+#include "pros/misc.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace image {
+namespace {
+constexpr char kIndexName[] = ".index";
+constexpr char kIndexMagic[] = "VIDX2";
+constexpr std::size_t kFingerprintBytes = 64;
+
+// Reused by every refresh instead of a fresh 16 KB allocation.
+char g_list_buffer[16384];
+
+// An index line is under 80 bytes of fields plus the name, and a FatFs long
+// name is up to 255 characters of up to 3 UTF-8 bytes each.
+constexpr std::size_t kIndexLineBytes = 1024;
+char g_index_line[kIndexLineBytes];
+
+bool is_image_file(const std::string& name) {
+    return text::ends_with_ci(name, ".bmp") || text::ends_with_ci(name, ".vbi");
+}
+
+// FNV-1a; only used to notice changes, not for anything adversarial.
+std::uint32_t fnv1a(const void* data, std::size_t len, std::uint32_t hash = 2166136261u) {
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    for (std::size_t i = 0; i < len; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+std::uint32_t hash_names(const std::vector<std::string>& names) {
+    std::uint32_t hash = 2166136261u;
+    for (const auto& name : names) {
+        hash = fnv1a(name.data(), name.size(), hash);
+        hash = fnv1a("\n", 1, hash);
+    }
+    return hash;
+}
+
+// Hash of the file's size and first kFingerprintBytes; leaves the file
+// position at the start.
+std::uint32_t fingerprint(FILE* file, std::uint32_t* size) {
+    *size = 0;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        const long end = std::ftell(file);
+        *size = end > 0 ? static_cast<std::uint32_t>(end) : 0;
+    }
+    std::uint8_t head[kFingerprintBytes];
+    std::fseek(file, 0, SEEK_SET);
+    const std::size_t head_len = std::fread(head, 1, sizeof(head), file);
+    std::fseek(file, 0, SEEK_SET);
+    return fnv1a(head, head_len, fnv1a(size, sizeof(*size)));
+}
+
+const char* status_name(IndexStatus status) {
+    switch (status) {
+        case IndexStatus::OK: return "ok";
+        case IndexStatus::OVERSIZED: return "big";
+        case IndexStatus::BROKEN: break;
+    }
+    return "broken";
+}
+
+IndexStatus parse_status(const char* text) {
+    if (std::strcmp(text, "ok") == 0) return IndexStatus::OK;
+    if (std::strcmp(text, "big") == 0) return IndexStatus::OVERSIZED;
+    return IndexStatus::BROKEN;
+}
+} // namespace
+
+DirectoryIndex::DirectoryIndex(const char* list_dir, const char* path_prefix)
+    : m_list_dir(list_dir), m_prefix(path_prefix) {}
+
+bool DirectoryIndex::refresh() {
+    m_probed = 0;
+    std::vector<std::string> names;
+    if (!list_names(&names)) {
+        m_entries.clear();
+        return false;
+    }
+
+    const std::uint32_t listing_hash = hash_names(names);
+    std::uint32_t stored_hash = 0;
+    const bool same_names = load(&stored_hash) && stored_hash == listing_hash && m_entries.size() == names.size();
+
+    std::vector<IndexEntry> next;
+    next.reserve(names.size());
+    for (const auto& name : names) {
+        const IndexEntry* known = nullptr;
+        for (const auto& entry : m_entries) {
+            if (entry.name == name) {
+                known = &entry;
+                break;
+            }
+        }
+        if (known && unchanged(*known)) {
+            next.push_back(*known);
+        } else {
+            next.push_back(probe(name));
+            ++m_probed;
+        }
+    }
+    m_entries.swap(next);
+    if (!same_names || m_probed > 0) {
+        save(listing_hash);
+    }
+    return true;
+}
+
+std::vector<std::string> DirectoryIndex::usable_paths() const {
+    std::vector<std::string> paths;
+    paths.reserve(m_entries.size());
+    for (const auto& entry : m_entries) {
+        if (entry.status == IndexStatus::OK) {
+            paths.push_back(full_path(entry.name));
+        }
+    }
+    return paths;
+}
+
+bool DirectoryIndex::list_names(std::vector<std::string>* names) {
+    g_list_buffer[0] = '\0';
+    if (pros::usd::list_files(m_list_dir.c_str(), g_list_buffer, static_cast<std::int32_t>(sizeof(g_list_buffer))) ==
+        PROS_ERR) {
+        return false;
+    }
+    g_list_buffer[sizeof(g_list_buffer) - 1] = '\0';
+
+    const char* start = g_list_buffer;
+    while (*start) {
+        const char* end = std::strchr(start, '\n');
+        const std::size_t len = end ? static_cast<std::size_t>(end - start) : std::strlen(start);
+        if (len > 0) {
+            std::string name(start, len);
+            if (is_image_file(name)) {
+                names->push_back(name);
+            }
+        }
+        if (!end) break;
+        start = end + 1;
+    }
+    return true;
+}
+
+// Index layout: a "VIDX2 <listing hash>" line, then one line per image:
+//   <size> <fingerprint> <bmp|vbi> <status> <name>
+// The name goes last so it may contain spaces.
+bool DirectoryIndex::load(std::uint32_t* listing_hash) {
+    const std::string path = full_path(kIndexName);
+    FILE* file = std::fopen(path.c_str(), "r");
+    if (!file) {
+        return false;
+    }
+
+    text::LineReader reader(file, g_index_line, sizeof(g_index_line));
+    char* line = reader.next();
+    char magic[8] = {0};
+    unsigned long hash = 0;
+    if (!line || std::sscanf(line, "%7s %lx", magic, &hash) != 2 || std::strcmp(magic, kIndexMagic) != 0) {
+        std::fclose(file);
+        return false;
+    }
+
+    std::vector<IndexEntry> entries;
+    while ((line = reader.next())) {
+        // A cut line would name a file that does not exist; leaving it out
+        // gets the image probed and the index rewritten.
+        if (reader.cut()) {
+            text::report("index", path.c_str(), reader.line(), static_cast<int>(kIndexLineBytes) - 1,
+                         "line fills the read buffer; entry skipped");
+            continue;
+        }
+        unsigned long size = 0;
+        unsigned long fingerprint = 0;
+        char format[4] = {0};
+        char status[8] = {0};
+        int name_pos = 0;
+        if (std::sscanf(line, "%lu %lx %3s %7s %n", &size, &fingerprint, format, status, &name_pos) < 4 ||
+            name_pos <= 0 || line[name_pos] == '\0') {
+            continue;
+        }
+        entries.push_back(IndexEntry{line + name_pos, static_cast<std::uint32_t>(size),
+                                     static_cast<std::uint32_t>(fingerprint),
+                                     std::strcmp(format, "vbi") == 0 ? Format::VBI : Format::BMP,
+                                     parse_status(status)});
+    }
+    std::fclose(file);
+
+    m_entries.swap(entries);
+    *listing_hash = static_cast<std::uint32_t>(hash);
+    return true;
+}
+
+bool DirectoryIndex::save(std::uint32_t listing_hash) const {
+    FILE* file = std::fopen(full_path(kIndexName).c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "%s %08" PRIx32 "\n", kIndexMagic, listing_hash);
+    for (const auto& entry : m_entries) {
+        std::fprintf(file, "%" PRIu32 " %08" PRIx32 " %s %s %s\n", entry.size, entry.fingerprint,
+                     entry.format == Format::VBI ? "vbi" : "bmp", status_name(entry.status), entry.name.c_str());
+    }
+    std::fclose(file);
+    return true;
+}
+
+// One open and a kFingerprintBytes read, against a full probe's header parse.
+bool DirectoryIndex::unchanged(const IndexEntry& entry) const {
+    FILE* file = std::fopen(full_path(entry.name).c_str(), "rb");
+    if (!file) {
+        return entry.status == IndexStatus::BROKEN;
+    }
+    std::uint32_t size = 0;
+    const std::uint32_t hash = fingerprint(file, &size);
+    std::fclose(file);
+    return size == entry.size && hash == entry.fingerprint;
+}
+
+IndexEntry DirectoryIndex::probe(const std::string& name) const {
+    IndexEntry entry{name, 0, 0, Format::BMP, IndexStatus::BROKEN};
+    FILE* file = std::fopen(full_path(name).c_str(), "rb");
+    if (!file) {
+        return entry;
+    }
+    entry.fingerprint = fingerprint(file, &entry.size);
+
+    ImageHeader header{};
+    if (read_header(file, &header)) {
+        entry.format = header.format;
+        std::int32_t width = 0;
+        std::int32_t height = 0;
+        std::uint64_t data_end = 0;
+        if (header.format == Format::VBI) {
+            width = header.vbi.width;
+            height = header.vbi.height;
+            data_end = vbi::kHeaderSize + static_cast<std::uint64_t>(header.vbi.payload_size);
+        } else {
+            width = header.bmp.width;
+            height = header.bmp.height;
+            data_end = header.bmp.data_offset + static_cast<std::uint64_t>(header.bmp.row_size) * header.bmp.height;
+        }
+
+        if (entry.size > kMaxImageFileBytes || width > kMaxImageSide || height > kMaxImageSide) {
+            entry.status = IndexStatus::OVERSIZED;
+        } else if (data_end <= entry.size) {
+            entry.status = IndexStatus::OK;
+        }
+    }
+    std::fclose(file);
+    return entry;
+}
+
+std::string DirectoryIndex::full_path(const std::string& name) const {
+    std::string path = m_prefix;
+    if (!path.empty() && path.back() != '/') {
+        path += '/';
+    }
+    return path + name;
+}
+} // namespace image
@@ -0,0 +1,251 @@
+#include "image_prefetch.hpp"
+
+#include "pros/screen.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace image {
+namespace {
+constexpr std::size_t kFramePixels = static_cast<std::size_t>(kScreenW) * kScreenH;
+constexpr std::uint32_t kIdleWaitMs = 100;
+
+void store_row(void* ctx, int row, const std::uint32_t* pixels, int width) {
+    auto* frame = static_cast<std::uint32_t*>(ctx);
+    std::copy(pixels, pixels + width, frame + static_cast<std::size_t>(row) * kScreenW);
+}
+} // namespace
+
+Prefetcher::Prefetcher(OpenFn open_fn) : m_open(open_fn) {}
+
+void Prefetcher::start() {
+    if (m_task) {
+        return;
+    }
+    m_scratch.assign(kFramePixels, 0);
+    m_task.emplace([this] { run(); }, TASK_PRIORITY_DEFAULT - 2, TASK_STACK_DEPTH_DEFAULT, "image prefetch");
+}
+
+void Prefetcher::set_images(const std::vector<std::string>& paths) {
+    m_mutex.take();
+    m_paths = paths;
+    ++m_list_id;
+    m_queue.clear();
+    for (auto& slot : m_slots) {
+        slot.index = -1;
+    }
+    m_thumbs.assign(paths.size(), Thumb{});
+    m_focus = -1;
+    m_mutex.give();
+}
+
+void Prefetcher::focus(int index) {
+    m_mutex.take();
+    const int count = static_cast<int>(m_paths.size());
+    if (index < 0 || index >= count) {
+        m_mutex.give();
+        return;
+    }
+    m_focus = index;
+    m_queue.clear();
+    enqueue(index, true);
+    enqueue((index + 1) % count, true);
+    enqueue((index - 1 + count) % count, true);
+    m_mutex.give();
+    if (m_task) {
+        m_task->notify();
+    }
+}
+
+void Prefetcher::request_thumbnails(int first, int count) {
+    m_mutex.take();
+    m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), [](const Job& job) { return !job.keep_frame; }),
+                  m_queue.end());
+    const int last = std::min(first + count, static_cast<int>(m_paths.size()));
+    for (int i = std::max(first, 0); i < last; ++i) {
+        enqueue(i, false);
+    }
+    m_mutex.give();
+    if (m_task) {
+        m_task->notify();
+    }
+}
+
+bool Prefetcher::draw_frame(int index, int x, int y) {
+    m_mutex.take();
+    const Slot* slot = find_slot(index);
+    if (slot) {
+        blit(slot->pixels.data(), x, y, kScreenW, kScreenH);
+    }
+    m_mutex.give();
+    return slot != nullptr;
+}
+
+bool Prefetcher::draw_thumbnail(int index, int x, int y) {
+    m_mutex.take();
+    const bool ready = index >= 0 && index < static_cast<int>(m_thumbs.size()) && m_thumbs[index].ready;
+    if (ready) {
+        blit(m_thumbs[index].pixels.data(), x, y, kThumbW, kThumbH);
+    }
+    m_mutex.give();
+    return ready;
+}
+
+void Prefetcher::run() {
+    while (true) {
+        Job job{};
+        std::string path;
+        if (!next_job(&job, &path)) {
+            pros::Task::notify_take(true, kIdleWaitMs);
+            continue;
+        }
+
+        m_io_mutex.take();
+        const bool ok = decode_into_scratch(path);
+        m_io_mutex.give();
+
+        std::vector<std::uint32_t> thumb;
+        if (ok) {
+            make_thumbnail(&thumb);
+        }
+        store(job, ok, std::move(thumb));
+    }
+}
+
+bool Prefetcher::next_job(Job* out, std::string* path) {
+    m_mutex.take();
+    while (!m_queue.empty()) {
+        const Job job = m_queue.front();
+        m_queue.pop_front();
+        if (job.index >= static_cast<int>(m_paths.size())) {
+            continue;
+        }
+        const Thumb& thumb = m_thumbs[job.index];
+        if (job.keep_frame ? find_slot(job.index) != nullptr : (thumb.ready || thumb.failed)) {
+            continue;
+        }
+        *out = job;
+        *path = m_paths[job.index];
+        m_mutex.give();
+        return true;
+    }
+    m_mutex.give();
+    return false;
+}
+
+bool Prefetcher::decode_into_scratch(const std::string& path) {
+    std::fill(m_scratch.begin(), m_scratch.end(), 0);
+    FILE* file = m_open ? m_open(path.c_str(), "rb") : nullptr;
+    if (!file) {
+        return false;
+    }
+    ImageHeader header{};
+    ReadStats stats{};
+    const bool ok = read_header(file, &header) && decode(file, header, store_row, m_scratch.data(), &stats);
+    std::fclose(file);
+    log_read_stats(path.c_str(), stats);
+    return ok;
+}
+
+// Box-averages kThumbScale x kThumbScale blocks of the scratch frame.
+void Prefetcher::make_thumbnail(std::vector<std::uint32_t>* out) const {
+    constexpr std::uint32_t kArea = kThumbScale * kThumbScale;
+    out->resize(static_cast<std::size_t>(kThumbW) * kThumbH);
+    for (int ty = 0; ty < kThumbH; ++ty) {
+        for (int tx = 0; tx < kThumbW; ++tx) {
+            std::uint32_t r = 0;
+            std::uint32_t g = 0;
+            std::uint32_t b = 0;
+            for (int dy = 0; dy < kThumbScale; ++dy) {
+                const std::uint32_t* src =
+                    m_scratch.data() + static_cast<std::size_t>(ty * kThumbScale + dy) * kScreenW + tx * kThumbScale;
+                for (int dx = 0; dx < kThumbScale; ++dx) {
+                    r += (src[dx] >> 16) & 0xFF;
+                    g += (src[dx] >> 8) & 0xFF;
+                    b += src[dx] & 0xFF;
+                }
+            }
+            (*out)[static_cast<std::size_t>(ty) * kThumbW + tx] =
+                ((r / kArea) << 16) | ((g / kArea) << 8) | (b / kArea);
+        }
+    }
+}
+
+void Prefetcher::store(const Job& job, bool ok, std::vector<std::uint32_t>&& thumb) {
+    m_mutex.take();
+    if (job.list_id != m_list_id) {
+        m_mutex.give();
+        return;
+    }
+
+    Thumb& entry = m_thumbs[job.index];
+    if (ok) {
+        entry.pixels = std::move(thumb);
+        entry.ready = true;
+    } else {
+        entry.failed = true;
+    }
+
+    if (ok && job.keep_frame && !find_slot(job.index)) {
+        Slot* slot = free_slot();
+        if (slot) {
+            // Hand the decoded frame to the ring and take the slot's old buffer
+            // as the next scratch, so steady-state browsing never allocates.
+            slot->index = job.index;
+            std::swap(slot->pixels, m_scratch);
+            if (m_scratch.size() != kFramePixels) {
+                m_scratch.assign(kFramePixels, 0);
+            }
+        }
+    }
+    ++m_completed;
+    m_mutex.give();
+}
+
+Prefetcher::Slot* Prefetcher::find_slot(int index) {
+    for (auto& slot : m_slots) {
+        if (slot.index == index && index >= 0) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+Prefetcher::Slot* Prefetcher::free_slot() {
+    for (auto& slot : m_slots) {
+        if (slot.index < 0) {
+            return &slot;
+        }
+    }
+    for (auto& slot : m_slots) {
+        if (!in_window(slot.index)) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+bool Prefetcher::in_window(int index) const {
+    const int count = static_cast<int>(m_paths.size());
+    if (m_focus < 0 || count == 0) {
+        return false;
+    }
+    return index == m_focus || index == (m_focus + 1) % count || index == (m_focus - 1 + count) % count;
+}
+
+void Prefetcher::enqueue(int index, bool keep_frame) {
+    if (keep_frame ? find_slot(index) != nullptr : (m_thumbs[index].ready || m_thumbs[index].failed)) {
+        return;
+    }
+    m_queue.push_back(Job{index, keep_frame, m_list_id});
+}
+
+void Prefetcher::blit(const std::uint32_t* pixels, int x, int y, int w, int h) {
+    pros::screen::copy_area(static_cast<std::int16_t>(x),
+                            static_cast<std::int16_t>(y),
+                            static_cast<std::int16_t>(x + w - 1),
+                            static_cast<std::int16_t>(y + h - 1),
+                            const_cast<std::uint32_t*>(pixels),
+                            w);
+}
+} // namespace image
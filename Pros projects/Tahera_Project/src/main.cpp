@@ -1,81 +1,33 @@
 #include "main.h"
-#include <algorithm>
+#include "bonkers/config_bundle.hpp"
+#include "bonkers/drive_geometry.hpp"
+#include "bonkers/image_cache.hpp"
+#include "bonkers/plan.hpp"
+#include "bonkers/plan_arena.hpp"
+#include "bonkers/plan_pros.hpp"
+#include "bonkers/plan_vm.hpp"
+#include "bonkers/sd_path.hpp"
+#include "bonkers/ui.hpp"
+#include "hot-cold-asset/asset.hpp"
+#include <atomic>
+#include <cinttypes>
 #include <cstddef>
-#include <cerrno>
 #include <cstdint>
 #include <cstdio>
+#include <iterator>
 #include <string>
-#include <cmath>
 #include <vector>
-#include <cstring>
-#include <cctype>
 
 namespace {
 constexpr char kLoadingIconName[] = "loading_icon.bmp";
 constexpr int kScreenW = 480;
 constexpr int kScreenH = 240;
 constexpr int kSplashHoldMs = 2000;
-
-bool starts_with(const char* str, const char* prefix) {
-    if (!str || !prefix) {
-        return false;
-    }
-    const std::size_t prefix_len = std::strlen(prefix);
-    return std::strncmp(str, prefix, prefix_len) == 0;
-}
-
-bool try_mount_sd() {
-    char buffer[64] = {0};
-    errno = 0;
-    return pros::usd::list_files("/", buffer, sizeof(buffer)) != PROS_ERR;
 }
 
-FILE* sd_open(const char* name, const char* mode) {
-    if (!name || !mode) {
-        return nullptr;
-    }
-
-    const char* prefixes[] = {
-        "/usd/",
-        "usd/",
-        "/usd/Images/",
-        "/usd/images/",
-        "usd/Images/",
-        "usd/images/",
-    };
-
-    for (int attempt = 0; attempt < 3; ++attempt) {
-        FILE* file = std::fopen(name, mode);
-        if (file) {
-            return file;
-        }
-
-        if (starts_with(name, "usd/")) {
-            char fixed[128];
-            std::snprintf(fixed, sizeof(fixed), "/%s", name);
-            file = std::fopen(fixed, mode);
-            if (file) {
-                return file;
-            }
-        }
-
-        try_mount_sd();
-
-        char path[128];
-        for (const char* prefix : prefixes) {
-            std::snprintf(path, sizeof(path), "%s%s", prefix, name);
-            file = std::fopen(path, mode);
-            if (file) {
-                return file;
-            }
-        }
-
-        pros::delay(50);
-    }
-
-    return nullptr;
-}
-}
+using plan::Step;
+using plan::StepType;
+using ui::Rect;
 
 // ======================================================
 // 1. MOTORS & SENSORS (PROS 4 Syntax)
@@ -100,20 +52,14 @@ enum class AutonMode {
 };
 
 static AutonMode g_auton_mode = AutonMode::GPS_LEMLIB;
-static bool g_sd_plans_loaded = false;
 static bool g_manual_auton_request = false;
 static bool g_auton_running = false;
 static bool g_gps_drive_enabled = false;
 static bool g_six_wheel_drive_enabled = true;
 pros::Mutex g_auton_mutex;
-constexpr int kSlotCount = 3;
-constexpr char kSlot1File[] = "auton_plans_slot1.txt";
-constexpr char kSlot2File[] = "auton_plans_slot2.txt";
-constexpr char kSlot3File[] = "auton_plans_slot3.txt";
-constexpr char kSlotIndexFile[] = "auton_slot.txt";
-constexpr char kControllerMappingFile[] = "controller_mapping.txt";
-static int g_active_slot = 0;
-constexpr char kUiConfigName[] = "ui_images.txt";
+// Picked from the brain UI task and read by auton; the UI changes it under
+// g_auton_mutex so a run never starts on a slot switched halfway.
+static std::atomic<int> g_active_slot{0};
 constexpr char kDefaultSplash[] = "loading_icon.bmp";
 constexpr char kDefaultRun[] = "jerkbot.bmp";
 constexpr int kAutonMaxMs = 15000;
@@ -129,423 +75,241 @@ std::uint32_t g_auton_end_ms = 0;
 bool g_auton_abort = false;
 constexpr std::uint32_t kSelectionUiTimeoutMs = 5000;
 
-enum class ControllerAction {
-    INTAKE_IN = 0,
-    INTAKE_OUT,
-    OUTAKE_OUT,
-    OUTAKE_IN,
-    GPS_ENABLE,
-    GPS_DISABLE,
-    SIX_WHEEL_ON,
-    SIX_WHEEL_OFF
-};
+using ControllerAction = config::Action;
 
-constexpr int kControllerActionCount = 8;
-
-pros::controller_digital_e_t g_controller_mapping[kControllerActionCount] = {
-    DIGITAL_L1,
-    DIGITAL_L2,
-    DIGITAL_R1,
-    DIGITAL_R2,
-    DIGITAL_A,
-    DIGITAL_B,
-    DIGITAL_Y,
-    DIGITAL_X
-};
+static_assert(static_cast<int>(DIGITAL_L1) == config::kButtonL1 && static_cast<int>(DIGITAL_A) == config::kButtonA,
+              "config buttons are PROS values");
 
-const char* controller_action_key(ControllerAction action) {
-    switch (action) {
-        case ControllerAction::INTAKE_IN: return "INTAKE_IN";
-        case ControllerAction::INTAKE_OUT: return "INTAKE_OUT";
-        case ControllerAction::OUTAKE_OUT: return "OUTAKE_OUT";
-        case ControllerAction::OUTAKE_IN: return "OUTAKE_IN";
-        case ControllerAction::GPS_ENABLE: return "GPS_ENABLE";
-        case ControllerAction::GPS_DISABLE: return "GPS_DISABLE";
-        case ControllerAction::SIX_WHEEL_ON: return "SIX_WHEEL_ON";
-        case ControllerAction::SIX_WHEEL_OFF: return "SIX_WHEEL_OFF";
-        default: return "";
-    }
-}
-
-pros::controller_digital_e_t default_controller_button(ControllerAction action) {
-    switch (action) {
-        case ControllerAction::INTAKE_IN: return DIGITAL_L1;
-        case ControllerAction::INTAKE_OUT: return DIGITAL_L2;
-        case ControllerAction::OUTAKE_OUT: return DIGITAL_R1;
-        case ControllerAction::OUTAKE_IN: return DIGITAL_R2;
-        case ControllerAction::GPS_ENABLE: return DIGITAL_A;
-        case ControllerAction::GPS_DISABLE: return DIGITAL_B;
-        case ControllerAction::SIX_WHEEL_ON: return DIGITAL_Y;
-        case ControllerAction::SIX_WHEEL_OFF: return DIGITAL_X;
-        default: return DIGITAL_A;
-    }
-}
+pros::controller_digital_e_t g_controller_mapping[config::kActionCount];
 
 pros::controller_digital_e_t mapped_button(ControllerAction action) {
     return g_controller_mapping[static_cast<int>(action)];
 }
 
-enum class StepType {
-    EMPTY,
-    DRIVE_MS,
-    TANK_MS,
-    TURN_HEADING,
-    WAIT_MS,
-    INTAKE_ON,
-    INTAKE_OFF,
-    OUTTAKE_ON,
-    OUTTAKE_OFF
-};
-
-struct Step {
-    StepType type;
-    int value1;
-    int value2;
-    int value3;
-};
-
-static std::vector<Step> gps_plan_sd;
-static std::vector<Step> basic_plan_sd;
-
-void turn_to_heading(double target, int max_speed);
-void run_simple_auton_fallback();
-
-bool draw_bmp_from_sd(const char* name, int x, int y) {
-    FILE* file = sd_open(name, "rb");
-    if (!file) {
-        return false;
-    }
-
-    std::uint8_t header[54];
-    if (std::fread(header, 1, sizeof(header), file) != sizeof(header)) {
-        std::fclose(file);
-        return false;
-    }
-
-    const std::uint32_t data_offset = *reinterpret_cast<std::uint32_t*>(&header[10]);
-    const std::int32_t width = *reinterpret_cast<std::int32_t*>(&header[18]);
-    const std::int32_t height = *reinterpret_cast<std::int32_t*>(&header[22]);
-    const std::uint16_t bpp = *reinterpret_cast<std::uint16_t*>(&header[28]);
-    const std::uint32_t compression = *reinterpret_cast<std::uint32_t*>(&header[30]);
-
-    const bool compression_ok = (compression == 0) || (compression == 3 && bpp == 32);
-    if ((bpp != 24 && bpp != 32) || !compression_ok || width <= 0 || height == 0) {
-        std::fclose(file);
-        return false;
-    }
-
-    const bool top_down = height < 0;
-    const std::int32_t abs_height = std::abs(height);
-    const std::uint32_t bytes_per_pixel = bpp / 8;
-    const std::uint32_t row_size = ((bytes_per_pixel * width + 3) / 4) * 4;
-    const int max_w = 480;
-    const int max_h = 240;
-    int target_w = width;
-    int target_h = abs_height;
-    bool scale = false;
-    if (width > max_w || abs_height > max_h) {
-        target_w = std::min(static_cast<int>(width), max_w);
-        target_h = std::min(static_cast<int>(abs_height), max_h);
-        scale = true;
-    }
-
-    std::vector<std::uint8_t> row(row_size);
-    std::vector<std::uint32_t> row_buf(static_cast<std::size_t>(target_w));
+using plan::kPlanCapacity;
 
-    std::fseek(file, static_cast<long>(data_offset), SEEK_SET);
-
-    int last_target_row = -1;
-    for (std::int32_t row_idx = 0; row_idx < abs_height; ++row_idx) {
-        if (std::fread(row.data(), 1, row_size, file) != row_size) {
-            break;
-        }
-
-        const std::int32_t draw_y = top_down ? row_idx : (abs_height - 1 - row_idx);
-
-        if (!scale) {
-            for (std::int32_t col = 0; col < width; ++col) {
-                const std::size_t idx = static_cast<std::size_t>(col * bytes_per_pixel);
-                const std::uint8_t b = row[idx];
-                const std::uint8_t g = row[idx + 1];
-                const std::uint8_t r = row[idx + 2];
-                row_buf[static_cast<std::size_t>(col)] = (static_cast<std::uint32_t>(r) << 16) |
-                                                         (static_cast<std::uint32_t>(g) << 8) |
-                                                         static_cast<std::uint32_t>(b);
-            }
+// Every slot is loaded, checked and compiled at startup, so picking one on
+// the brain is an index change and auton never reads the card.
+struct AutonSlot {
+    AutonSlot(plan::PlanBuffer gps_steps, plan::PlanBuffer basic_steps) : gps(gps_steps), basic(basic_steps) {}
 
-            const std::int16_t y_row = static_cast<std::int16_t>(y + draw_y);
-            pros::screen::copy_area(x,
-                                    y_row,
-                                    static_cast<std::int16_t>(x + width - 1),
-                                    y_row,
-                                    row_buf.data(),
-                                    width);
-            continue;
-        }
+    plan::PlanBuffer gps;
+    plan::PlanBuffer basic;
+    bool loaded = false;
+    std::size_t bad_steps = 0; // outside plan::step_in_range()
+    // Each mode's SD plan, or the built-in plan when the slot has none.
+    std::vector<plan::Instr> gps_program;
+    std::vector<plan::Instr> basic_program;
+    std::uint32_t gps_ms = 0; // plan::estimate_ms()
+    std::uint32_t basic_ms = 0;
+};
 
-        const int target_row = (draw_y * target_h) / abs_height;
-        if (target_row == last_target_row) {
-            continue;
-        }
-        last_target_row = target_row;
-
-        for (int col = 0; col < target_w; ++col) {
-            const int src_x = (col * width) / target_w;
-            const std::size_t idx = static_cast<std::size_t>(src_x * bytes_per_pixel);
-            const std::uint8_t b = row[idx];
-            const std::uint8_t g = row[idx + 1];
-            const std::uint8_t r = row[idx + 2];
-            row_buf[static_cast<std::size_t>(col)] = (static_cast<std::uint32_t>(r) << 16) |
-                                                     (static_cast<std::uint32_t>(g) << 8) |
-                                                     static_cast<std::uint32_t>(b);
-        }
+static plan::Arena<2 * kPlanCapacity * plan::kSlotCount> g_plan_arena;
+static AutonSlot g_slots[plan::kSlotCount] = {
+    AutonSlot(g_plan_arena.carve(kPlanCapacity), g_plan_arena.carve(kPlanCapacity)),
+    AutonSlot(g_plan_arena.carve(kPlanCapacity), g_plan_arena.carve(kPlanCapacity)),
+    AutonSlot(g_plan_arena.carve(kPlanCapacity), g_plan_arena.carve(kPlanCapacity)),
+};
+static_assert(plan::kSlotCount == 3, "one g_slots entry per slot");
+
+// Set by the slot loader task once every slot is ready to run; initialize()
+// waits for it.
+static std::atomic<bool> g_slots_ready{false};
+// The bundle already holds every slot's steps, so the loader skips the card.
+static bool g_slots_from_bundle = false;
+
+constexpr Step kFallbackPlan[] = {
+    {StepType::DRIVE_MS, 60, 1500, 0},
+    {StepType::WAIT_MS, 100, 0, 0},
+    {StepType::TURN_HEADING, 90, 0, 0},
+    {StepType::DRIVE_MS, -40, 500, 0},
+};
 
-        const std::int16_t y_row = static_cast<std::int16_t>(y + target_row);
-        if (y_row < 0 || y_row >= max_h) {
-            continue;
-        }
-        pros::screen::copy_area(x,
-                                y_row,
-                                static_cast<std::int16_t>(x + target_w - 1),
-                                y_row,
-                                row_buf.data(),
-                                target_w);
-    }
+// Splash, auton and driver frames stay decoded so auton start never waits on SD.
+constexpr std::size_t kImageCacheBudget = 3 * image::kFrameBytes;
+image::Cache g_image_cache(kImageCacheBudget, sd::open);
 
-    std::fclose(file);
-    return true;
-}
+// Built-in run image for when the SD card is missing; lives in the cold package.
+ASSET(cold_jerkbot_vbi)
+constexpr char kBuiltinRunName[] = "builtin:jerkbot";
 
+// Streamed rather than cached: a full-screen icon would evict one of the
+// three preloaded frames.
 bool draw_loading_icon() {
-    return draw_bmp_from_sd(kLoadingIconName, 0, 0);
+    return image::draw_file(sd::open, kLoadingIconName, 0, 0);
 }
 
-void chomp_line(char* line) {
-    if (!line) return;
-    std::size_t len = std::strlen(line);
-    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
-        line[len - 1] = '\0';
-        --len;
+void apply_controller_mapping(const std::uint8_t* buttons) {
+    for (int idx = 0; idx < config::kActionCount; ++idx) {
+        g_controller_mapping[idx] = static_cast<pros::controller_digital_e_t>(buttons[idx]);
     }
 }
 
-std::string trim_copy(const std::string& value) {
-    std::size_t start = 0;
-    while (start < value.size() && std::isspace(static_cast<unsigned char>(value[start]))) {
-        ++start;
-    }
-    std::size_t end = value.size();
-    while (end > start && std::isspace(static_cast<unsigned char>(value[end - 1]))) {
-        --end;
+void load_controller_mapping_from_sd() {
+    std::uint8_t buttons[config::kActionCount];
+    config::default_buttons(buttons);
+    FILE* file = sd::open(config::kButtonMapFile, "r");
+    config::read_buttons(file, buttons, config::kButtonMapFile);
+    if (file) {
+        std::fclose(file);
     }
-    return value.substr(start, end - start);
+    apply_controller_mapping(buttons);
 }
 
-std::string uppercase_copy(std::string value) {
-    for (char& ch : value) {
-        ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+// AUTON= wins over the legacy RUN= key; unset entries keep the defaults.
+void apply_ui_images(const config::Images& images) {
+    const bool have_run = (images.flags & config::kHasRun) && !images.run.empty();
+    g_splash_image = sd::coerce_images_path((images.flags & config::kHasSplash) ? images.splash : kDefaultSplash);
+    if (images.flags & config::kHasAuton) {
+        g_auton_image = sd::coerce_images_path(images.auton);
+    } else {
+        g_auton_image = sd::coerce_images_path(have_run ? images.run : kDefaultRun);
     }
-    return value;
+    g_driver_image = (images.flags & config::kHasDriver) ? sd::coerce_images_path(images.driver) : "";
+    g_run_image = sd::coerce_images_path((images.flags & config::kHasRun) ? images.run : kDefaultRun);
+    g_run_image = g_auton_image.empty() ? g_run_image : g_auton_image;
 }
 
-bool parse_controller_action(const std::string& key, ControllerAction* out_action) {
-    if (!out_action) {
-        return false;
-    }
-    for (int idx = 0; idx < kControllerActionCount; ++idx) {
-        const auto action = static_cast<ControllerAction>(idx);
-        if (key == controller_action_key(action)) {
-            *out_action = action;
-            return true;
-        }
+void load_ui_images() {
+    config::Images images;
+    FILE* file = sd::open(config::kUiImagesFile, "r");
+    config::read_images(file, &images, config::kUiImagesFile);
+    if (file) {
+        std::fclose(file);
     }
-    return false;
+    apply_ui_images(images);
 }
 
-bool parse_controller_button(const std::string& key, pros::controller_digital_e_t* out_button) {
-    if (!out_button) {
-        return false;
-    }
-    struct Entry {
-        const char* name;
-        pros::controller_digital_e_t button;
-    };
-    static constexpr Entry kEntries[] = {
-        {"L1", DIGITAL_L1},
-        {"L2", DIGITAL_L2},
-        {"R1", DIGITAL_R1},
-        {"R2", DIGITAL_R2},
-        {"A", DIGITAL_A},
-        {"B", DIGITAL_B},
-        {"X", DIGITAL_X},
-        {"Y", DIGITAL_Y},
-        {"UP", DIGITAL_UP},
-        {"DOWN", DIGITAL_DOWN},
-        {"LEFT", DIGITAL_LEFT},
-        {"RIGHT", DIGITAL_RIGHT},
-    };
-    for (const auto& entry : kEntries) {
-        if (key == entry.name) {
-            *out_button = entry.button;
-            return true;
-        }
+void drive_set(int left, int right) {
+    left_drive.move(left);
+    right_drive.move(right);
+    if (g_six_wheel_drive_enabled) {
+        left_middle.move(left);
+        right_middle.move(right);
+    } else {
+        left_middle.brake();
+        right_middle.brake();
     }
-    return false;
 }
 
-void reset_controller_mapping_defaults() {
-    for (int idx = 0; idx < kControllerActionCount; ++idx) {
-        const auto action = static_cast<ControllerAction>(idx);
-        g_controller_mapping[idx] = default_controller_button(action);
-    }
+void drive_brake() {
+    left_drive.brake();
+    right_drive.brake();
+    left_middle.brake();
+    right_middle.brake();
 }
 
-void load_controller_mapping_from_sd() {
-    reset_controller_mapping_defaults();
-
-    FILE* file = sd_open(kControllerMappingFile, "r");
-    if (!file) {
-        return;
-    }
-
-    char line[96];
-    while (std::fgets(line, sizeof(line), file)) {
-        chomp_line(line);
-        std::string entry = trim_copy(line);
-        if (entry.empty() || entry[0] == '#') {
-            continue;
-        }
-
-        const std::size_t eq = entry.find('=');
-        if (eq == std::string::npos) {
-            continue;
-        }
-
-        const std::string action_key = uppercase_copy(trim_copy(entry.substr(0, eq)));
-        const std::string button_key = uppercase_copy(trim_copy(entry.substr(eq + 1)));
-
-        ControllerAction action = ControllerAction::INTAKE_IN;
-        pros::controller_digital_e_t button = DIGITAL_L1;
-        if (!parse_controller_action(action_key, &action) || !parse_controller_button(button_key, &button)) {
-            continue;
-        }
-
-        g_controller_mapping[static_cast<int>(action)] = button;
-    }
+void stop_all_motors() {
+    drive_brake();
+    intake.brake();
+    outake.brake();
+}
 
-    std::fclose(file);
+// plan::Robot bindings for the auton VM.
+void vm_drive(void*, int left, int right) {
+    drive_set(left, right);
 }
 
-bool is_images_path(const std::string& path) {
-    return starts_with(path.c_str(), "/usd/Images/") || starts_with(path.c_str(), "usd/Images/");
+void vm_brake_drive(void*) {
+    drive_brake();
 }
 
-std::string coerce_images_path(const std::string& path) {
-    if (path.empty()) {
-        return "";
-    }
-    if (is_images_path(path)) {
-        return path;
-    }
-    std::string name = path;
-    const std::size_t pos = name.find_last_of('/');
-    if (pos != std::string::npos) {
-        name = name.substr(pos + 1);
-    }
-    if (name.empty()) {
-        return "";
+void vm_rollers(void*, int power) {
+    if (power == 0) {
+        intake.brake();
+        outake.brake();
+    } else {
+        intake.move(power);
+        outake.move(power);
     }
-    return std::string("/usd/Images/") + name;
 }
 
-void load_ui_images() {
-    g_splash_image = coerce_images_path(kDefaultSplash);
-    g_auton_image = coerce_images_path(kDefaultRun);
-    g_driver_image.clear();
-    g_run_image = g_auton_image;
-
-    FILE* file = sd_open(kUiConfigName, "r");
-    if (!file) {
-        return;
+void vm_intake(void*, int power) {
+    if (power == 0) {
+        intake.brake();
+    } else {
+        intake.move(power);
     }
+}
 
-    bool have_auton = false;
-    std::string legacy_run;
-    char line[128];
-    while (std::fgets(line, sizeof(line), file)) {
-        chomp_line(line);
-        if (std::strncmp(line, "SPLASH=", 7) == 0) {
-            g_splash_image = coerce_images_path(line + 7);
-        } else if (std::strncmp(line, "AUTON=", 6) == 0) {
-            g_auton_image = coerce_images_path(line + 6);
-            have_auton = true;
-        } else if (std::strncmp(line, "DRIVER=", 7) == 0) {
-            g_driver_image = coerce_images_path(line + 7);
-        } else if (std::strncmp(line, "RUN=", 4) == 0) {
-            legacy_run = line + 4;
-            g_run_image = coerce_images_path(legacy_run);
-        }
+void vm_outake(void*, int power) {
+    if (power == 0) {
+        outake.brake();
+    } else {
+        outake.move(power);
     }
+}
 
-    std::fclose(file);
-
-    if (!have_auton && !legacy_run.empty()) {
-        g_auton_image = coerce_images_path(legacy_run);
-    }
-    g_run_image = g_auton_image.empty() ? g_run_image : g_auton_image;
+void vm_stop_all(void*) {
+    stop_all_motors();
 }
 
-bool auton_time_up() {
-    return g_auton_abort || (g_auton_end_ms != 0 && pros::millis() >= g_auton_end_ms);
+double vm_heading(void*) {
+    return imu.get_heading();
 }
 
-bool delay_with_abort(int ms) {
-    const int chunk = 20;
-    int remaining = ms;
-    while (remaining > 0) {
-        if (auton_time_up()) {
-            return false;
-        }
-        pros::delay(std::min(chunk, remaining));
-        remaining -= chunk;
-    }
-    return true;
+bool vm_aborted(void*) {
+    return g_auton_abort;
 }
 
-void drive_set(int left, int right) {
-    left_drive.move(left);
-    right_drive.move(right);
+// Average of one side's encoders. The middle wheel only counts while it
+// is driven, so the distance matches g_six_wheel_drive_enabled.
+double side_mm(const pros::MotorGroup& outer, const pros::Motor& middle) {
+    double degrees = outer.get_position(0) + outer.get_position(1);
+    int count = 2;
     if (g_six_wheel_drive_enabled) {
-        left_middle.move(left);
-        right_middle.move(right);
-    } else {
-        left_middle.brake();
-        right_middle.brake();
+        degrees += middle.get_position();
+        ++count;
     }
+    return degrees / count * geometry::kMmPerMotorDegree;
 }
 
-void drive_brake() {
-    left_drive.brake();
-    right_drive.brake();
-    left_middle.brake();
-    right_middle.brake();
+double vm_left_mm(void*) {
+    return side_mm(left_drive, left_middle);
 }
 
-void stop_all_motors() {
-    drive_brake();
-    intake.brake();
-    outake.brake();
+double vm_right_mm(void*) {
+    return side_mm(right_drive, right_middle);
 }
 
+const plan::Robot kRobot = {nullptr,
+                            vm_drive,
+                            vm_brake_drive,
+                            vm_rollers,
+                            vm_intake,
+                            vm_outake,
+                            vm_stop_all,
+                            vm_heading,
+                            plan::pros_millis,
+                            plan::pros_delay_until,
+                            vm_aborted,
+                            vm_left_mm,
+                            vm_right_mm,
+                            geometry::kTrackWidthMm,
+                            plan::pros_micros,
+                            plan::pros_overrun};
+
 bool draw_named_image(const std::string& name) {
-    return draw_bmp_from_sd(name.c_str(), 0, 0);
+    return g_image_cache.draw(name, 0, 0);
+}
+
+bool draw_builtin_run_image() {
+    return g_image_cache.draw_asset(kBuiltinRunName, cold_jerkbot_vbi.buf, cold_jerkbot_vbi.size, 0, 0);
+}
+
+void preload_ui_images() {
+    g_image_cache.preload(g_splash_image);
+    g_image_cache.preload(g_auton_image.empty() ? g_run_image : g_auton_image);
+    g_image_cache.preload(g_driver_image);
 }
 
 void show_run_image_once() {
     pros::screen::set_pen(0x00000000);
     pros::screen::fill_rect(0, 0, 479, 239);
     const std::string& img = g_auton_image.empty() ? g_run_image : g_auton_image;
-    draw_named_image(img);
+    if (!draw_named_image(img)) {
+        draw_builtin_run_image();
+    }
     pros::screen::set_pen(0x00000000);
     pros::screen::fill_rect(0, 220, 479, 239);
     pros::screen::set_pen(pros::c::COLOR_WHITE);
@@ -570,6 +334,9 @@ void show_init_splash() {
     pros::screen::fill_rect(0, 0, 479, 239);
 
     const bool loaded = draw_named_image(g_splash_image);
+    if (!loaded) {
+        draw_builtin_run_image();
+    }
     pros::screen::set_pen(pros::c::COLOR_WHITE);
     if (!loaded) {
         pros::screen::print(TEXT_MEDIUM, 10, 100, "SD image missing");
@@ -577,21 +344,29 @@ void show_init_splash() {
     pros::screen::print(TEXT_MEDIUM, 10, 210, "thanks tahera :)");
 }
 
-struct Rect {
-    int x;
-    int y;
-    int w;
-    int h;
-};
+ui::Rect slot_button(int slot) {
+    return {10 + slot * 160, 160, 140, 30};
+}
+
+// Over 15 s, or with steps outside plan::step_in_range().
+bool slot_has_warnings(int slot) {
+    const AutonSlot& s = g_slots[slot];
+    return s.bad_steps > 0 || s.gps_ms > static_cast<std::uint32_t>(kAutonMaxMs) ||
+           s.basic_ms > static_cast<std::uint32_t>(kAutonMaxMs);
+}
 
-bool hit_test(const Rect& r, int x, int y) {
-    return x >= r.x && x <= (r.x + r.w) && y >= r.y && y <= (r.y + r.h);
+const char* slot_status(int slot) {
+    if (!g_slots[slot].loaded) {
+        return "NONE";
+    }
+    return slot_has_warnings(slot) ? "WARN" : "OK";
 }
 
-void draw_button(const Rect& r, const char* label, std::uint32_t color) {
-    pros::screen::set_pen(color);
-    pros::screen::draw_rect(r.x, r.y, r.x + r.w, r.y + r.h);
-    pros::screen::print(TEXT_MEDIUM, r.x + 6, r.y + 8, label);
+std::uint32_t slot_color(int slot) {
+    if (!g_slots[slot].loaded) {
+        return 0x00808080;
+    }
+    return slot_has_warnings(slot) ? 0x00FFFF00 : 0x00FFFFFF;
 }
 
 void draw_brain_ui() {
@@ -602,18 +377,26 @@ void draw_brain_ui() {
     const Rect basic_btn{170, 10, 140, 30};
     const Rect run_btn{330, 10, 140, 30};
 
-    draw_button(gps_btn, "GPS", g_auton_mode == AutonMode::GPS_LEMLIB ? 0x0000FF00 : 0x00FFFFFF);
-    draw_button(basic_btn, "BASIC", g_auton_mode == AutonMode::NO_GPS ? 0x0000FF00 : 0x00FFFFFF);
-    draw_button(run_btn, g_auton_running ? "RUNNING" : "RUN", 0x00FF0000);
+    ui::draw_button(gps_btn, "GPS", g_auton_mode == AutonMode::GPS_LEMLIB ? 0x0000FF00 : 0x00FFFFFF);
+    ui::draw_button(basic_btn, "BASIC", g_auton_mode == AutonMode::NO_GPS ? 0x0000FF00 : 0x00FFFFFF);
+    ui::draw_button(run_btn, g_auton_running ? "RUNNING" : "RUN", 0x00FF0000);
+
+    const int active_slot = g_active_slot;
+    for (int i = 0; i < plan::kSlotCount; ++i) {
+        char label[16];
+        std::snprintf(label, sizeof(label), "SLOT %d %s", i + 1, slot_status(i));
+        ui::draw_button(slot_button(i), label, i == active_slot ? 0x0000FF00 : slot_color(i));
+    }
 
+    const AutonSlot& slot = g_slots[active_slot];
+    const bool gps_mode = g_auton_mode == AutonMode::GPS_LEMLIB;
+    const std::uint32_t estimate_ms = gps_mode ? slot.gps_ms : slot.basic_ms;
     pros::screen::set_pen(pros::c::COLOR_WHITE);
-    pros::screen::print(TEXT_MEDIUM, 10, 70, "AUTON: %s",
-                        g_auton_mode == AutonMode::GPS_LEMLIB ? "GPS" : "BASIC");
-    pros::screen::print(TEXT_MEDIUM, 10, 95, "SOURCE: %s",
-                        g_sd_plans_loaded ? "SD" : "BUILT-IN");
-    pros::screen::print(TEXT_MEDIUM, 10, 120, "SD: %s", g_sd_plans_loaded ? "OK" : "MISSING");
-    pros::screen::print(TEXT_MEDIUM, 10, 145, "SLOT: %d", g_active_slot + 1);
-    pros::screen::print(TEXT_MEDIUM, 10, 210, "Tap RUN to start auton");
+    pros::screen::print(TEXT_MEDIUM, 10, 70, "AUTON: %s", gps_mode ? "GPS" : "BASIC");
+    pros::screen::print(TEXT_MEDIUM, 10, 95, "SOURCE: %s", slot.loaded ? "SD" : "BUILT-IN");
+    pros::screen::print(TEXT_MEDIUM, 10, 120, "SLOT %d: ~%" PRIu32 ".%" PRIu32 " s, %zu bad steps",
+                        active_slot + 1, estimate_ms / 1000, estimate_ms % 1000 / 100, slot.bad_steps);
+    pros::screen::print(TEXT_MEDIUM, 10, 210, "Tap a SLOT, then RUN to start auton");
 }
 
 void brain_ui_loop() {
@@ -641,9 +424,16 @@ void brain_ui_loop() {
             const Rect basic_btn{170, 10, 140, 30};
             const Rect run_btn{330, 10, 140, 30};
 
-            if (hit_test(gps_btn, x, y)) g_auton_mode = AutonMode::GPS_LEMLIB;
-            if (hit_test(basic_btn, x, y)) g_auton_mode = AutonMode::NO_GPS;
-            if (hit_test(run_btn, x, y) && !g_auton_running) g_manual_auton_request = true;
+            if (ui::hit_test(gps_btn, x, y)) g_auton_mode = AutonMode::GPS_LEMLIB;
+            if (ui::hit_test(basic_btn, x, y)) g_auton_mode = AutonMode::NO_GPS;
+            if (ui::hit_test(run_btn, x, y) && !g_auton_running) g_manual_auton_request = true;
+            for (int i = 0; i < plan::kSlotCount; ++i) {
+                if (ui::hit_test(slot_button(i), x, y)) {
+                    g_auton_mutex.take();
+                    if (!g_auton_running) g_active_slot = i;
+                    g_auton_mutex.give();
+                }
+            }
 
             draw_brain_ui();
         }
@@ -671,119 +461,13 @@ void run_selected_auton() {
     g_auton_running = true;
     g_auton_end_ms = pros::millis() + kAutonMaxMs;
     g_auton_abort = false;
+    const AutonSlot& slot = g_slots[g_active_slot];
     g_auton_mutex.give();
     g_ui_locked = true;
     show_run_image_once();
 
-    if (g_auton_mode == AutonMode::GPS_LEMLIB) {
-        if (g_sd_plans_loaded && !gps_plan_sd.empty()) {
-            for (const auto& step : gps_plan_sd) {
-                if (auton_time_up()) break;
-                switch (step.type) {
-                    case StepType::EMPTY:
-                        break;
-                    case StepType::DRIVE_MS:
-                        drive_set(step.value1, step.value1);
-                        if (!delay_with_abort(step.value2)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        drive_brake();
-                        break;
-                    case StepType::TANK_MS:
-                        drive_set(step.value1, step.value2);
-                        if (!delay_with_abort(step.value3)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        drive_brake();
-                        break;
-                    case StepType::TURN_HEADING:
-                        turn_to_heading(step.value1, 60);
-                        break;
-                    case StepType::WAIT_MS:
-                        if (!delay_with_abort(step.value1)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        break;
-                    case StepType::INTAKE_ON:
-                        intake.move(127);
-                        outake.move(127);
-                        break;
-                    case StepType::INTAKE_OFF:
-                        intake.brake();
-                        outake.brake();
-                        break;
-                    case StepType::OUTTAKE_ON:
-                        intake.move(-127);
-                        outake.move(-127);
-                        break;
-                    case StepType::OUTTAKE_OFF:
-                        intake.brake();
-                        outake.brake();
-                        break;
-                }
-                if (auton_time_up()) break;
-            }
-        } else {
-            run_simple_auton_fallback();
-        }
-    } else {
-        if (g_sd_plans_loaded && !basic_plan_sd.empty()) {
-            for (const auto& step : basic_plan_sd) {
-                if (auton_time_up()) break;
-                switch (step.type) {
-                    case StepType::EMPTY:
-                        break;
-                    case StepType::DRIVE_MS:
-                        drive_set(step.value1, step.value1);
-                        if (!delay_with_abort(step.value2)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        drive_brake();
-                        break;
-                    case StepType::TANK_MS:
-                        drive_set(step.value1, step.value2);
-                        if (!delay_with_abort(step.value3)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        drive_brake();
-                        break;
-                    case StepType::TURN_HEADING:
-                        turn_to_heading(step.value1, 60);
-                        break;
-                    case StepType::WAIT_MS:
-                        if (!delay_with_abort(step.value1)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        break;
-                    case StepType::INTAKE_ON:
-                        intake.move(127);
-                        outake.move(127);
-                        break;
-                    case StepType::INTAKE_OFF:
-                        intake.brake();
-                        outake.brake();
-                        break;
-                    case StepType::OUTTAKE_ON:
-                        intake.move(-127);
-                        outake.move(-127);
-                        break;
-                    case StepType::OUTTAKE_OFF:
-                        intake.brake();
-                        outake.brake();
-                        break;
-                }
-                if (auton_time_up()) break;
-            }
-        } else {
-            run_simple_auton_fallback();
-        }
-    }
+    plan::run(g_auton_mode == AutonMode::GPS_LEMLIB ? slot.gps_program : slot.basic_program, kRobot,
+              g_auton_end_ms);
 
     stop_all_motors();
     g_auton_mutex.take();
@@ -825,151 +509,113 @@ void update_auton_mode_from_controller() {
     }
 }
 
-StepType parse_step_type(const std::string& token) {
-    if (token == "EMPTY") return StepType::EMPTY;
-    if (token == "DRIVE_MS") return StepType::DRIVE_MS;
-    if (token == "TANK_MS") return StepType::TANK_MS;
-    if (token == "TURN_HEADING") return StepType::TURN_HEADING;
-    if (token == "WAIT_MS") return StepType::WAIT_MS;
-    if (token == "INTAKE_ON") return StepType::INTAKE_ON;
-    if (token == "INTAKE_OFF") return StepType::INTAKE_OFF;
-    if (token == "OUTTAKE_ON") return StepType::OUTTAKE_ON;
-    if (token == "OUTTAKE_OFF") return StepType::OUTTAKE_OFF;
-    return StepType::EMPTY;
-}
-
-const char* slot_filename(int slot) {
-    switch (slot) {
-        case 0: return kSlot1File;
-        case 1: return kSlot2File;
-        case 2: return kSlot3File;
-        default: return kSlot1File;
-    }
-}
-
 int read_slot_from_sd() {
-    FILE* file = sd_open(kSlotIndexFile, "r");
+    FILE* file = sd::open(plan::kSlotIndexFile, "r");
     if (!file) {
         return 0;
     }
-    int slot = 1;
-    if (std::fscanf(file, "%d", &slot) != 1) {
+    const int slot = plan::read_slot(file);
+    std::fclose(file);
+    return slot;
+}
+
+bool load_slot_from(const char* filename, AutonSlot* slot) {
+    FILE* file = sd::open(filename, "r");
+    const bool loaded = plan::read_plans(file, &slot->gps, &slot->basic, filename);
+    if (file) {
         std::fclose(file);
-        return 0;
     }
-    std::fclose(file);
-    if (slot < 1 || slot > kSlotCount) {
-        return 0;
+    const std::size_t dropped = slot->gps.dropped() + slot->basic.dropped();
+    if (dropped > 0) {
+        std::printf("[plan] %s: %zu steps past the %zu-step limit were dropped\n", filename, dropped, kPlanCapacity);
     }
-    return slot - 1;
+    return loaded;
 }
 
-bool load_sd_plans_from(const char* filename) {
-    gps_plan_sd.clear();
-    basic_plan_sd.clear();
-
-    FILE* file = sd_open(filename, "r");
+// Everything the text loaders read, from one read of robot_config.bin.
+// False if there is no bundle or it fails its check; the caller then falls
+// back to the text files.
+bool load_config_bundle() {
+    FILE* file = sd::open(config::kBundleFile, "rb");
     if (!file) {
         return false;
     }
-
-    enum class Section { NONE, GPS, BASIC };
-    Section section = Section::NONE;
-
-    char line[128];
-    while (std::fgets(line, sizeof(line), file)) {
-        std::string s(line);
-        if (s.find("[GPS]") != std::string::npos) {
-            section = Section::GPS;
-            continue;
-        }
-        if (s.find("[BASIC]") != std::string::npos) {
-            section = Section::BASIC;
-            continue;
-        }
-        if (s.empty() || s[0] == '#') {
-            continue;
-        }
-
-        char type_str[32];
-        int v1 = 0;
-        int v2 = 0;
-        int v3 = 0;
-        const int fields = std::sscanf(s.c_str(), "%31[^,],%d,%d,%d", type_str, &v1, &v2, &v3);
-        if (fields >= 3) {
-            Step step{parse_step_type(type_str), v1, v2, v3};
-            if (section == Section::GPS) gps_plan_sd.push_back(step);
-            if (section == Section::BASIC) basic_plan_sd.push_back(step);
-        }
+    config::Config bundle;
+    const bool ok = config::read_bundle(file, &bundle);
+    std::fclose(file);
+    if (!ok) {
+        std::printf("[config] %s is damaged or from another version; using the text files\n", config::kBundleFile);
+        return false;
     }
 
-    std::fclose(file);
-    return !(gps_plan_sd.empty() && basic_plan_sd.empty());
+    apply_ui_images(bundle.images);
+    apply_controller_mapping(bundle.buttons);
+    g_active_slot = bundle.active_slot;
+    for (int i = 0; i < plan::kSlotCount; ++i) {
+        const config::SlotPlans& plans = bundle.slots[i];
+        g_slots[i].gps.assign(plans.gps.data(), plans.gps.size());
+        g_slots[i].basic.assign(plans.basic.data(), plans.basic.size());
+        g_slots[i].loaded = plans.loaded;
+    }
+    g_slots_from_bundle = true;
+    return true;
 }
 
-void load_sd_plans() {
+// Each slot falls back to auton_plans.txt, as config_compile does.
+void load_slots_from_sd() {
     g_active_slot = read_slot_from_sd();
-    const char* slot_file = slot_filename(g_active_slot);
-    if (load_sd_plans_from(slot_file)) {
-        g_sd_plans_loaded = true;
-        return;
-    }
-    if (load_sd_plans_from("auton_plans.txt")) {
-        g_sd_plans_loaded = true;
-        return;
+    for (int i = 0; i < plan::kSlotCount; ++i) {
+        AutonSlot& slot = g_slots[i];
+        slot.loaded = load_slot_from(plan::slot_filename(i), &slot) || load_slot_from(plan::kLegacyPlanFile, &slot);
     }
-    g_sd_plans_loaded = false;
 }
 
 // ======================================================
 // 2. HELPER FUNCTIONS
 // ======================================================
 
-void turn_to_heading(double target, int max_speed) {
-    while (true) {
-        if (auton_time_up()) break;
-        double current = imu.get_heading();
-        double error = target - current;
-
-        if (error > 180) error -= 360;
-        if (error < -180) error += 360;
-
-        if (std::abs(error) < 2.0) break;
-
-        double kp = 1.5; 
-        int speed = error * kp;
-
-        if (speed > max_speed) speed = max_speed;
-        if (speed < -max_speed) speed = -max_speed;
-
-        drive_set(speed, -speed);
-        pros::delay(20);
+void compile_plan(const plan::PlanBuffer& steps, bool loaded, std::vector<plan::Instr>* program) {
+    if (loaded && !steps.empty()) {
+        plan::compile(steps.data(), steps.size(), program);
+    } else {
+        plan::compile(kFallbackPlan, std::size(kFallbackPlan), program);
     }
-    drive_brake();
 }
 
-void run_simple_auton_fallback() {
-    drive_set(60, 60);
-    if (!delay_with_abort(1500)) {
-        stop_all_motors();
-        return;
-    }
-
-    drive_brake();
-    if (!delay_with_abort(100)) {
-        stop_all_motors();
-        return;
+std::size_t count_bad_steps(const plan::PlanBuffer& steps) {
+    std::size_t bad = 0;
+    for (std::size_t i = 0; i < steps.size(); ++i) {
+        bad += plan::step_in_range(steps[i]) ? 0 : 1;
     }
+    return bad;
+}
 
-    turn_to_heading(90, 60);
+void prepare_slot(int index) {
+    AutonSlot& slot = g_slots[index];
+    compile_plan(slot.gps, slot.loaded, &slot.gps_program);
+    compile_plan(slot.basic, slot.loaded, &slot.basic_program);
+    slot.bad_steps = slot.loaded ? count_bad_steps(slot.gps) + count_bad_steps(slot.basic) : 0;
+    slot.gps_ms = plan::estimate_ms(slot.gps_program);
+    slot.basic_ms = plan::estimate_ms(slot.basic_program);
+    std::printf("[plan] slot %d: %s, GPS %zu steps ~%" PRIu32 " ms, BASIC %zu steps ~%" PRIu32
+                " ms, %zu bad steps%s\n",
+                index + 1, slot.loaded ? "SD" : "built-in", slot.gps.size(), slot.gps_ms, slot.basic.size(),
+                slot.basic_ms, slot.bad_steps, slot_has_warnings(index) ? " (check it)" : "");
+}
 
-    drive_set(-40, -40);
-    if (!delay_with_abort(500)) {
-        stop_all_motors();
-        return;
+// Reads (unless the bundle already filled them), checks and compiles all
+// slots while initialize() shows the splash and calibrates the IMU.
+void slot_loader_task_fn(void*) {
+    const std::uint32_t start_us = pros::micros();
+    if (!g_slots_from_bundle) {
+        load_slots_from_sd();
     }
-
-    drive_brake();
+    for (int i = 0; i < plan::kSlotCount; ++i) {
+        prepare_slot(i);
+    }
+    const std::uint32_t load_us = pros::micros() - start_us;
+    std::printf("[plan] %d slots ready in %" PRIu32 " us\n", plan::kSlotCount, load_us);
+    g_slots_ready = true;
 }
 
 // ======================================================
@@ -977,27 +623,50 @@ void run_simple_auton_fallback() {
 // ======================================================
 
 void initialize() {
+    const std::uint32_t boot_start_us = pros::micros();
     pros::lcd::initialize();
-    load_ui_images();
-    load_controller_mapping_from_sd();
+    const bool from_bundle = load_config_bundle();
+    if (!from_bundle) {
+        load_ui_images();
+        load_controller_mapping_from_sd();
+    }
+    const std::uint32_t config_us = pros::micros() - boot_start_us;
+    static pros::Task slot_loader(slot_loader_task_fn, nullptr, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT,
+                                  "TaheraSlots");
+    preload_ui_images();
     show_init_splash();
     pros::delay(kSplashHoldMs);
+    left_drive.set_encoder_units_all(pros::v5::MotorUnits::degrees);
+    right_drive.set_encoder_units_all(pros::v5::MotorUnits::degrees);
+    left_middle.set_encoder_units(pros::v5::MotorUnits::degrees);
+    right_middle.set_encoder_units(pros::v5::MotorUnits::degrees);
+    const std::uint32_t imu_start_ms = pros::millis();
     imu.reset(true);
     while (imu.is_calibrating()) {
         pros::delay(10);
     }
-    load_sd_plans();
-    if (!g_sd_plans_loaded) {
-        pros::lcd::print(0, "SD plans: MISSING");
-    } else {
-        pros::lcd::print(0, "SD plans: OK");
+    const std::uint32_t imu_ms = pros::millis() - imu_start_ms;
+    while (!g_slots_ready) {
+        pros::delay(5);
     }
+    pros::lcd::print(0, "SD plans: %s %s %s", slot_status(0), slot_status(1), slot_status(2));
+    sd::log_stats();
+    const std::uint32_t boot_ms = (pros::micros() - boot_start_us) / 1000;
+    std::printf("[boot] ready in %" PRIu32 " ms: config %" PRIu32 " us from %s, splash %d ms, imu %" PRIu32 " ms\n",
+                boot_ms, config_us, from_bundle ? config::kBundleFile : "text files", kSplashHoldMs, imu_ms);
+    pros::lcd::print(1, "Boot: %" PRIu32 " ms (config %" PRIu32 " us)", boot_ms, config_us);
     static pros::Task brain_ui_task(brain_ui_task_fn, nullptr, TASK_PRIORITY_DEFAULT,
                                     TASK_STACK_DEPTH_DEFAULT, "TaheraUI");
     static pros::Task auton_watchdog(auton_watchdog_task_fn, nullptr, TASK_PRIORITY_DEFAULT,
                                      TASK_STACK_DEPTH_DEFAULT, "TaheraWatch");
 }
 
+// The slots are already loaded; this is where the drive team picks one.
+void competition_initialize() {
+    g_show_selection_ui = true;
+    draw_brain_ui();
+}
+
 void autonomous() {
     g_force_driver_image = false;
     run_selected_auton();
@@ -0,0 +1,203 @@
+// Times the brain's BMP downscalers on the host: the old nearest-neighbor
+// row/column sampling vs the AreaScaler box filter from image_decoder.
+//
+// Usage:
+//   bmp_scale_bench [-n iterations] [-o out_prefix] <image.bmp>
+//
+// Only the pixel work is timed; the file is read into memory first. With
+// -o, both results are written as <out_prefix>_nearest.bmp and
+// <out_prefix>_area.bmp for a side-by-side look.
+
+#include "bonkers/area_scaler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int kScreenW = 480;
+constexpr int kScreenH = 240;
+
+struct Bmp {
+    std::vector<std::uint8_t> bytes;
+    std::uint32_t data_offset = 0;
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+    bool top_down = false;
+    int bytes_per_pixel = 0;
+    std::uint32_t row_size = 0;
+};
+
+std::uint32_t read_u32(const std::vector<std::uint8_t>& b, std::size_t off) {
+    return static_cast<std::uint32_t>(b[off]) | (static_cast<std::uint32_t>(b[off + 1]) << 8) |
+           (static_cast<std::uint32_t>(b[off + 2]) << 16) | (static_cast<std::uint32_t>(b[off + 3]) << 24);
+}
+
+bool load_bmp(const char* path, Bmp* out) {
+    std::ifstream in(path, std::ios::binary);
+    out->bytes.assign((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const auto& b = out->bytes;
+    if (b.size() < 54 || b[0] != 'B' || b[1] != 'M') {
+        return false;
+    }
+    const std::uint16_t bpp = static_cast<std::uint16_t>(b[28] | (b[29] << 8));
+    const std::int32_t raw_height = static_cast<std::int32_t>(read_u32(b, 22));
+    out->data_offset = read_u32(b, 10);
+    out->width = static_cast<std::int32_t>(read_u32(b, 18));
+    out->top_down = raw_height < 0;
+    out->height = out->top_down ? -raw_height : raw_height;
+    out->bytes_per_pixel = bpp / 8;
+    out->row_size = ((static_cast<std::uint32_t>(out->bytes_per_pixel) * out->width + 3) / 4) * 4;
+    if ((bpp != 24 && bpp != 32) || out->width <= 0 || out->height == 0) {
+        return false;
+    }
+    return out->data_offset + static_cast<std::uint64_t>(out->row_size) * out->height <= b.size();
+}
+
+const std::uint8_t* file_row(const Bmp& bmp, std::int32_t row_idx) {
+    return bmp.bytes.data() + bmp.data_offset + static_cast<std::size_t>(row_idx) * bmp.row_size;
+}
+
+// The loop decode_bmp used before the area filter, minus the fread.
+void scale_nearest(const Bmp& bmp, int target_w, int target_h, std::vector<std::uint32_t>* out) {
+    int last_target_row = -1;
+    for (std::int32_t row_idx = 0; row_idx < bmp.height; ++row_idx) {
+        const std::uint8_t* row = file_row(bmp, row_idx);
+        const std::int32_t draw_y = bmp.top_down ? row_idx : (bmp.height - 1 - row_idx);
+        const int target_row = (draw_y * target_h) / bmp.height;
+        if (target_row == last_target_row) {
+            continue;
+        }
+        last_target_row = target_row;
+
+        std::uint32_t* dst = out->data() + static_cast<std::size_t>(target_row) * target_w;
+        for (int col = 0; col < target_w; ++col) {
+            const int src_x = (col * bmp.width) / target_w;
+            const std::size_t idx = static_cast<std::size_t>(src_x) * bmp.bytes_per_pixel;
+            dst[col] = (static_cast<std::uint32_t>(row[idx + 2]) << 16) |
+                       (static_cast<std::uint32_t>(row[idx + 1]) << 8) | row[idx];
+        }
+    }
+}
+
+void scale_area(const Bmp& bmp, int target_w, int target_h, std::vector<std::uint32_t>* out) {
+    image::AreaScaler scaler(bmp.width, bmp.height, target_w, target_h);
+    int current = -1;
+    for (std::int32_t row_idx = 0; row_idx < bmp.height; ++row_idx) {
+        const std::int32_t draw_y = bmp.top_down ? row_idx : (bmp.height - 1 - row_idx);
+        const int target_row = scaler.target_row(draw_y);
+        if (target_row != current && scaler.pending()) {
+            scaler.flush(out->data() + static_cast<std::size_t>(current) * target_w);
+        }
+        current = target_row;
+        if (bmp.bytes_per_pixel == 4) {
+            scaler.add_bgr32(file_row(bmp, row_idx));
+        } else {
+            scaler.add_bgr24(file_row(bmp, row_idx));
+        }
+    }
+    if (scaler.pending()) {
+        scaler.flush(out->data() + static_cast<std::size_t>(current) * target_w);
+    }
+}
+
+template <typename Fn>
+double time_ms(int iterations, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+void write_bmp(const std::string& path, const std::vector<std::uint32_t>& pixels, int w, int h) {
+    const std::uint32_t row_size = static_cast<std::uint32_t>(w) * 3;
+    const std::uint32_t data_size = row_size * h;
+    std::uint8_t header[54] = {'B', 'M'};
+    auto put32 = [&header](int off, std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) header[off + i] = static_cast<std::uint8_t>(v >> (8 * i));
+    };
+    put32(2, 54 + data_size);
+    put32(10, 54);
+    put32(14, 40);
+    put32(18, static_cast<std::uint32_t>(w));
+    put32(22, static_cast<std::uint32_t>(-h));
+    header[26] = 1;
+    header[28] = 24;
+    put32(34, data_size);
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    std::vector<std::uint8_t> row(row_size);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            const std::uint32_t p = pixels[static_cast<std::size_t>(y) * w + x];
+            row[x * 3] = static_cast<std::uint8_t>(p);
+            row[x * 3 + 1] = static_cast<std::uint8_t>(p >> 8);
+            row[x * 3 + 2] = static_cast<std::uint8_t>(p >> 16);
+        }
+        out.write(reinterpret_cast<const char*>(row.data()), row_size);
+    }
+}
+
+void usage() {
+    std::fprintf(stderr, "usage: bmp_scale_bench [-n iterations] [-o out_prefix] <image.bmp>\n");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = 20;
+    std::string out_prefix;
+    const char* input = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_prefix = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 2;
+        } else {
+            input = argv[i];
+        }
+    }
+    if (!input) {
+        usage();
+        return 2;
+    }
+
+    Bmp bmp;
+    if (!load_bmp(input, &bmp)) {
+        std::fprintf(stderr, "%s: not a 24/32-bit uncompressed BMP\n", input);
+        return 1;
+    }
+    const int target_w = std::min<int>(bmp.width, kScreenW);
+    const int target_h = std::min<int>(bmp.height, kScreenH);
+    if (target_w == bmp.width && target_h == bmp.height) {
+        std::fprintf(stderr, "%s: %dx%d already fits the screen; nothing to scale\n", input, bmp.width, bmp.height);
+        return 1;
+    }
+
+    std::vector<std::uint32_t> nearest(static_cast<std::size_t>(target_w) * target_h);
+    std::vector<std::uint32_t> area(nearest.size());
+    const double nearest_ms = time_ms(iterations, [&] { scale_nearest(bmp, target_w, target_h, &nearest); });
+    const double area_ms = time_ms(iterations, [&] { scale_area(bmp, target_w, target_h, &area); });
+
+    std::printf("%s: %dx%d %d-bit -> %dx%d, %d iterations\n", input, bmp.width, bmp.height,
+                bmp.bytes_per_pixel * 8, target_w, target_h, iterations);
+    std::printf("  nearest  %8.3f ms/image\n", nearest_ms);
+    std::printf("  area     %8.3f ms/image (%.2fx)\n", area_ms, area_ms / nearest_ms);
+
+    if (!out_prefix.empty()) {
+        write_bmp(out_prefix + "_nearest.bmp", nearest, target_w, target_h);
+        write_bmp(out_prefix + "_area.bmp", area, target_w, target_h);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Converts Basic Bonkers binary controller logs to the CSV the field replay
+// tools load (bonkers_log_to_field.py and both desktop apps).
+//
+// Usage:
+//   bonkers_log_decode [-t] [-o out.csv] <bonkers_log_XXXX.bbl>...
+//
+// Each log is written next to itself with a .csv extension unless -o is
+// given (only valid with a single input). "-" as the output writes stdout.
+//
+// Decoding keeps every frame up to the first torn or damaged one, so logs
+// cut short by a power loss or card pull still convert. With -t the .bbl
+// itself is truncated just past that frame, which also drops the unused
+// preallocated space.
+
+#include "bonkers/log_format.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+std::string csv_path_for(const std::string& path) {
+    const std::size_t dot = path.find_last_of('.');
+    const std::size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path + ".csv";
+    }
+    return path.substr(0, dot) + ".csv";
+}
+
+bool decode(const std::string& in_path, const std::string& out_path, bool truncate) {
+    FILE* in = std::fopen(in_path.c_str(), "rb");
+    if (!in) {
+        std::fprintf(stderr, "%s: cannot open\n", in_path.c_str());
+        return false;
+    }
+    const bool to_stdout = out_path == "-";
+    FILE* out = to_stdout ? stdout : std::fopen(out_path.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "%s: cannot create\n", out_path.c_str());
+        std::fclose(in);
+        return false;
+    }
+
+    ctrl_log::ScanStats stats{};
+    const bool ok = ctrl_log::decode_csv(in, out, &stats);
+    std::fclose(in);
+    if (!to_stdout) {
+        std::fclose(out);
+    }
+    if (!ok) {
+        std::fprintf(stderr, "%s: not a Basic Bonkers binary log\n", in_path.c_str());
+        if (!to_stdout) {
+            std::remove(out_path.c_str());
+        }
+        return false;
+    }
+
+    std::fprintf(stderr, "%s: %u samples in %u frames, %s", in_path.c_str(), static_cast<unsigned>(stats.samples),
+                 static_cast<unsigned>(stats.frames), ctrl_log::end_name(stats.end));
+    if (stats.dropped > 0) {
+        std::fprintf(stderr, ", %u dropped on the brain", static_cast<unsigned>(stats.dropped));
+    }
+    if (stats.tail_bytes > 0) {
+        std::fprintf(stderr, ", %u bytes after the last good frame", static_cast<unsigned>(stats.tail_bytes));
+    }
+    std::fprintf(stderr, " -> %s\n", to_stdout ? "stdout" : out_path.c_str());
+
+    if (truncate && stats.tail_bytes > 0) {
+        std::error_code error;
+        std::filesystem::resize_file(in_path, stats.good_bytes, error);
+        if (error) {
+            std::fprintf(stderr, "%s: truncate failed: %s\n", in_path.c_str(), error.message().c_str());
+            return false;
+        }
+        std::fprintf(stderr, "%s: truncated to %u bytes\n", in_path.c_str(), static_cast<unsigned>(stats.good_bytes));
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string out_path;
+    bool truncate = false;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-t") == 0) {
+            truncate = true;
+        } else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (inputs.empty() || (!out_path.empty() && inputs.size() > 1)) {
+        std::fprintf(stderr, "usage: bonkers_log_decode [-t] [-o out.csv] <log.bbl>...\n");
+        return 2;
+    }
+
+    int failures = 0;
+    for (const std::string& input : inputs) {
+        failures += decode(input, out_path.empty() ? csv_path_for(input) : out_path, truncate) ? 0 : 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
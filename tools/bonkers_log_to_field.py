@@ -7,6 +7,10 @@ Usage:
 
 Outputs:
   field_replay.html (in the same folder as the log unless --output is set)
+
+Logs decoded from a telemetry capture (left_rpm/right_rpm/heading_deg
+columns) are replayed from the measured wheel speeds and IMU heading;
+otherwise the stick commands are integrated.
 """
 
 import argparse
@@ -19,6 +23,8 @@ DEFAULT_FIELD_SIZE_IN = 144.0  # 12 ft VEX field
 DEFAULT_TRACK_WIDTH_IN = 12.0
 DEFAULT_MAX_SPEED_IN_PER_S = 60.0
 DEFAULT_DT_S = 0.02
+DEFAULT_WHEEL_DIAMETER_IN = 3.25
+DEFAULT_GEAR_RATIO = 1.0  # wheel turns per motor turn
 
 
 def _parse_float(value, default=None):
@@ -37,10 +43,11 @@ def load_rows(path):
     return rows
 
 
-def integrate(rows, field_size_in, track_width_in, max_speed_in_s):
+def integrate(rows, field_size_in, track_width_in, max_speed_in_s, inches_per_motor_rev):
     x = field_size_in / 2.0
     y = field_size_in / 2.0
     theta = 0.0
+    heading0 = None
 
     poses = []
     last_t = None
@@ -59,15 +66,29 @@ def integrate(rows, field_size_in, track_width_in, max_speed_in_s):
         left_cmd = _parse_float(row.get("left_cmd"), 0.0)
         right_cmd = _parse_float(row.get("right_cmd"), 0.0)
 
-        v_l = (left_cmd / 100.0) * max_speed_in_s
-        v_r = (right_cmd / 100.0) * max_speed_in_s
+        left_rpm = _parse_float(row.get("left_rpm"), None)
+        right_rpm = _parse_float(row.get("right_rpm"), None)
+        if left_rpm is not None and right_rpm is not None:
+            v_l = left_rpm / 60.0 * inches_per_motor_rev
+            v_r = right_rpm / 60.0 * inches_per_motor_rev
+        else:
+            v_l = (left_cmd / 100.0) * max_speed_in_s
+            v_r = (right_cmd / 100.0) * max_speed_in_s
         v = (v_l + v_r) / 2.0
         omega = (v_r - v_l) / track_width_in
 
+        # The IMU heading is clockwise-positive; the field frame is not.
+        heading = _parse_float(row.get("heading_deg"), None)
+        if heading is not None and heading0 is None:
+            heading0 = heading
+
         if dt > 0:
+            if heading is not None:
+                theta = -math.radians(heading - heading0)
+            else:
+                theta += omega * dt
             x += v * math.cos(theta) * dt
             y += v * math.sin(theta) * dt
-            theta += omega * dt
 
         poses.append(
             {
@@ -268,9 +289,9 @@ def build_html(poses, field_size_in, title):
 
     function updateReadout(pose) {{
       readout.textContent =
-        `t=${pose.t.toFixed(2)}s  x=${pose.x.toFixed(1)}in  y=${pose.y.toFixed(1)}in\n` +
-        `left=${pose.left_cmd.toFixed(0)}  right=${pose.right_cmd.toFixed(0)}\n` +
-        `intake=${pose.intake_action}  outtake=${pose.outtake_action}`;
+        `t=${{pose.t.toFixed(2)}}s  x=${{pose.x.toFixed(1)}}in  y=${{pose.y.toFixed(1)}}in\n` +
+        `left=${{pose.left_cmd.toFixed(0)}}  right=${{pose.right_cmd.toFixed(0)}}\n` +
+        `intake=${{pose.intake_action}}  outtake=${{pose.outtake_action}}`;
     }}
 
     function draw(i) {{
@@ -345,10 +366,13 @@ def main():
     parser.add_argument("--field-size", type=float, default=DEFAULT_FIELD_SIZE_IN)
     parser.add_argument("--track-width", type=float, default=DEFAULT_TRACK_WIDTH_IN)
     parser.add_argument("--max-speed", type=float, default=DEFAULT_MAX_SPEED_IN_PER_S)
+    parser.add_argument("--wheel-diameter", type=float, default=DEFAULT_WHEEL_DIAMETER_IN)
+    parser.add_argument("--gear-ratio", type=float, default=DEFAULT_GEAR_RATIO)
     args = parser.parse_args()
 
     rows = load_rows(args.log)
-    poses = integrate(rows, args.field_size, args.track_width, args.max_speed)
+    inches_per_motor_rev = math.pi * args.wheel_diameter * args.gear_ratio
+    poses = integrate(rows, args.field_size, args.track_width, args.max_speed, inches_per_motor_rev)
 
     title = os.path.basename(args.log)
     html = build_html(poses, args.field_size, f"Bonkers Field Replay - {title}")
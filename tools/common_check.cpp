@@ -0,0 +1,326 @@
+// Checks the Bonkers_Common file helpers the brain programs load their
+// microSD files with: the text helpers and LineReader, plan::read_plans and
+// write_plans (including the slot files old Auton Planner builds saved with
+// a literal "\n" between records), auton_slot.txt, robot_config.bin with
+// every slot full, and sd::open's prefix probing and caching against a card
+// faked in a temporary directory.
+//
+// Usage:
+//   common_check
+//
+// Prints each failed check and exits non-zero if there was one.
+
+#include "bonkers/config_bundle.hpp"
+#include "bonkers/plan.hpp"
+#include "bonkers/sd_path.hpp"
+#include "bonkers/text.hpp"
+#include "pros_stub.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+using plan::Step;
+using plan::StepType;
+
+int g_failures = 0;
+
+void expect(bool ok, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++g_failures;
+    }
+}
+
+// A FILE holding `contents`, rewound for reading.
+FILE* file_with(const std::string& contents) {
+    FILE* file = std::tmpfile();
+    std::fwrite(contents.data(), 1, contents.size(), file);
+    std::rewind(file);
+    return file;
+}
+
+std::string read_back(FILE* file) {
+    std::rewind(file);
+    std::string contents;
+    char chunk[256];
+    std::size_t got = 0;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        contents.append(chunk, got);
+    }
+    return contents;
+}
+
+bool same_steps(const std::vector<Step>& a, const std::vector<Step>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].type != b[i].type || a[i].value1 != b[i].value1 || a[i].value2 != b[i].value2 ||
+            a[i].value3 != b[i].value3) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parse(const std::string& contents, std::vector<Step>* gps, std::vector<Step>* basic) {
+    FILE* file = file_with(contents);
+    const bool ok = plan::read_plans(file, gps, basic, "check");
+    std::fclose(file);
+    return ok;
+}
+
+void check_text() {
+    expect(text::starts_with("usd/Images/a.bmp", "usd/"), "starts_with matches a prefix");
+    expect(!text::starts_with("us", "usd/"), "starts_with rejects a shorter string");
+    expect(!text::starts_with(nullptr, "usd/"), "starts_with rejects null");
+    expect(text::ends_with_ci("SPLASH.BMP", ".bmp"), "ends_with_ci ignores case");
+    expect(!text::ends_with_ci("bmp", ".bmp"), "ends_with_ci rejects a shorter string");
+
+    char line[] = "DRIVE_MS,1,2\r\n";
+    text::chomp_line(line);
+    expect(std::strcmp(line, "DRIVE_MS,1,2") == 0, "chomp_line strips CR and LF");
+
+    // A BOM is skipped, CRLF endings are stripped, and a line longer than
+    // the buffer is cut with the rest of it skipped.
+    FILE* file = file_with("\xEF\xBB\xBF" "first\r\n0123456789abcdef\nlast");
+    char buffer[8];
+    text::LineReader reader(file, buffer, sizeof(buffer));
+    char* first = reader.next();
+    expect(first && std::strcmp(first, "first") == 0 && !reader.cut(), "LineReader skips the BOM and CR");
+    char* long_line = reader.next();
+    expect(long_line && std::strcmp(long_line, "0123456") == 0 && reader.cut(), "LineReader cuts long lines");
+    char* last = reader.next();
+    expect(last && std::strcmp(last, "last") == 0 && reader.line() == 3 && !reader.cut(),
+           "LineReader resumes after a cut line");
+    expect(reader.next() == nullptr, "LineReader ends at EOF");
+    std::fclose(file);
+
+    char numbers[] = " -42, 99999999999 ,x";
+    text::Cursor cursor(numbers);
+    int value = 0;
+    expect(cursor.integer(&value) && value == -42, "Cursor reads a signed integer");
+    expect(cursor.consume(',') && cursor.integer(&value) && value == 2147483647, "Cursor clamps large integers");
+    expect(cursor.consume(',') && !cursor.integer(&value), "Cursor rejects non-numbers");
+}
+
+void check_plans() {
+    const std::vector<Step> gps = {{StepType::DRIVE_MS, 80, 1200, 0},
+                                   {StepType::PARALLEL, 0, 0, 0},
+                                   {StepType::INTAKE_FOR_MS, 127, 800, 200},
+                                   {StepType::END_PARALLEL, 0, 0, 0},
+                                   {StepType::DRIVE_DIST, -600, 100, 0}};
+    const std::vector<Step> basic = {{StepType::TANK_MS, -50, 60, 700}, {StepType::EMPTY, 0, 0, 0}};
+
+    FILE* file = std::tmpfile();
+    expect(plan::write_plans(file, gps.data(), gps.size(), basic.data(), basic.size()), "write_plans succeeds");
+    const std::string written = read_back(file);
+    std::fclose(file);
+    std::vector<Step> gps_read;
+    std::vector<Step> basic_read;
+    expect(parse(written, &gps_read, &basic_read), "written plans read back");
+    expect(same_steps(gps, gps_read) && same_steps(basic, basic_read), "plans round-trip through a file");
+
+    // Old Auton Planner builds wrote every record on one line, separated by
+    // a literal backslash-n. Such a file loads the same steps, and writing
+    // it back out gives the current format.
+    std::string legacy;
+    for (std::size_t i = 0; i < written.size(); ++i) {
+        legacy += written[i] == '\n' ? std::string("\\n") : std::string(1, written[i]);
+    }
+    expect(legacy.find('\n') == std::string::npos, "legacy slot file is one line");
+    expect(parse(legacy, &gps_read, &basic_read), "legacy slot file loads");
+    expect(same_steps(gps, gps_read) && same_steps(basic, basic_read), "legacy slot file loads the same steps");
+    file = std::tmpfile();
+    plan::write_plans(file, gps_read.data(), gps_read.size(), basic_read.data(), basic_read.size());
+    expect(read_back(file) == written, "legacy slot file is rewritten in the current format");
+    std::fclose(file);
+
+    // Comments, blank lines, unknown types and stray steps.
+    expect(parse("# saved by hand\n\n[GPS]\n# drive\nWAIT_MS,500,0,0\n  # indented\n[BASIC]\nBOGUS,1,2,3\n",
+                 &gps_read, &basic_read),
+           "commented plan loads");
+    expect(gps_read.size() == 1 && gps_read[0].type == StepType::WAIT_MS && gps_read[0].value1 == 500,
+           "comments and blank lines are skipped");
+    expect(basic_read.size() == 1 && basic_read[0].type == StepType::EMPTY, "unknown step types load as EMPTY");
+    expect(parse("DRIVE_MS,1,2,0\n[GPS]\nDRIVE_MS,3,4\n", &gps_read, &basic_read) && gps_read.size() == 1 &&
+               gps_read[0].value1 == 3 && gps_read[0].value3 == 0,
+           "steps before a section are skipped and value3 defaults to 0");
+    expect(!parse("# nothing\n[GPS]\n[BASIC]\n", &gps_read, &basic_read) && gps_read.empty() && basic_read.empty(),
+           "a plan with no steps is rejected");
+    expect(!plan::read_plans(nullptr, &gps_read, &basic_read), "a missing plan file is rejected");
+}
+
+int slot_of(const char* contents) {
+    FILE* file = file_with(contents);
+    const int slot = plan::read_slot(file);
+    std::fclose(file);
+    return slot;
+}
+
+void check_slots() {
+    expect(slot_of("2\n") == 1, "auton_slot.txt is 1-based");
+    expect(slot_of(" 3") == 2, "auton_slot.txt allows leading spaces");
+    expect(slot_of("0") == 0 && slot_of("4") == 0 && slot_of("-1") == 0, "out-of-range slots fall back to 0");
+    expect(slot_of("two") == 0 && slot_of("") == 0, "unreadable slots fall back to 0");
+    expect(plan::read_slot(nullptr) == 0, "a missing slot file falls back to 0");
+    for (int slot = 0; slot < plan::kSlotCount; ++slot) {
+        FILE* file = std::tmpfile();
+        plan::write_slot(file, slot);
+        std::rewind(file);
+        expect(plan::read_slot(file) == slot, "slots round-trip through auton_slot.txt");
+        std::fclose(file);
+    }
+    expect(std::strcmp(plan::slot_filename(1), "auton_plans_slot2.txt") == 0 &&
+               std::strcmp(plan::slot_filename(7), plan::slot_filename(0)) == 0,
+           "slot file names");
+}
+
+void check_bundle() {
+    config::Config full;
+    config::default_buttons(full.buttons);
+    full.active_slot = 2;
+    full.images.flags = config::kHasSplash;
+    full.images.splash = std::string(255, 's');
+    for (config::SlotPlans& slot : full.slots) {
+        slot.loaded = true;
+        for (std::size_t i = 0; i < plan::kPlanCapacity; ++i) {
+            const int value = static_cast<int>(i);
+            slot.gps.push_back({StepType::TANK_MS, -value, value, 0x7FFFFFFF});
+            slot.basic.push_back({StepType::ARC, value, -value, 0});
+        }
+    }
+    std::vector<std::uint8_t> bytes;
+    expect(config::encode_bundle(full, &bytes), "a bundle with every slot full encodes");
+    FILE* file = std::tmpfile();
+    expect(config::write_bundle(file, bytes), "a full bundle writes");
+    config::Config loaded;
+    expect(config::read_bundle(file, &loaded), "a full bundle reads back");
+    std::fclose(file);
+    bool same = loaded.active_slot == 2 && loaded.images.splash == full.images.splash;
+    for (int i = 0; i < plan::kSlotCount; ++i) {
+        same = same && loaded.slots[i].loaded && same_steps(loaded.slots[i].gps, full.slots[i].gps) &&
+               same_steps(loaded.slots[i].basic, full.slots[i].basic);
+    }
+    expect(same, "a full bundle round-trips");
+
+    config::Config over = full;
+    over.slots[1].basic.push_back({StepType::WAIT_MS, 1, 0, 0});
+    expect(!config::encode_bundle(over, &bytes), "a plan past kPlanCapacity does not encode");
+    over = full;
+    over.images.driver = std::string(256, 'd');
+    expect(!config::encode_bundle(over, &bytes), "an image name past 255 bytes does not encode");
+    over = full;
+    over.active_slot = plan::kSlotCount;
+    expect(!config::encode_bundle(over, &bytes), "an out-of-range active slot does not encode");
+}
+
+void write_file(const fs::path& path, const char* contents) {
+    fs::create_directories(path.parent_path());
+    std::ofstream(path) << contents;
+}
+
+std::string read_name(const char* name) {
+    FILE* file = sd::open(name, "r");
+    if (!file) {
+        return "";
+    }
+    char line[64] = {0};
+    std::fgets(line, sizeof(line), file);
+    std::fclose(file);
+    return line;
+}
+
+// The stub card is the current directory: "usd/..." and bare names exist
+// there, "/usd/..." never does on the host.
+void check_sd() {
+    const fs::path home = fs::current_path();
+    const fs::path card = fs::temp_directory_path() / "bonkers_common_check";
+    fs::remove_all(card);
+    fs::create_directories(card);
+    fs::current_path(card);
+    sd::reset();
+
+    write_file(card / "usd" / "Images" / "splash.bmp", "images");
+    write_file(card / "usd" / "both.txt", "usd");
+    write_file(card / "usd" / "Images" / "both.txt", "images");
+    write_file(card / "here.txt", "bare");
+    write_file(card / "usd" / "here.txt", "usd");
+
+    std::uint32_t calls = sd::stats().fopen_calls;
+    expect(read_name("splash.bmp") == "images", "a name is found under usd/Images/");
+    // "", "/usd/", "usd/", "/usd/Images/", "/usd/images/", then "usd/Images/".
+    expect(sd::stats().fopen_calls - calls == 6, "prefixes are probed in order until one opens");
+    calls = sd::stats().fopen_calls;
+    const std::uint32_t hits = sd::stats().cache_hits;
+    expect(read_name("splash.bmp") == "images", "a found name opens again");
+    expect(sd::stats().fopen_calls - calls == 1 && sd::stats().cache_hits - hits == 1,
+           "a found name opens with its remembered prefix");
+
+    expect(read_name("both.txt") == "usd", "usd/ is tried before usd/Images/");
+    expect(read_name("here.txt") == "bare", "a bare name is tried before any prefix");
+    expect(read_name("usd/both.txt") == "usd", "names spelled with usd/ open as given");
+
+    calls = sd::stats().fopen_calls;
+    expect(read_name("missing.txt").empty(), "a missing name does not open");
+    // Every prefix but "/", which only applies to names spelled "usd/...".
+    expect(sd::stats().fopen_calls - calls == 7, "a missing name is probed with every prefix once");
+    calls = sd::stats().fopen_calls;
+    const std::uint32_t misses = sd::stats().cached_misses;
+    expect(read_name("missing.txt").empty(), "a missing name stays missing");
+    expect(sd::stats().fopen_calls == calls && sd::stats().cached_misses - misses == 1,
+           "a missing name is refused from the cache without an fopen");
+
+    // Writing a name remembered as missing creates it and clears the miss.
+    FILE* file = sd::open("missing.txt", "w");
+    expect(file != nullptr, "a missing name can be written");
+    if (file) {
+        std::fputs("written", file);
+        std::fclose(file);
+    }
+    expect(read_name("missing.txt") == "written", "a written name reads back");
+
+    // A file that appears behind the cache's back is only seen after reset().
+    expect(read_name("late.txt").empty(), "late.txt starts missing");
+    write_file(card / "usd" / "late.txt", "late");
+    expect(read_name("late.txt").empty(), "a cached miss hides a file added later");
+    sd::reset();
+    expect(read_name("late.txt") == "late", "reset() forgets cached misses");
+
+    stub::set_sd_installed(false);
+    sd::reset();
+    expect(!sd::mounted() && sd::open("splash.bmp", "r") == nullptr, "nothing opens without a card");
+    stub::set_sd_installed(true);
+    sd::reset();
+
+    expect(sd::coerce_images_path("/usd/old/jerkbot.bmp") == "/usd/Images/jerkbot.bmp" &&
+               sd::coerce_images_path("usd/Images/a.bmp") == "usd/Images/a.bmp" && sd::coerce_images_path("").empty(),
+           "coerce_images_path");
+
+    fs::current_path(home);
+    fs::remove_all(card);
+}
+} // namespace
+
+int main() {
+    text::set_report(nullptr);
+    check_text();
+    check_plans();
+    check_slots();
+    check_bundle();
+    check_sd();
+    if (g_failures > 0) {
+        std::fprintf(stderr, "%d checks failed\n", g_failures);
+        return 1;
+    }
+    std::printf("common_check: all checks passed\n");
+    return 0;
+}
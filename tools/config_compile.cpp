@@ -0,0 +1,169 @@
+// Packs Tahera's startup text files into robot_config.bin, which the brain
+// loads with a single read instead of opening up to five files at boot.
+//
+// Usage:
+//   config_compile [-o robot_config.bin] [sd_dir]
+//   config_compile -l robot_config.bin
+//
+// sd_dir (default ".") is a copy of the microSD root holding any of
+// ui_images.txt, controller_mapping.txt, auton_slot.txt,
+// auton_plans_slot1..3.txt and auton_plans.txt; missing files get the same
+// defaults the brain uses. The bundle is written into sd_dir unless -o is
+// given. -l prints what an existing bundle holds.
+//
+// Re-run after editing any of the text files: the brain prefers the bundle.
+// The Auton Planner keeps the slot and plans in an existing bundle current
+// when it saves on the brain.
+
+#include "bonkers/config_bundle.hpp"
+#include "bonkers/plan.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+FILE* open_in(const std::string& dir, const char* name) {
+    return std::fopen((dir + "/" + name).c_str(), "r");
+}
+
+bool read_slot_plans(const std::string& dir, const char* name, config::SlotPlans* out) {
+    FILE* file = open_in(dir, name);
+    out->loaded = plan::read_plans(file, &out->gps, &out->basic, name);
+    if (file) {
+        std::fclose(file);
+    }
+    return out->loaded;
+}
+
+// Mirrors the brain's text loaders, including the per-slot fallback to
+// auton_plans.txt.
+void compile(const std::string& dir, config::Config* out) {
+    FILE* file = open_in(dir, config::kUiImagesFile);
+    config::read_images(file, &out->images, config::kUiImagesFile);
+    if (file) {
+        std::fclose(file);
+    }
+
+    config::default_buttons(out->buttons);
+    file = open_in(dir, config::kButtonMapFile);
+    config::read_buttons(file, out->buttons, config::kButtonMapFile);
+    if (file) {
+        std::fclose(file);
+    }
+
+    file = open_in(dir, plan::kSlotIndexFile);
+    out->active_slot = file ? plan::read_slot(file) : 0;
+    if (file) {
+        std::fclose(file);
+    }
+
+    config::SlotPlans legacy;
+    read_slot_plans(dir, plan::kLegacyPlanFile, &legacy);
+    for (int slot = 0; slot < plan::kSlotCount; ++slot) {
+        if (!read_slot_plans(dir, plan::slot_filename(slot), &out->slots[slot])) {
+            out->slots[slot] = legacy;
+        }
+    }
+}
+
+void print_image(const char* key, std::uint8_t flag, const config::Images& images, const std::string& value) {
+    if (images.flags & flag) {
+        std::printf("  %-7s %s\n", key, value.c_str());
+    }
+}
+
+void print_steps(const char* name, const std::vector<plan::Step>& steps) {
+    std::printf("    [%s] %zu steps\n", name, steps.size());
+    for (std::size_t i = 0; i < steps.size(); ++i) {
+        const plan::Step& step = steps[i];
+        std::printf("      %2zu %-12s %6d %6d %6d\n", i + 1, plan::step_type_name(step.type), step.value1,
+                    step.value2, step.value3);
+    }
+}
+
+void print_config(const config::Config& config) {
+    std::printf("images:\n");
+    print_image("SPLASH", config::kHasSplash, config.images, config.images.splash);
+    print_image("AUTON", config::kHasAuton, config.images, config.images.auton);
+    print_image("DRIVER", config::kHasDriver, config.images, config.images.driver);
+    print_image("RUN", config::kHasRun, config.images, config.images.run);
+    std::printf("buttons:\n");
+    for (int i = 0; i < config::kActionCount; ++i) {
+        std::printf("  %-13s %s\n", config::action_key(static_cast<config::Action>(i)),
+                    config::button_name(config.buttons[i]));
+    }
+    std::printf("active slot: %d\n", config.active_slot + 1);
+    for (int slot = 0; slot < plan::kSlotCount; ++slot) {
+        const config::SlotPlans& plans = config.slots[slot];
+        std::printf("slot %d:%s\n", slot + 1, plans.loaded ? "" : " no steps (built-in auton)");
+        if (plans.loaded) {
+            print_steps("GPS", plans.gps);
+            print_steps("BASIC", plans.basic);
+        }
+    }
+}
+
+int list(const char* path) {
+    FILE* file = std::fopen(path, "rb");
+    config::Config config;
+    const bool ok = config::read_bundle(file, &config);
+    if (file) {
+        std::fclose(file);
+    }
+    if (!ok) {
+        std::fprintf(stderr, "%s: not a version %u config bundle, or damaged\n", path,
+                     static_cast<unsigned>(config::kVersion));
+        return 1;
+    }
+    print_config(config);
+    return 0;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string dir = ".";
+    std::string out_path;
+    const char* list_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (std::strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            list_path = argv[++i];
+        } else if (argv[i][0] == '-') {
+            std::fprintf(stderr, "usage: config_compile [-o robot_config.bin] [sd_dir]\n"
+                                 "       config_compile -l robot_config.bin\n");
+            return 2;
+        } else {
+            dir = argv[i];
+        }
+    }
+    if (list_path) {
+        return list(list_path);
+    }
+    if (out_path.empty()) {
+        out_path = dir + "/" + config::kBundleFile;
+    }
+
+    config::Config config;
+    compile(dir, &config);
+    std::vector<std::uint8_t> bytes;
+    if (!config::encode_bundle(config, &bytes)) {
+        std::fprintf(stderr, "%s: a name or plan is too long for a bundle; nothing written\n", out_path.c_str());
+        return 1;
+    }
+    FILE* out = std::fopen(out_path.c_str(), "wb");
+    const bool ok = config::write_bundle(out, bytes);
+    if (out) {
+        std::fclose(out);
+    }
+    if (!ok) {
+        std::fprintf(stderr, "%s: cannot write bundle\n", out_path.c_str());
+        std::remove(out_path.c_str());
+        return 1;
+    }
+    print_config(config);
+    std::printf("-> %s\n", out_path.c_str());
+    return 0;
+}
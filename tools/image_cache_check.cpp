@@ -0,0 +1,234 @@
+// Checks image::Cache, Tahera's cache of decoded frames, against the host
+// screen stub: misses decode once and hits draw without touching the card,
+// the least recently used frame is the one evicted, Tahera's three-frame
+// budget holds the splash, auton and driver frames together, and an image
+// bigger than the budget is streamed row by row instead of cached. Also
+// checks that the decoder reads rows bigger than its SD chunk buffer and
+// reports each decode's own read stats.
+//
+// Usage:
+//   image_cache_check
+//
+// Prints each failed check and exits non-zero if there was one.
+
+#include "bonkers/image_cache.hpp"
+#include "pros_stub.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+int g_failures = 0;
+fs::path g_dir;
+int g_opens = 0;
+
+void expect(bool ok, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++g_failures;
+    }
+}
+
+// Stands in for sd::open, counting every file the cache asks for.
+FILE* open_counted(const char* name, const char* mode) {
+    ++g_opens;
+    return std::fopen((g_dir / name).string().c_str(), mode);
+}
+
+std::uint32_t pixel_at(int seed, int x, int y) {
+    return (static_cast<std::uint32_t>((x + seed * 40) & 0xFF) << 16) |
+           (static_cast<std::uint32_t>((y * 3 + seed) & 0xFF) << 8) | static_cast<std::uint32_t>((seed * 50) & 0xFF);
+}
+
+void put_le(std::vector<std::uint8_t>* out, std::uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out->push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+}
+
+// A bottom-up 24-bit BMP whose pixels are pixel_at(seed, x, y). `rows`
+// below `height` leaves the file truncated.
+void write_bmp(const char* name, int width, int height, int seed, int rows = -1) {
+    const std::uint32_t row_size = ((3u * width + 3) / 4) * 4;
+    std::vector<std::uint8_t> bytes = {'B', 'M'};
+    put_le(&bytes, 54 + row_size * height, 4);
+    put_le(&bytes, 0, 4);
+    put_le(&bytes, 54, 4);
+    put_le(&bytes, 40, 4);
+    put_le(&bytes, static_cast<std::uint32_t>(width), 4);
+    put_le(&bytes, static_cast<std::uint32_t>(height), 4);
+    put_le(&bytes, 1, 2);
+    put_le(&bytes, 24, 2);
+    put_le(&bytes, 0, 4);
+    put_le(&bytes, row_size * height, 4);
+    put_le(&bytes, 2835, 4);
+    put_le(&bytes, 2835, 4);
+    put_le(&bytes, 0, 4);
+    put_le(&bytes, 0, 4);
+    const int written = rows < 0 ? height : rows;
+    for (int row = 0; row < written; ++row) {
+        const int y = height - 1 - row;
+        for (int x = 0; x < width; ++x) {
+            put_le(&bytes, pixel_at(seed, x, y), 3);
+        }
+        bytes.resize(bytes.size() + (row_size - 3u * width), 0);
+    }
+    FILE* file = std::fopen((g_dir / name).string().c_str(), "wb");
+    std::fwrite(bytes.data(), 1, bytes.size(), file);
+    std::fclose(file);
+}
+
+// True if the stub screen shows image `seed` at (0, 0).
+bool on_screen(int seed, int width, int height) {
+    const stub::Screen& screen = stub::screen();
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (screen.frame[y * stub::kScreenW + x] != pixel_at(seed, x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Draws `name`, returning how many files it opened.
+int draw(image::Cache& cache, const char* name, bool* ok = nullptr) {
+    stub::reset_screen();
+    g_opens = 0;
+    const bool drawn = cache.draw(name, 0, 0);
+    if (ok) {
+        *ok = drawn;
+    }
+    return g_opens;
+}
+
+void check_hits_and_eviction() {
+    image::Cache cache(2 * image::kFrameBytes, open_counted);
+    bool ok = false;
+    expect(draw(cache, "a.bmp", &ok) == 1 && ok, "a miss opens the file once");
+    expect(on_screen(1, image::kScreenW, image::kScreenH), "a miss draws the decoded frame");
+    expect(stub::screen().copy_area_calls == 1, "a cached frame is drawn with one copy_area");
+    expect(cache.bytes_used() == image::kFrameBytes, "a miss keeps the frame");
+    expect(draw(cache, "a.bmp", &ok) == 0 && ok, "a hit does not open the file");
+    expect(on_screen(1, image::kScreenW, image::kScreenH) && stub::screen().copy_area_calls == 1,
+           "a hit draws the same frame with one copy_area");
+
+    draw(cache, "b.bmp");
+    draw(cache, "a.bmp"); // b is now the least recently used
+    expect(draw(cache, "c.bmp") == 1 && on_screen(3, image::kScreenW, image::kScreenH), "c is decoded");
+    expect(cache.bytes_used() == 2 * image::kFrameBytes, "the cache stays within its budget");
+    expect(draw(cache, "a.bmp") == 0, "the recently used frame survives eviction");
+    expect(draw(cache, "b.bmp") == 1, "the least recently used frame was evicted");
+    expect(draw(cache, "a.bmp") == 0, "a is still cached after b came back");
+    expect(draw(cache, "c.bmp") == 1, "b's return evicted c, by then the least recently used");
+
+    // Small images cost only their own pixels.
+    expect(draw(cache, "small.bmp") == 1 && on_screen(5, 40, 30), "a small image draws");
+    expect(cache.bytes_used() == image::kFrameBytes + 40 * 30 * sizeof(std::uint32_t),
+           "a small image evicts only what it needs");
+
+    cache.clear();
+    expect(cache.bytes_used() == 0 && draw(cache, "a.bmp") == 1, "clear() drops every frame");
+}
+
+void check_tahera_budget() {
+    // Tahera's kImageCacheBudget: splash, auton and driver preloaded at
+    // startup must all stay resident.
+    image::Cache cache(3 * image::kFrameBytes, open_counted);
+    stub::reset_screen();
+    expect(cache.preload("a.bmp") && cache.preload("b.bmp") && cache.preload("c.bmp"), "three frames preload");
+    expect(stub::screen().copy_area_calls == 0, "preloading does not draw");
+    g_opens = 0;
+    expect(cache.preload("a.bmp") && g_opens == 0, "preloading a resident frame does not open it");
+    expect(draw(cache, "a.bmp") == 0 && draw(cache, "b.bmp") == 0 && draw(cache, "c.bmp") == 0,
+           "splash, auton and driver frames all stay cached");
+    expect(draw(cache, "d.bmp") == 1 && draw(cache, "a.bmp") == 1, "a fourth frame evicts the oldest of three");
+}
+
+void check_streaming() {
+    image::Cache cache(image::kFrameBytes / 2, open_counted);
+    bool ok = false;
+    expect(draw(cache, "a.bmp", &ok) >= 1 && ok, "an image over the budget still draws");
+    expect(on_screen(1, image::kScreenW, image::kScreenH), "an image over the budget draws correctly");
+    expect(stub::screen().copy_area_calls == static_cast<std::uint32_t>(image::kScreenH),
+           "an image over the budget is streamed a row at a time");
+    expect(cache.bytes_used() == 0, "an image over the budget is not kept");
+    expect(draw(cache, "small.bmp") == 1 && cache.bytes_used() == 40 * 30 * sizeof(std::uint32_t),
+           "images within the budget are still cached");
+}
+
+void check_wide_rows() {
+    // 12000 px at 24 bpp is 36000 bytes a row, past the 32 KiB chunk buffer.
+    image::Cache cache(image::kFrameBytes, open_counted);
+    bool ok = false;
+    draw(cache, "wide.bmp", &ok);
+    expect(ok && cache.bytes_used() == image::kScreenW * 4 * sizeof(std::uint32_t),
+           "rows wider than the chunk buffer decode");
+
+    FILE* file = open_counted("wide.bmp", "rb");
+    image::ImageHeader header{};
+    image::ReadStats stats{};
+    std::vector<std::uint32_t> frame(image::kScreenW * 4);
+    const image::RowFn keep = [](void* ctx, int row, const std::uint32_t* pixels, int width) {
+        std::copy(pixels, pixels + width, static_cast<std::uint32_t*>(ctx) + row * width);
+    };
+    expect(file && image::read_header(file, &header) && image::decode(file, header, keep, frame.data(), &stats),
+           "a wide BMP decodes directly");
+    expect(stats.bytes == 4 * 36000u, "read stats count every pixel byte of the decode");
+    if (file) {
+        std::fclose(file);
+    }
+
+    file = open_counted("empty.bmp", "rb");
+    image::ReadStats empty_stats{};
+    expect(file && image::read_header(file, &header) && !image::decode(file, header, keep, frame.data(), &empty_stats),
+           "a BMP without pixel rows fails to decode");
+    expect(empty_stats.bytes == 0, "read stats belong to their own decode");
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+void check_failures() {
+    image::Cache cache(2 * image::kFrameBytes, open_counted);
+    bool ok = true;
+    draw(cache, "missing.bmp", &ok);
+    expect(!ok && cache.bytes_used() == 0, "a missing image fails and keeps nothing");
+    draw(cache, "empty.bmp", &ok);
+    expect(!ok && cache.bytes_used() == 0, "an image with no pixel rows fails and keeps nothing");
+    expect(!cache.draw("", 0, 0), "an empty name fails");
+}
+} // namespace
+
+int main() {
+    g_dir = fs::temp_directory_path() / "bonkers_image_cache_check";
+    fs::remove_all(g_dir);
+    fs::create_directories(g_dir);
+    write_bmp("a.bmp", image::kScreenW, image::kScreenH, 1);
+    write_bmp("b.bmp", image::kScreenW, image::kScreenH, 2);
+    write_bmp("c.bmp", image::kScreenW, image::kScreenH, 3);
+    write_bmp("d.bmp", image::kScreenW, image::kScreenH, 4);
+    write_bmp("small.bmp", 40, 30, 5);
+    write_bmp("empty.bmp", image::kScreenW, image::kScreenH, 6, 0);
+    write_bmp("wide.bmp", 12000, 4, 7);
+
+    check_hits_and_eviction();
+    check_tahera_budget();
+    check_streaming();
+    check_wide_rows();
+    check_failures();
+
+    fs::remove_all(g_dir);
+    if (g_failures > 0) {
+        std::fprintf(stderr, "%d checks failed\n", g_failures);
+        return 1;
+    }
+    std::printf("image_cache_check: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,293 @@
+// Turns a Basic Bonkers practice log into an auton plan file, with the
+// same converter the Auton Planner's LOG button runs on the brain (see
+// bonkers/log_plan.hpp).
+//
+// Usage:
+//   log_to_plan [-m controller_mapping.txt] [-e power_error] [-p period_ms]
+//               [-s gps|basic] [-o auton_plans_slotN.txt] <bonkers_log_XXXX.bbl|.txt|.csv>
+//
+// .bbl logs are read directly. .txt logs are the older "AXIS1 : 42" text
+// logs, one AXIS1-4 group per 20 ms; they only note when a button goes down,
+// so each press there toggles its button. CSV logs can come from
+// bonkers_log_decode, or from the VEXcode Basic Bonkers logger (btnL1...
+// columns), whose stick percentages are scaled to powers. -m applies a controller mapping to the
+// roller buttons, -e sets how far a step's power may stray from the sticks
+// (default 8), and -p the control period the log is resampled to (default
+// 10 ms). The plan goes into both sections unless -s picks one, and to
+// stdout unless -o names a file.
+
+#include "bonkers/config_bundle.hpp"
+#include "bonkers/log_format.hpp"
+#include "bonkers/log_plan.hpp"
+#include "bonkers/plan.hpp"
+#include "bonkers/plan_arena.hpp"
+#include "bonkers/text.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+using plan::kPlanCapacity;
+
+// Columns of a CSV log; -1 when missing.
+struct Columns {
+    int time = -1;
+    int left = -1;
+    int right = -1;
+    int buttons = -1;        // bonkers_log_decode's mask
+    int button_columns[ctrl_log::kButtonCount]; // VEXcode's btnL1... in mask-bit order
+    int left_rpm = -1;
+    int right_rpm = -1;
+    int heading = -1;
+};
+
+constexpr const char* kButtonColumns[ctrl_log::kButtonCount] = {
+    "btnL1", "btnL2", "btnR1", "btnR2", "btnUp", "btnDown", "btnLeft", "btnRight", "btnX", "btnB", "btnY", "btnA"};
+
+// The text log's names for the same buttons.
+constexpr const char* kButtonEvents[ctrl_log::kButtonCount] = {
+    "BTN_L1", "BTN_L2", "BTN_R1", "BTN_R2", "BTN_UP", "BTN_DOWN", "BTN_LEFT", "BTN_RIGHT", "BTN_X", "BTN_B", "BTN_Y",
+    "BTN_A"};
+constexpr std::uint32_t kTextPeriodUs = 20000;
+
+std::vector<char*> split(char* line) {
+    std::vector<char*> cells;
+    text::Cursor cursor(line);
+    bool found = true;
+    while (found) {
+        std::size_t length = 0;
+        cells.push_back(cursor.token(',', &length, &found));
+    }
+    return cells;
+}
+
+Columns find_columns(const std::vector<char*>& names) {
+    Columns columns;
+    for (int& column : columns.button_columns) {
+        column = -1;
+    }
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        const char* name = names[i];
+        const int index = static_cast<int>(i);
+        if (std::strcmp(name, "time_s") == 0) columns.time = index;
+        if (std::strcmp(name, "left_cmd") == 0) columns.left = index;
+        if (std::strcmp(name, "right_cmd") == 0) columns.right = index;
+        if (std::strcmp(name, "buttons") == 0) columns.buttons = index;
+        if (std::strcmp(name, "left_rpm") == 0) columns.left_rpm = index;
+        if (std::strcmp(name, "right_rpm") == 0) columns.right_rpm = index;
+        if (std::strcmp(name, "heading_deg") == 0) columns.heading = index;
+        for (int b = 0; b < ctrl_log::kButtonCount; ++b) {
+            if (std::strcmp(name, kButtonColumns[b]) == 0) columns.button_columns[b] = index;
+        }
+    }
+    return columns;
+}
+
+// Empty cells (telemetry the brain could not read) come back as false.
+bool number(const std::vector<char*>& cells, int column, double* out) {
+    if (column < 0 || static_cast<std::size_t>(column) >= cells.size() || cells[column][0] == '\0') {
+        return false;
+    }
+    char* end = nullptr;
+    *out = std::strtod(cells[column], &end);
+    return end != cells[column] && *end == '\0';
+}
+
+bool read_csv(FILE* file, const char* path, const log_plan::Options& options, plan::PlanBuffer* out,
+              std::size_t* samples) {
+    char buffer[1024];
+    text::LineReader lines(file, buffer, sizeof(buffer));
+    char* header = lines.next();
+    if (!header) {
+        std::fprintf(stderr, "%s: empty\n", path);
+        return false;
+    }
+    const Columns columns = find_columns(split(header));
+    if (columns.time < 0 || columns.left < 0 || columns.right < 0) {
+        std::fprintf(stderr, "%s: needs time_s, left_cmd and right_cmd columns\n", path);
+        return false;
+    }
+    // The VEXcode logger writes stick positions in percent.
+    const double scale = columns.button_columns[0] >= 0 ? 127.0 / 100.0 : 1.0;
+
+    log_plan::Converter converter(options);
+    while (char* line = lines.next()) {
+        const std::vector<char*> cells = split(line);
+        double time_s = 0;
+        double left = 0;
+        double right = 0;
+        if (!number(cells, columns.time, &time_s) || !number(cells, columns.left, &left) ||
+            !number(cells, columns.right, &right)) {
+            continue;
+        }
+        double value = 0;
+        std::uint16_t buttons = 0;
+        if (number(cells, columns.buttons, &value)) {
+            buttons = static_cast<std::uint16_t>(value);
+        }
+        for (int b = 0; b < ctrl_log::kButtonCount; ++b) {
+            if (number(cells, columns.button_columns[b], &value) && value != 0) {
+                buttons |= static_cast<std::uint16_t>(1u << b);
+            }
+        }
+        log_plan::Input input = {static_cast<std::uint32_t>(time_s * 1e6 + 0.5),
+                                 static_cast<int>(left * scale + (left < 0 ? -0.5 : 0.5)),
+                                 static_cast<int>(right * scale + (right < 0 ? -0.5 : 0.5)),
+                                 buttons,
+                                 false,
+                                 0,
+                                 0,
+                                 0};
+        input.measured = number(cells, columns.left_rpm, &input.left_rpm) &&
+                         number(cells, columns.right_rpm, &input.right_rpm) &&
+                         number(cells, columns.heading, &input.heading);
+        converter.add(input);
+    }
+    converter.finish(out);
+    *samples = converter.samples();
+    return true;
+}
+
+// Basic Bonkers' text log: "TYPE : VALUE" lines, AXIS1 starting each tick.
+bool read_text(FILE* file, const char* path, const log_plan::Options& options, plan::PlanBuffer* out,
+               std::size_t* samples) {
+    char buffer[256];
+    text::LineReader lines(file, buffer, sizeof(buffer));
+    log_plan::Converter converter(options);
+    log_plan::Input input{};
+    std::uint32_t ticks = 0;
+    while (char* line = lines.next()) {
+        char* separator = std::strstr(line, " : ");
+        if (!separator) {
+            continue;
+        }
+        *separator = '\0';
+        const char* value = separator + 3;
+        if (std::strcmp(line, "AXIS1") == 0) {
+            if (ticks > 0) {
+                converter.add(input);
+            }
+            input.time_us = ticks++ * kTextPeriodUs;
+        } else if (std::strcmp(line, "AXIS2") == 0) {
+            input.right = std::atoi(value);
+        } else if (std::strcmp(line, "AXIS3") == 0) {
+            input.left = std::atoi(value);
+        } else if (std::strcmp(line, "SCREEN_TAP") == 0) {
+            break;
+        }
+        for (int b = 0; b < ctrl_log::kButtonCount; ++b) {
+            if (std::strcmp(line, kButtonEvents[b]) == 0) {
+                input.buttons ^= static_cast<std::uint16_t>(1u << b);
+            }
+        }
+    }
+    if (ticks == 0) {
+        std::fprintf(stderr, "%s: no AXIS lines\n", path);
+        return false;
+    }
+    converter.add(input);
+    converter.finish(out);
+    *samples = converter.samples();
+    return true;
+}
+
+bool convert(const char* path, const log_plan::Options& options, plan::PlanBuffer* out) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        std::fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    std::size_t samples = 0;
+    const bool txt = text::ends_with_ci(path, ".txt");
+    const bool csv = text::ends_with_ci(path, ".csv");
+    bool ok = false;
+    if (txt) {
+        ok = read_text(file, path, options, out, &samples);
+    } else if (csv) {
+        ok = read_csv(file, path, options, out, &samples);
+    } else {
+        ok = log_plan::read_log(file, options, out, &samples);
+    }
+    std::fclose(file);
+    if (!ok) {
+        if (!txt && !csv) {
+            std::fprintf(stderr, "%s: not a controller log\n", path);
+        }
+        return false;
+    }
+    std::fprintf(stderr, "%s: %zu samples at %u ms -> %zu steps\n", path, samples,
+                 static_cast<unsigned>(options.fit.sample_ms), out->size());
+    if (out->dropped() > 0) {
+        std::fprintf(stderr, "%s: %zu steps past the %zu-step limit were dropped\n", path, out->dropped(),
+                     kPlanCapacity);
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    log_plan::Options options;
+    config::default_buttons(options.buttons);
+    const char* mapping_path = nullptr;
+    const char* out_path = nullptr;
+    const char* section = nullptr;
+    const char* log_path = nullptr;
+    bool usage = false;
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "-m") == 0 && has_value) {
+            mapping_path = argv[++i];
+        } else if (std::strcmp(argv[i], "-e") == 0 && has_value) {
+            options.fit.power_error = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "-p") == 0 && has_value) {
+            options.fit.sample_ms = static_cast<std::uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "-s") == 0 && has_value) {
+            section = argv[++i];
+        } else if (std::strcmp(argv[i], "-o") == 0 && has_value) {
+            out_path = argv[++i];
+        } else if (!log_path && argv[i][0] != '-') {
+            log_path = argv[i];
+        } else {
+            usage = true;
+        }
+    }
+    const bool gps = !section || std::strcmp(section, "gps") == 0;
+    const bool basic = !section || std::strcmp(section, "basic") == 0;
+    if (usage || !log_path || (!gps && !basic) || options.fit.sample_ms == 0 || options.fit.power_error < 0) {
+        std::fprintf(stderr, "usage: log_to_plan [-m mapping.txt] [-e power_error] [-p period_ms] [-s gps|basic] "
+                             "[-o plan.txt] <log.bbl|log.txt|log.csv>\n");
+        return 2;
+    }
+
+    if (mapping_path) {
+        FILE* mapping = std::fopen(mapping_path, "r");
+        if (!mapping) {
+            std::fprintf(stderr, "%s: cannot open\n", mapping_path);
+            return 1;
+        }
+        config::read_buttons(mapping, options.buttons, mapping_path);
+        std::fclose(mapping);
+    }
+
+    static plan::Arena<kPlanCapacity> arena;
+    plan::PlanBuffer steps = arena.carve(kPlanCapacity);
+    if (!convert(log_path, options, &steps)) {
+        return 1;
+    }
+
+    FILE* out = out_path ? std::fopen(out_path, "w") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "%s: cannot write\n", out_path);
+        return 1;
+    }
+    const bool ok = plan::write_plans(out, steps.data(), gps ? steps.size() : 0, steps.data(),
+                                      basic ? steps.size() : 0);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return ok ? 0 : 1;
+}
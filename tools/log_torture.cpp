@@ -0,0 +1,282 @@
+// Torture test for the framed controller log reader: cuts a log at every
+// byte offset and flips every byte after the header, checking that the
+// reader keeps exactly the frames before the damage and never reads past it.
+//
+// Usage:
+//   log_torture [-n frames] [log.bbl]
+//
+// Without a file, synthetic logs (with and without telemetry) are built
+// with the brain's own framing, followed by stale frames from an older
+// session as a preallocated file would be. With a file (format version 2+),
+// that log is tortured instead.
+// Exits non-zero on the first class of failure found.
+
+#include "bonkers/log_format.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace {
+using Bytes = std::vector<std::uint8_t>;
+
+struct Boundary {
+    std::size_t end;       // offset just past the frame
+    std::uint32_t samples; // samples in this frame and all before it
+    bool end_frame;
+};
+
+struct Record {
+    ctrl_log::Sample sample;
+    ctrl_log::Telemetry telemetry;
+};
+
+struct Result {
+    bool opened = false;
+    std::vector<Record> records;
+    ctrl_log::ScanStats stats{};
+};
+
+Result read_log(const Bytes& bytes, std::size_t size) {
+    Result result;
+    FILE* file = std::tmpfile();
+    if (!file) {
+        std::perror("tmpfile");
+        std::exit(2);
+    }
+    std::fwrite(bytes.data(), 1, size, file);
+    std::rewind(file);
+
+    ctrl_log::LogReader reader;
+    result.opened = reader.open(file);
+    if (result.opened) {
+        Record record;
+        while (reader.next(&record.sample, &record.telemetry)) {
+            result.records.push_back(record);
+        }
+        result.stats = reader.stats();
+    }
+    std::fclose(file);
+    return result;
+}
+
+void append_frame(Bytes* out, const std::vector<Record>& records, bool telemetry, std::uint16_t sequence,
+                  std::uint32_t session_id) {
+    std::uint8_t frame[ctrl_log::kMaxFrameSize];
+    std::size_t payload = 0;
+    for (const Record& record : records) {
+        ctrl_log::write_sample(record.sample, frame + ctrl_log::kFrameHeaderSize + payload);
+        payload += ctrl_log::kSampleSize;
+        if (telemetry) {
+            ctrl_log::write_telemetry(record.telemetry, frame + ctrl_log::kFrameHeaderSize + payload);
+            payload += ctrl_log::kTelemetrySize;
+        }
+    }
+    const std::size_t size = ctrl_log::seal_frame(frame, payload, sequence, session_id);
+    out->insert(out->end(), frame, frame + size);
+}
+
+Bytes synthetic_log(int frame_count, bool closed, bool telemetry, std::mt19937* rng) {
+    ctrl_log::Header header{};
+    header.period_ms = 20;
+    header.axis_channels[0] = ctrl_log::kAnalogRightX;
+    header.axis_channels[1] = ctrl_log::kAnalogRightY;
+    header.axis_channels[2] = ctrl_log::kAnalogLeftY;
+    header.axis_channels[3] = ctrl_log::kAnalogLeftX;
+    header.left_axis = 2;
+    header.right_axis = 1;
+    header.program_id = ctrl_log::kProgramBasicBonkers;
+    header.session_id = 0x5EED0002;
+    header.flush_ms = 250;
+    header.telemetry = telemetry ? ctrl_log::kTelemetryVelocity | ctrl_log::kTelemetryHeading : 0;
+    Bytes out(ctrl_log::kHeaderSize);
+    ctrl_log::write_header(header, out.data());
+
+    std::uniform_int_distribution<int> axis(-127, 127);
+    std::uniform_int_distribution<int> frame_samples(1, 24);
+    std::uint8_t sequence = 0;
+    std::uint32_t time_us = 0;
+    for (int f = 0; f < frame_count; ++f) {
+        std::vector<Record> records(static_cast<std::size_t>(frame_samples(*rng)));
+        for (Record& record : records) {
+            ctrl_log::Sample& sample = record.sample;
+            time_us += 5000 + static_cast<std::uint32_t>((*rng)() % 200);
+            sample.time_us = time_us;
+            for (std::int8_t& value : sample.axes) {
+                value = static_cast<std::int8_t>(axis(*rng));
+            }
+            sample.buttons = static_cast<std::uint16_t>((*rng)() & 0x0FFF);
+            sample.flags = 0;
+            sample.sequence = sequence++;
+            record.telemetry = ctrl_log::Telemetry{};
+            if (telemetry) {
+                record.telemetry.left_velocity = static_cast<std::int16_t>(axis(*rng) * 47);
+                record.telemetry.right_velocity = static_cast<std::int16_t>(axis(*rng) * 47);
+                record.telemetry.heading = static_cast<std::uint16_t>((*rng)() % 36000);
+                record.telemetry.valid = static_cast<std::uint8_t>((*rng)() & 0x07);
+            }
+        }
+        append_frame(&out, records, telemetry, static_cast<std::uint16_t>(f), header.session_id);
+    }
+    if (closed) {
+        append_frame(&out, {}, telemetry, static_cast<std::uint16_t>(frame_count), header.session_id);
+    }
+
+    // What a preallocated extent can hold: an older log's frames, with
+    // plausible sequence numbers, then noise.
+    Bytes stale = out;
+    for (std::size_t i = ctrl_log::kHeaderSize; i < stale.size(); ++i) {
+        out.push_back(stale[i]);
+    }
+    append_frame(&out, {Record{ctrl_log::Sample{20000, {1, 2, 3, 4}, 0, 0, 0}, ctrl_log::Telemetry{}}}, telemetry,
+                 static_cast<std::uint16_t>(frame_count + 1), 0x01D5E551);
+    for (int i = 0; i < 512; ++i) {
+        out.push_back(static_cast<std::uint8_t>((*rng)()));
+    }
+    return out;
+}
+
+// Frame boundaries of the good part of `bytes`, from a full read.
+bool find_boundaries(const Bytes& bytes, std::size_t* header_bytes, std::vector<Boundary>* out) {
+    const Result full = read_log(bytes, bytes.size());
+    ctrl_log::Header header{};
+    if (!full.opened || !ctrl_log::parse_header(bytes.data(), bytes.size(), &header, header_bytes) ||
+        header.version < 2) {
+        return false;
+    }
+    std::size_t pos = *header_bytes;
+    std::uint32_t samples = 0;
+    while (pos < full.stats.good_bytes) {
+        const std::size_t payload = ctrl_log::get_u16(bytes.data() + pos);
+        pos += ctrl_log::kFrameHeaderSize + payload + ctrl_log::kFrameTrailerSize;
+        samples += static_cast<std::uint32_t>(payload / header.record_bytes);
+        out->push_back({pos, samples, payload == 0});
+    }
+    return pos == full.stats.good_bytes;
+}
+
+bool same_records(const Result& result, const Result& full, std::uint32_t count) {
+    if (result.records.size() != count) {
+        return false;
+    }
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::uint8_t a[ctrl_log::kMaxRecordSize];
+        std::uint8_t b[ctrl_log::kMaxRecordSize];
+        ctrl_log::write_sample(result.records[i].sample, a);
+        ctrl_log::write_telemetry(result.records[i].telemetry, a + ctrl_log::kSampleSize);
+        ctrl_log::write_sample(full.records[i].sample, b);
+        ctrl_log::write_telemetry(full.records[i].telemetry, b + ctrl_log::kSampleSize);
+        if (std::memcmp(a, b, sizeof(a)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every prefix of the file must decode to the frames wholly inside it.
+int cut_everywhere(const Bytes& bytes, std::size_t header_bytes, const std::vector<Boundary>& frames,
+                   const Result& full) {
+    int failures = 0;
+    for (std::size_t cut = 0; cut <= bytes.size(); ++cut) {
+        const Result result = read_log(bytes, cut);
+        if (cut < header_bytes) {
+            if (result.opened) {
+                std::printf("cut %zu: opened a partial header\n", cut);
+                ++failures;
+            }
+            continue;
+        }
+        std::uint32_t expected = 0;
+        std::size_t good = header_bytes;
+        bool closed = false;
+        for (const Boundary& frame : frames) {
+            if (frame.end <= cut) {
+                expected = frame.samples;
+                good = frame.end;
+                closed = frame.end_frame;
+            }
+        }
+        if (!result.opened || !same_records(result, full, expected) || result.stats.good_bytes != good ||
+            (closed && result.stats.end != ctrl_log::LogEnd::CLOSED) ||
+            (!closed && cut == good && result.stats.end != ctrl_log::LogEnd::UNCLOSED)) {
+            std::printf("cut %zu: %zu samples (want %u), good bytes %u (want %zu), %s\n", cut, result.records.size(),
+                        expected, result.stats.good_bytes, good, ctrl_log::end_name(result.stats.end));
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+// Any single damaged byte must cost its own frame and everything after.
+int flip_everywhere(Bytes bytes, std::size_t header_bytes, const std::vector<Boundary>& frames,
+                    const Result& full) {
+    int failures = 0;
+    std::size_t frame = 0;
+    std::uint32_t before = 0;
+    const std::size_t end = frames.empty() ? header_bytes : frames.back().end;
+    for (std::size_t pos = header_bytes; pos < end; ++pos) {
+        while (pos >= frames[frame].end) {
+            before = frames[frame].samples;
+            ++frame;
+        }
+        bytes[pos] ^= 0xA5;
+        const Result result = read_log(bytes, bytes.size());
+        bytes[pos] ^= 0xA5;
+        if (!result.opened || !same_records(result, full, before) ||
+            result.stats.end == ctrl_log::LogEnd::CLOSED) {
+            std::printf("flip %zu (frame %zu): %zu samples (want %u), %s\n", pos, frame, result.records.size(), before,
+                        ctrl_log::end_name(result.stats.end));
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+int torture(const char* name, const Bytes& bytes) {
+    std::size_t header_bytes = 0;
+    std::vector<Boundary> frames;
+    if (!find_boundaries(bytes, &header_bytes, &frames) || frames.empty()) {
+        std::printf("%s: not a framed controller log\n", name);
+        return 1;
+    }
+    const Result full = read_log(bytes, bytes.size());
+    const int cut_failures = cut_everywhere(bytes, header_bytes, frames, full);
+    const int flip_failures = flip_everywhere(bytes, header_bytes, frames, full);
+    std::printf("%s: %zu bytes, %zu frames, %zu samples, %s; %d cut / %d flip failures\n", name, bytes.size(),
+                frames.size(), full.records.size(), ctrl_log::end_name(full.stats.end), cut_failures, flip_failures);
+    return cut_failures + flip_failures;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int frame_count = 40;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            frame_count = std::atoi(argv[++i]);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (frame_count < 1) {
+        std::fprintf(stderr, "usage: log_torture [-n frames] [log.bbl]\n");
+        return 2;
+    }
+
+    if (path) {
+        std::ifstream in(path, std::ios::binary);
+        const Bytes bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return torture(path, bytes) == 0 ? 0 : 1;
+    }
+
+    std::mt19937 rng(12345);
+    int failures = torture("closed", synthetic_log(frame_count, true, false, &rng));
+    failures += torture("power cut", synthetic_log(frame_count, false, false, &rng));
+    failures += torture("telemetry", synthetic_log(frame_count, true, true, &rng));
+    return failures == 0 ? 0 : 1;
+}
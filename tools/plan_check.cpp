@@ -0,0 +1,88 @@
+// Parses auton plan files with the brain's own reader and prints what the
+// robot would run, with the same runtime estimate and range check Tahera
+// shows for each slot.
+//
+// Usage:
+//   plan_check [-f] <auton_plans_slotN.txt>...
+//
+// With -f, each file that parses is rewritten in the current format. That
+// repairs slot files saved by old Auton Planner builds, which wrote a
+// literal "\n" between records.
+
+#include "bonkers/plan.hpp"
+#include "bonkers/plan_vm.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+void print_section(const char* name, const std::vector<plan::Step>& steps) {
+    std::vector<plan::Instr> program;
+    plan::compile(steps.data(), steps.size(), &program);
+    const std::uint32_t estimate = plan::estimate_ms(program);
+    std::printf("  [%s] %zu steps, ~%u ms%s\n", name, steps.size(), estimate,
+                estimate > static_cast<std::uint32_t>(plan::kMaxStepMs) ? " (over the 15 s auton)" : "");
+    for (std::size_t i = 0; i < steps.size(); ++i) {
+        const plan::Step& step = steps[i];
+        std::printf("    %2zu %-12s %6d %6d %6d%s\n", i + 1, plan::step_type_name(step.type), step.value1, step.value2,
+                    step.value3, plan::step_in_range(step) ? "" : "  out of range");
+    }
+}
+
+bool check(const char* path, bool fix) {
+    FILE* file = std::fopen(path, "r");
+    if (!file) {
+        std::fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    std::vector<plan::Step> gps;
+    std::vector<plan::Step> basic;
+    const bool ok = plan::read_plans(file, &gps, &basic, path);
+    std::fclose(file);
+
+    std::printf("%s\n", path);
+    if (!ok) {
+        std::printf("  no steps; the robot falls back to its built-in auton\n");
+        return false;
+    }
+    print_section("GPS", gps);
+    print_section("BASIC", basic);
+
+    if (fix) {
+        file = std::fopen(path, "w");
+        if (!file || !plan::write_plans(file, gps.data(), gps.size(), basic.data(), basic.size())) {
+            std::fprintf(stderr, "%s: rewrite failed\n", path);
+            if (file) {
+                std::fclose(file);
+            }
+            return false;
+        }
+        std::fclose(file);
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    bool fix = false;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-f") == 0) {
+            fix = true;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty()) {
+        std::fprintf(stderr, "usage: plan_check [-f] <plan.txt>...\n");
+        return 2;
+    }
+
+    int failures = 0;
+    for (const char* path : paths) {
+        failures += check(path, fix) ? 0 : 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
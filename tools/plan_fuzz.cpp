@@ -0,0 +1,291 @@
+// Fuzzes the microSD text parsers: plan::read_plans, config::read_buttons,
+// config::read_images and the text::LineReader under them. For each input:
+//   - LineReader with a tiny buffer returns the same lines, cut to fit, as
+//     a plain split on '\n';
+//   - reading into small PlanBuffers gives a prefix of the std::vector
+//     result, with the rest counted as dropped;
+//   - writing the parsed plans and reading them back gives the same steps;
+//   - the config readers only ever store known buttons.
+//
+// With -DBONKERS_LIBFUZZER=ON (clang), this builds as a libFuzzer target:
+//   plan_fuzz corpus_dir/
+// Otherwise it is a standalone mutation driver:
+//   plan_fuzz [-n iterations] [-s seed] [seed_file]...
+// which starts from the seed files (or a built-in plan and mapping) and
+// writes the first failing input to plan_fuzz_failure.txt.
+
+#include "bonkers/config_bundle.hpp"
+#include "bonkers/plan.hpp"
+#include "bonkers/plan_arena.hpp"
+#include "bonkers/text.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+using plan::Step;
+
+constexpr std::size_t kSmallPlan = 8;
+constexpr std::size_t kTinyLine = 8;
+
+bool same_steps(const Step& a, const Step& b) {
+    return a.type == b.type && a.value1 == b.value1 && a.value2 == b.value2 && a.value3 == b.value3;
+}
+
+bool fail(const char* what) {
+    std::fprintf(stderr, "plan_fuzz: %s\n", what);
+    return false;
+}
+
+// Runs `fn` on a stream over a private copy of the input.
+template <typename Fn>
+void with_file(const std::uint8_t* data, std::size_t size, Fn fn) {
+    std::vector<char> copy(data, data + size);
+    copy.push_back('\0');
+    FILE* file = size > 0 ? fmemopen(copy.data(), size, "r") : nullptr;
+    fn(file);
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+// What LineReader should return: lines split on '\n' after a leading BOM,
+// each cut at its first NUL, at `capacity` - 1 bytes and before trailing
+// '\r's.
+std::vector<std::string> expected_lines(const std::uint8_t* data, std::size_t size, std::size_t capacity) {
+    std::vector<std::string> lines;
+    std::size_t pos = size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+    while (pos < size) {
+        std::size_t end = pos;
+        while (end < size && data[end] != '\n') {
+            ++end;
+        }
+        std::string line(reinterpret_cast<const char*>(data) + pos, std::min(end - pos, capacity - 1));
+        line.resize(std::strlen(line.c_str()));
+        while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) {
+            line.pop_back();
+        }
+        lines.push_back(line);
+        pos = end + 1;
+    }
+    return lines;
+}
+
+bool check_lines(const std::uint8_t* data, std::size_t size) {
+    const std::vector<std::string> expected = expected_lines(data, size, kTinyLine);
+    bool ok = true;
+    with_file(data, size, [&](FILE* file) {
+        if (!file) {
+            return;
+        }
+        char buffer[kTinyLine];
+        text::LineReader reader(file, buffer, sizeof(buffer));
+        std::size_t count = 0;
+        while (const char* line = reader.next()) {
+            if (count >= expected.size() || expected[count] != line) {
+                ok = fail("LineReader returned a different line");
+                return;
+            }
+            ++count;
+            if (reader.line() != static_cast<int>(count)) {
+                ok = fail("LineReader line number is off");
+                return;
+            }
+        }
+        if (count != expected.size()) {
+            ok = fail("LineReader returned too few lines");
+        }
+    });
+    return ok;
+}
+
+bool check_plans(const std::uint8_t* data, std::size_t size) {
+    std::vector<Step> gps;
+    std::vector<Step> basic;
+    with_file(data, size, [&](FILE* file) { plan::read_plans(file, &gps, &basic, "fuzz"); });
+
+    Step storage[2 * kSmallPlan];
+    plan::PlanBuffer small_gps(storage, kSmallPlan);
+    plan::PlanBuffer small_basic(storage + kSmallPlan, kSmallPlan);
+    with_file(data, size, [&](FILE* file) { plan::read_plans(file, &small_gps, &small_basic, "fuzz"); });
+    for (const auto& pair : {std::make_pair(&gps, &small_gps), std::make_pair(&basic, &small_basic)}) {
+        const std::vector<Step>& full = *pair.first;
+        const plan::PlanBuffer& small = *pair.second;
+        if (small.size() != std::min(full.size(), kSmallPlan) || small.size() + small.dropped() != full.size()) {
+            return fail("PlanBuffer size or dropped count does not match");
+        }
+        for (std::size_t i = 0; i < small.size(); ++i) {
+            if (!same_steps(small[i], full[i])) {
+                return fail("PlanBuffer is not a prefix of the full parse");
+            }
+        }
+    }
+
+    char* written = nullptr;
+    std::size_t written_size = 0;
+    FILE* out = open_memstream(&written, &written_size);
+    plan::write_plans(out, gps.data(), gps.size(), basic.data(), basic.size());
+    std::fclose(out);
+    std::vector<Step> gps_again;
+    std::vector<Step> basic_again;
+    with_file(reinterpret_cast<const std::uint8_t*>(written), written_size,
+              [&](FILE* file) { plan::read_plans(file, &gps_again, &basic_again, "fuzz round trip"); });
+    std::free(written);
+    if (gps_again.size() != gps.size() || basic_again.size() != basic.size()) {
+        return fail("write_plans then read_plans changed the step count");
+    }
+    for (std::size_t i = 0; i < gps.size(); ++i) {
+        if (!same_steps(gps[i], gps_again[i])) {
+            return fail("write_plans then read_plans changed a GPS step");
+        }
+    }
+    for (std::size_t i = 0; i < basic.size(); ++i) {
+        if (!same_steps(basic[i], basic_again[i])) {
+            return fail("write_plans then read_plans changed a BASIC step");
+        }
+    }
+    return true;
+}
+
+bool check_config(const std::uint8_t* data, std::size_t size) {
+    std::uint8_t buttons[config::kActionCount];
+    config::default_buttons(buttons);
+    with_file(data, size, [&](FILE* file) { config::read_buttons(file, buttons, "fuzz"); });
+    for (std::uint8_t button : buttons) {
+        if (button < config::kButtonL1 || button > config::kButtonA) {
+            return fail("read_buttons stored an unknown button");
+        }
+    }
+    config::Images images;
+    with_file(data, size, [&](FILE* file) { config::read_images(file, &images, "fuzz"); });
+    if (images.flags & ~(config::kHasSplash | config::kHasAuton | config::kHasDriver | config::kHasRun)) {
+        return fail("read_images set an unknown flag");
+    }
+    return true;
+}
+
+bool check(const std::uint8_t* data, std::size_t size) {
+    return check_lines(data, size) && check_plans(data, size) && check_config(data, size);
+}
+} // namespace
+
+#ifdef BONKERS_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    text::set_report(nullptr);
+    if (!check(data, size)) {
+        std::abort();
+    }
+    return 0;
+}
+#else
+namespace {
+const char* const kSeeds[] = {
+    "[GPS]\nDRIVE_MS,80,1200,0\nTURN_HEADING,270,0,0\nINTAKE_ON,0,0,0\n[BASIC]\nTANK_MS,60,-60,450\nWAIT_MS,250\n",
+    "# map\n intake_in = r1 \nGPS_ENABLE=UP\nSPLASH=loading_icon.bmp\nRUN=old/run.bmp\n",
+};
+
+// Pieces the mutator splices in so inputs reach past the first token.
+const char* const kTokens[] = {
+    "[GPS]", "[BASIC]", "\\n", "\n", "\r\n", ",", "-", "#", "=", " ", "\t", "\xEF\xBB\xBF",
+    "EMPTY", "DRIVE_MS", "TANK_MS", "TURN_HEADING", "WAIT_MS", "INTAKE_ON", "OUTTAKE_OFF", "PARALLEL", "END_PARALLEL",
+    "INTAKE_FOR_MS", "DRIVE_DIST", "TURN_RELATIVE", "ARC",
+    "2147483648", "-99999999999", "INTAKE_IN", "L1", "a", "SPLASH", "AUTON",
+};
+
+std::string mutate(const std::string& input, std::mt19937* rng) {
+    std::string out = input;
+    const int edits = 1 + static_cast<int>((*rng)() % 4);
+    for (int i = 0; i < edits; ++i) {
+        const std::size_t pos = out.empty() ? 0 : (*rng)() % (out.size() + 1);
+        switch ((*rng)() % 5) {
+            case 0:
+                if (!out.empty() && pos < out.size()) {
+                    out[pos] = static_cast<char>((*rng)() & 0xFF);
+                }
+                break;
+            case 1:
+                out.erase(pos, (*rng)() % 8);
+                break;
+            case 2:
+                out.insert(pos, kTokens[(*rng)() % (sizeof(kTokens) / sizeof(kTokens[0]))]);
+                break;
+            case 3:
+                out.insert(pos, 1 + (*rng)() % 40, static_cast<char>('0' + (*rng)() % 10));
+                break;
+            default: {
+                // Duplicate a slice, which grows sections and long lines.
+                const std::size_t from = out.empty() ? 0 : (*rng)() % out.size();
+                out.insert(pos, out.substr(from, (*rng)() % 64));
+                break;
+            }
+        }
+    }
+    return out.size() > 1 << 16 ? out.substr(0, 1 << 16) : out;
+}
+
+bool read_seed(const char* path, std::string* out) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    char chunk[4096];
+    std::size_t got = 0;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        out->append(chunk, got);
+    }
+    std::fclose(file);
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    long iterations = 200000;
+    unsigned seed = 1;
+    std::vector<std::string> corpus;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = std::atol(argv[++i]);
+        } else if (std::strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::string input;
+            if (!read_seed(argv[i], &input)) {
+                std::fprintf(stderr, "%s: cannot open\n", argv[i]);
+                return 1;
+            }
+            corpus.push_back(input);
+        }
+    }
+    if (corpus.empty()) {
+        corpus.assign(std::begin(kSeeds), std::end(kSeeds));
+    }
+
+    text::set_report(nullptr);
+    std::mt19937 rng(seed);
+    for (long i = 0; i < iterations; ++i) {
+        const std::string input = mutate(corpus[rng() % corpus.size()], &rng);
+        if (!check(reinterpret_cast<const std::uint8_t*>(input.data()), input.size())) {
+            FILE* out = std::fopen("plan_fuzz_failure.txt", "wb");
+            if (out) {
+                std::fwrite(input.data(), 1, input.size(), out);
+                std::fclose(out);
+            }
+            std::printf("failed after %ld inputs; input written to plan_fuzz_failure.txt\n", i + 1);
+            return 1;
+        }
+        // Keep a few mutants so edits compound.
+        if (corpus.size() < 256 && rng() % 16 == 0) {
+            corpus.push_back(input);
+        }
+    }
+    std::printf("%ld inputs, seed %u: ok\n", iterations, seed);
+    return 0;
+}
+#endif
@@ -0,0 +1,290 @@
+// Times the microSD text parsers on the host: the fgets/std::string/sscanf
+// readers Tahera used before, vs the in-place LineReader/Cursor parsers in
+// bonkers/plan.cpp and bonkers/config_bundle.cpp. Also counts heap
+// allocations per parse.
+//
+// Usage:
+//   plan_parse_bench [-n iterations] [-s steps_per_section] [plan_file]
+//
+// Without a file, a plan with `steps` (default 1024) steps per section is
+// generated. The controller mapping is the eight actions remapped, with a
+// comment and a blank line. Files are read from an in-memory stream, so
+// only parsing is timed; the std::vector results are reserved up front so
+// the new parser's count is the parser itself.
+
+#include "bonkers/config_bundle.hpp"
+#include "bonkers/plan.hpp"
+#include "bonkers/text.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+std::size_t g_allocations = 0;
+} // namespace
+
+void* operator new(std::size_t size) {
+    ++g_allocations;
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+using plan::Step;
+using plan::StepType;
+
+// --- Tahera's readers before the shared parser. ---
+StepType legacy_step_type(const std::string& token) {
+    if (token == "EMPTY") return StepType::EMPTY;
+    if (token == "DRIVE_MS") return StepType::DRIVE_MS;
+    if (token == "TANK_MS") return StepType::TANK_MS;
+    if (token == "TURN_HEADING") return StepType::TURN_HEADING;
+    if (token == "WAIT_MS") return StepType::WAIT_MS;
+    if (token == "INTAKE_ON") return StepType::INTAKE_ON;
+    if (token == "INTAKE_OFF") return StepType::INTAKE_OFF;
+    if (token == "OUTTAKE_ON") return StepType::OUTTAKE_ON;
+    if (token == "OUTTAKE_OFF") return StepType::OUTTAKE_OFF;
+    return StepType::EMPTY;
+}
+
+bool legacy_read_plans(FILE* file, std::vector<Step>* gps, std::vector<Step>* basic) {
+    gps->clear();
+    basic->clear();
+    enum class Section { NONE, GPS, BASIC };
+    Section section = Section::NONE;
+
+    char line[128];
+    while (std::fgets(line, sizeof(line), file)) {
+        std::string s(line);
+        if (s.find("[GPS]") != std::string::npos) {
+            section = Section::GPS;
+            continue;
+        }
+        if (s.find("[BASIC]") != std::string::npos) {
+            section = Section::BASIC;
+            continue;
+        }
+        if (s.empty() || s[0] == '#') {
+            continue;
+        }
+
+        char type_str[32];
+        int v1 = 0;
+        int v2 = 0;
+        int v3 = 0;
+        const int fields = std::sscanf(s.c_str(), "%31[^,],%d,%d,%d", type_str, &v1, &v2, &v3);
+        if (fields >= 3) {
+            Step step{legacy_step_type(type_str), v1, v2, v3};
+            if (section == Section::GPS) gps->push_back(step);
+            if (section == Section::BASIC) basic->push_back(step);
+        }
+    }
+    return !(gps->empty() && basic->empty());
+}
+
+std::string trim_copy(const std::string& value) {
+    std::size_t start = 0;
+    while (start < value.size() && std::isspace(static_cast<unsigned char>(value[start]))) {
+        ++start;
+    }
+    std::size_t end = value.size();
+    while (end > start && std::isspace(static_cast<unsigned char>(value[end - 1]))) {
+        --end;
+    }
+    return value.substr(start, end - start);
+}
+
+std::string uppercase_copy(std::string value) {
+    for (char& ch : value) {
+        ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+    }
+    return value;
+}
+
+void legacy_read_buttons(FILE* file, std::uint8_t* buttons) {
+    char line[96];
+    while (std::fgets(line, sizeof(line), file)) {
+        text::chomp_line(line);
+        std::string entry = trim_copy(line);
+        if (entry.empty() || entry[0] == '#') {
+            continue;
+        }
+        const std::size_t eq = entry.find('=');
+        if (eq == std::string::npos) {
+            continue;
+        }
+        const std::string action_key = uppercase_copy(trim_copy(entry.substr(0, eq)));
+        const std::string button_key = uppercase_copy(trim_copy(entry.substr(eq + 1)));
+
+        int action = -1;
+        for (int i = 0; i < config::kActionCount; ++i) {
+            if (action_key == config::action_key(static_cast<config::Action>(i))) {
+                action = i;
+            }
+        }
+        for (std::uint8_t b = config::kButtonL1; b <= config::kButtonA && action >= 0; ++b) {
+            if (button_key == config::button_name(b)) {
+                buttons[action] = b;
+            }
+        }
+    }
+}
+
+// --- Inputs. ---
+std::string generate_plan(int steps) {
+    static const char* const kSteps[] = {
+        "DRIVE_MS,80,1200,0", "TANK_MS,60,-60,450", "TURN_HEADING,270,0,0", "WAIT_MS,250,0,0",
+        "INTAKE_ON,0,0,0",    "INTAKE_OFF,0,0,0",   "OUTTAKE_ON,0,0,0",     "OUTTAKE_OFF,0,0,0",
+    };
+    std::string out;
+    for (const char* header : {"[GPS]", "[BASIC]"}) {
+        out += header;
+        out += '\n';
+        for (int i = 0; i < steps; ++i) {
+            out += kSteps[i % 8];
+            out += '\n';
+        }
+    }
+    return out;
+}
+
+const char kMapping[] =
+    "# driver remap\n"
+    "intake_in = r1\n"
+    "INTAKE_OUT=R2\n"
+    "OUTAKE_OUT=L1\n"
+    "OUTAKE_IN=L2\n"
+    "\n"
+    "GPS_ENABLE=UP\n"
+    "GPS_DISABLE=DOWN\n"
+    "SIX_WHEEL_ON=LEFT\n"
+    "SIX_WHEEL_OFF=RIGHT\n";
+
+bool read_file(const char* path, std::string* out) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    char chunk[4096];
+    std::size_t got = 0;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        out->append(chunk, got);
+    }
+    std::fclose(file);
+    return true;
+}
+
+struct Result {
+    double ms = 0;
+    std::size_t allocations = 0;
+    std::size_t checksum = 0;
+};
+
+// Runs `parse` on a fresh in-memory stream `iterations` times.
+template <typename Parse>
+Result time_parse(std::string& input, int iterations, Parse parse) {
+    Result result;
+    for (int i = 0; i < iterations; ++i) {
+        FILE* file = fmemopen(&input[0], input.size(), "r");
+        const std::size_t before = g_allocations;
+        const auto start = std::chrono::steady_clock::now();
+        result.checksum += parse(file);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        result.ms += elapsed.count();
+        result.allocations += g_allocations - before;
+        std::fclose(file);
+    }
+    return result;
+}
+
+void print_row(const char* name, const Result& result, std::size_t bytes, int iterations) {
+    const double mb = static_cast<double>(bytes) * iterations / (1024.0 * 1024.0);
+    std::printf("  %-8s %9.3f ms/parse %9.1f MB/s %8.1f allocs/parse\n", name, result.ms / iterations,
+                mb / (result.ms / 1000.0), static_cast<double>(result.allocations) / iterations);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = 200;
+    int steps = 1024;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            steps = std::atoi(argv[++i]);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (iterations <= 0) {
+        iterations = 1;
+    }
+
+    std::string plan_text;
+    if (!path) {
+        plan_text = generate_plan(steps);
+    } else if (!read_file(path, &plan_text)) {
+        std::fprintf(stderr, "%s: cannot open\n", path);
+        return 1;
+    }
+    std::string mapping_text = kMapping;
+    text::set_report(nullptr);
+
+    std::vector<Step> gps;
+    std::vector<Step> basic;
+    gps.reserve(plan_text.size());
+    basic.reserve(plan_text.size());
+    std::uint8_t buttons[config::kActionCount];
+
+    std::printf("plan: %zu bytes\n", plan_text.size());
+    const Result old_plan = time_parse(plan_text, iterations, [&](FILE* file) {
+        legacy_read_plans(file, &gps, &basic);
+        return gps.size() + basic.size();
+    });
+    const Result new_plan = time_parse(plan_text, iterations, [&](FILE* file) {
+        plan::read_plans(file, &gps, &basic);
+        return gps.size() + basic.size();
+    });
+    print_row("legacy", old_plan, plan_text.size(), iterations);
+    print_row("shared", new_plan, plan_text.size(), iterations);
+
+    const int mapping_iterations = iterations * 50;
+    std::printf("controller mapping: %zu bytes\n", mapping_text.size());
+    const Result old_map = time_parse(mapping_text, mapping_iterations, [&](FILE* file) {
+        config::default_buttons(buttons);
+        legacy_read_buttons(file, buttons);
+        return static_cast<std::size_t>(buttons[0]);
+    });
+    const Result new_map = time_parse(mapping_text, mapping_iterations, [&](FILE* file) {
+        config::default_buttons(buttons);
+        config::read_buttons(file, buttons);
+        return static_cast<std::size_t>(buttons[0]);
+    });
+    print_row("legacy", old_map, mapping_text.size(), mapping_iterations);
+    print_row("shared", new_map, mapping_text.size(), mapping_iterations);
+
+    if (old_plan.checksum != new_plan.checksum || old_map.checksum != new_map.checksum) {
+        std::printf("parsers disagree: %zu vs %zu steps, %zu vs %zu\n", old_plan.checksum, new_plan.checksum,
+                    old_map.checksum, new_map.checksum);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,280 @@
+// Predicts what an auton plan does on the field before it goes on a robot.
+// Each plan file is read with the brain's parser, compiled and run through
+// the plan VM exactly as Tahera runs it, against a kinematic model of the
+// 6WD drive: blue (600 rpm) motors direct on 3.25" wheels, a 12" track, and
+// a first-order lag standing in for the robot's inertia. The clock is
+// simulated, so a 15 s plan takes well under a millisecond.
+//
+// Usage:
+//   plan_sim [-b] [-r] <auton_plans_slotN.txt>...
+//
+// For each section the timeline lists every step with its start and end
+// time and the pose it ends at (x to the right of the start position, y
+// ahead of it, in mm; heading clockwise, like the IMU), then the total time.
+// Steps the 15 s auton budget would cut off are flagged, and the steps after
+// them marked as never reached.
+//
+// -b prints one line per section instead of the timeline, and the rate at
+//    the end, for checking many plan variants at once.
+// -r writes <plan>.gps.csv and <plan>.basic.csv next to each plan, in the
+//    telemetry CSV format bonkers_log_decode writes, so
+//    bonkers_log_to_field.py and the Mac and Windows replay apps show the
+//    predicted path on the field.
+//
+// Exits 1 if any plan does not parse or does not finish in time.
+
+#include "bonkers/drive_geometry.hpp"
+#include "bonkers/plan.hpp"
+#include "bonkers/plan_vm.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+using geometry::kPi;
+using geometry::kTrackWidthMm;
+using geometry::kWheelDiameterMm;
+constexpr double kFreeRpm = 600.0;
+// Loaded speed as a share of free speed: friction and the robot's weight.
+constexpr double kLoadedFraction = 0.8;
+constexpr double kTopSpeedMmPerSec = kFreeRpm / 60.0 * kWheelDiameterMm * kPi * kLoadedFraction;
+// Time for a side to cover 63% of a speed change.
+constexpr double kLagMs = 80.0;
+constexpr std::uint32_t kStepMs = 1;
+constexpr std::uint32_t kReplayPeriodMs = 10;
+constexpr std::uint32_t kAutonMs = 15000;
+
+struct SimRobot {
+    std::uint32_t now_ms = 0;
+    double x_mm = 0;
+    double y_mm = 0;
+    double heading = 0; // degrees, clockwise from the start
+    double left_speed = 0; // wheel surface, mm/s
+    double right_speed = 0;
+    double left_mm = 0;
+    double right_mm = 0;
+    int left = 0;
+    int right = 0;
+    int intake = 0;
+    int outake = 0;
+    FILE* replay = nullptr;
+
+    void drive(int l, int r) {
+        left = l < -127 ? -127 : (l > 127 ? 127 : l);
+        right = r < -127 ? -127 : (r > 127 ? 127 : r);
+    }
+    void stop_all() {
+        left = right = intake = outake = 0;
+    }
+    void step() {
+        const double dt = kStepMs / 1000.0;
+        const double blend = 1.0 - std::exp(-(kStepMs / kLagMs));
+        left_speed += (left * kTopSpeedMmPerSec / 127.0 - left_speed) * blend;
+        right_speed += (right * kTopSpeedMmPerSec / 127.0 - right_speed) * blend;
+
+        const double forward = (left_speed + right_speed) / 2 * dt;
+        const double turn = (left_speed - right_speed) / kTrackWidthMm * dt * 180.0 / kPi;
+        const double mid = (heading + turn / 2) * kPi / 180.0;
+        x_mm += forward * std::sin(mid);
+        y_mm += forward * std::cos(mid);
+        heading = std::fmod(heading + turn + 360.0, 360.0);
+        left_mm += left_speed * dt;
+        right_mm += right_speed * dt;
+        now_ms += kStepMs;
+        if (replay && now_ms % kReplayPeriodMs == 0) {
+            write_row();
+        }
+    }
+    void delay_until(std::uint32_t* prev_ms, std::uint32_t delta_ms) {
+        const std::uint32_t target = *prev_ms + delta_ms;
+        while (now_ms < target) {
+            step();
+        }
+        *prev_ms = target;
+    }
+    // The field viewers drive off axis3 (left) and axis2 (right) as a
+    // percentage of the stick, as in a tank-drive log, so the motor powers
+    // go there scaled from +-127 to +-100.
+    void write_row() const {
+        const double rpm_per_mm_s = 60.0 / (kWheelDiameterMm * kPi);
+        const long left_stick = std::lround(left * 100.0 / 127.0);
+        const long right_stick = std::lround(right * 100.0 / 127.0);
+        std::fprintf(replay, "%.3f,0,%ld,%ld,0,%d,%d,%s,%s,0,%.1f,%.1f,,,%.2f\n", now_ms / 1000.0, right_stick,
+                     left_stick, left, right, intake > 0 ? "IN" : (intake < 0 ? "OUT" : ""),
+                     outake > 0 ? "OUT" : (outake < 0 ? "IN" : ""), left_speed * rpm_per_mm_s,
+                     right_speed * rpm_per_mm_s, heading);
+    }
+};
+
+plan::Robot bind(SimRobot* sim) {
+    return {
+        sim,
+        [](void* ctx, int l, int r) { static_cast<SimRobot*>(ctx)->drive(l, r); },
+        [](void* ctx) { static_cast<SimRobot*>(ctx)->drive(0, 0); },
+        // Both roller motors together, as Tahera's vm_rollers does.
+        [](void* ctx, int power) {
+            SimRobot* sim = static_cast<SimRobot*>(ctx);
+            sim->intake = power;
+            sim->outake = power;
+        },
+        [](void* ctx, int power) { static_cast<SimRobot*>(ctx)->intake = power; },
+        [](void* ctx, int power) { static_cast<SimRobot*>(ctx)->outake = power; },
+        [](void* ctx) { static_cast<SimRobot*>(ctx)->stop_all(); },
+        [](void* ctx) { return static_cast<SimRobot*>(ctx)->heading; },
+        [](void* ctx) { return static_cast<SimRobot*>(ctx)->now_ms; },
+        [](void* ctx, std::uint32_t* prev_ms, std::uint32_t delta_ms) {
+            static_cast<SimRobot*>(ctx)->delay_until(prev_ms, delta_ms);
+        },
+        nullptr,
+        [](void* ctx) { return static_cast<SimRobot*>(ctx)->left_mm; },
+        [](void* ctx) { return static_cast<SimRobot*>(ctx)->right_mm; },
+        kTrackWidthMm,
+        [](void* ctx) { return static_cast<std::uint64_t>(static_cast<SimRobot*>(ctx)->now_ms) * 1000; },
+        nullptr,
+    };
+}
+
+// Instructions that run as one timeline entry: one instruction, or a GROUP
+// with its children.
+std::size_t unit_length(const std::vector<plan::Instr>& program, std::size_t i) {
+    return program[i].op == plan::Op::GROUP ? 1 + program[i].ms : 1;
+}
+
+const char* range_note(const plan::Step& step) {
+    return plan::step_in_range(step) ? "" : "  out of range";
+}
+
+// A GROUP's children, each with the time it starts.
+void print_children(const std::vector<plan::Step>& steps, const std::vector<plan::Instr>& program, std::size_t i,
+                    std::uint32_t start_ms) {
+    for (std::size_t c = i + 1; c < i + unit_length(program, i); ++c) {
+        const plan::Step& step = steps[program[c].step];
+        std::printf("   %4u    %-18s %7.2f%s\n", program[c].step + 1u, plan::step_type_name(step.type),
+                    (start_ms + program[c].at_ms) / 1000.0, range_note(step));
+    }
+}
+
+// Runs one section; returns false if the auton budget cut it off.
+bool simulate(const char* path, const char* name, const std::vector<plan::Step>& steps, bool brief,
+              bool write_replay) {
+    std::vector<plan::Instr> program;
+    plan::compile(steps.data(), steps.size(), &program);
+
+    SimRobot sim;
+    if (write_replay) {
+        const char* suffix = std::strcmp(name, "GPS") == 0 ? ".gps.csv" : ".basic.csv";
+        const std::string replay_path = std::string(path) + suffix;
+        sim.replay = std::fopen(replay_path.c_str(), "w");
+        if (!sim.replay) {
+            std::fprintf(stderr, "%s: cannot write\n", replay_path.c_str());
+        } else {
+            std::fprintf(sim.replay, "time_s,axis1,axis2,axis3,axis4,left_cmd,right_cmd,intake_action,outtake_action,"
+                                     "buttons,left_rpm,right_rpm,left_ma,right_ma,heading_deg\n");
+            sim.write_row();
+        }
+    }
+    const plan::Robot robot = bind(&sim);
+
+    if (!brief) {
+        std::printf("%s [%s] %zu steps, estimate %.2f s\n", path, name, steps.size(),
+                    plan::estimate_ms(program) / 1000.0);
+        std::printf("   step  %-20s %7s %7s %8s %8s %7s\n", "type", "start", "end", "x mm", "y mm", "heading");
+    }
+    bool finished = true;
+    std::size_t cut_step = 0;
+    for (std::size_t i = 0; i < program.size(); i += unit_length(program, i)) {
+        const plan::Step& step = steps[program[i].step];
+        if (!finished) {
+            if (!brief) {
+                std::printf("   %4u  %-20s not reached\n", program[i].step + 1u, plan::step_type_name(step.type));
+            }
+            continue;
+        }
+        const std::uint32_t start_ms = sim.now_ms;
+        const std::vector<plan::Instr> unit(program.begin() + i, program.begin() + i + unit_length(program, i));
+        finished = plan::run(unit, robot, kAutonMs);
+        if (!finished) {
+            cut_step = program[i].step + 1u;
+        }
+        if (!brief) {
+            std::printf("   %4u  %-20s %7.2f %7.2f %8.1f %8.1f %7.1f%s%s\n", program[i].step + 1u,
+                        plan::step_type_name(step.type), start_ms / 1000.0, sim.now_ms / 1000.0, sim.x_mm, sim.y_mm,
+                        sim.heading, range_note(step), finished ? "" : "  CUT OFF at 15 s");
+            if (program[i].op == plan::Op::GROUP) {
+                print_children(steps, program, i, start_ms);
+            }
+        }
+    }
+    if (sim.replay) {
+        std::fclose(sim.replay);
+    }
+
+    if (brief) {
+        std::printf("%s [%s] %.2f s, ends at (%.0f, %.0f) mm heading %.0f", path, name, sim.now_ms / 1000.0, sim.x_mm,
+                    sim.y_mm, sim.heading);
+        if (finished) {
+            std::printf("\n");
+        } else {
+            std::printf("  CUT OFF at step %zu\n", cut_step);
+        }
+    } else {
+        std::printf("   total %.2f s of %.2f s%s\n\n", sim.now_ms / 1000.0, kAutonMs / 1000.0,
+                    finished ? "" : ", did not finish");
+    }
+    return finished;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    bool brief = false;
+    bool write_replay = false;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-b") == 0) {
+            brief = true;
+        } else if (std::strcmp(argv[i], "-r") == 0) {
+            write_replay = true;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty()) {
+        std::fprintf(stderr, "usage: plan_sim [-b] [-r] <plan.txt>...\n");
+        return 2;
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    int failures = 0;
+    std::size_t sections = 0;
+    for (const char* path : paths) {
+        FILE* file = std::fopen(path, "r");
+        if (!file) {
+            std::fprintf(stderr, "%s: cannot open\n", path);
+            ++failures;
+            continue;
+        }
+        std::vector<plan::Step> gps;
+        std::vector<plan::Step> basic;
+        const bool ok = plan::read_plans(file, &gps, &basic, path);
+        std::fclose(file);
+        if (!ok) {
+            std::printf("%s: no steps\n", path);
+            ++failures;
+            continue;
+        }
+        failures += simulate(path, "GPS", gps, brief, write_replay) ? 0 : 1;
+        failures += simulate(path, "BASIC", basic, brief, write_replay) ? 0 : 1;
+        sections += 2;
+    }
+    if (brief) {
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::printf("%zu plans in %.1f ms (%.0f plans/s)\n", sections, seconds * 1000.0,
+                    seconds > 0 ? sections / seconds : 0.0);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,585 @@
+// Checks the plan VM against the step executor it replaced. Each plan runs
+// twice on a simulated robot with a simulated clock: once through
+// plan::compile/plan::run, and once through a copy of Tahera's old
+// per-step switch. The motor commands, with their timestamps, must match
+// exactly, for a full run and for aborts and time budgets landing at many
+// points in the plan.
+//
+// Usage:
+//   plan_vm_check [-n random_plans] [auton_plans_slotN.txt]...
+//
+// Random plans (default 2000) include EMPTY steps, zero and negative
+// durations, out-of-range powers and headings past 360. They use only the
+// step types the old executor knew; plan files with newer types are run
+// through the VM alone. PARALLEL groups are checked against hand-written
+// traces instead, and the closed-loop steps against where the simulated
+// robot ends up, on a full and a weak battery and with one side dragging.
+// Finally a long timed plan runs on a robot whose sleeps all wake late, to
+// check the plan clock does not drift.
+
+#include "bonkers/plan.hpp"
+#include "bonkers/plan_vm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+using plan::Step;
+using plan::StepType;
+
+enum class Event : std::uint8_t { DRIVE, BRAKE_DRIVE, ROLLERS, INTAKE, OUTAKE, STOP_ALL };
+
+struct Entry {
+    std::uint32_t ms;
+    Event event;
+    int a;
+    int b;
+
+    bool operator==(const Entry& other) const {
+        return ms == other.ms && event == other.event && a == other.a && b == other.b;
+    }
+};
+
+// Simulated drive: each side moves kSimMmPerPowerMs per unit of power per
+// ms, times its scale, and the heading follows the difference over
+// kSimTrackMm.
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kSimTrackMm = 150.0;
+constexpr double kSimMmPerPowerMs = 0.005 * kSimTrackMm * kPi / 180.0;
+
+// A drivetrain whose heading follows the left/right power difference, and
+// a clock that only moves on delay(). Powers are clamped like the V5 motor
+// API clamps move().
+struct SimRobot {
+    std::uint32_t now_ms = 0;
+    std::uint32_t abort_ms = 0; // 0: never
+    double heading = 0;
+    double left_mm = 0;
+    double right_mm = 0;
+    double left_scale = 1.0;  // below 1: a weak battery or a dragging side
+    double right_scale = 1.0;
+    std::uint32_t late_ms = 0; // how late every sleep wakes, like a busy scheduler
+    std::uint64_t micros_base = 0; // micros() at now_ms 0; the brain's two clocks start apart
+    int left = 0;
+    int right = 0;
+    std::vector<Entry> trace;
+    std::vector<std::size_t> overruns; // steps reported late
+
+    void drive(int l, int r) {
+        left = std::max(-127, std::min(127, l));
+        right = std::max(-127, std::min(127, r));
+        trace.push_back({now_ms, Event::DRIVE, left, right});
+    }
+    void brake_drive() {
+        left = right = 0;
+        trace.push_back({now_ms, Event::BRAKE_DRIVE, 0, 0});
+    }
+    void rollers(int power) {
+        trace.push_back({now_ms, Event::ROLLERS, std::max(-127, std::min(127, power)), 0});
+    }
+    void intake(int power) {
+        trace.push_back({now_ms, Event::INTAKE, std::max(-127, std::min(127, power)), 0});
+    }
+    void outake(int power) {
+        trace.push_back({now_ms, Event::OUTAKE, std::max(-127, std::min(127, power)), 0});
+    }
+    void stop_all() {
+        left = right = 0;
+        trace.push_back({now_ms, Event::STOP_ALL, 0, 0});
+    }
+    void delay(std::uint32_t requested_ms) {
+        const std::uint32_t ms = requested_ms + late_ms;
+        const double left_step = left * left_scale * kSimMmPerPowerMs * ms;
+        const double right_step = right * right_scale * kSimMmPerPowerMs * ms;
+        heading = std::fmod(heading + (left_step - right_step) / kSimTrackMm * 180.0 / kPi + 360.0, 360.0);
+        left_mm += left_step;
+        right_mm += right_step;
+        now_ms += ms;
+    }
+    void delay_until(std::uint32_t* prev_ms, std::uint32_t delta_ms) {
+        const std::uint32_t target = *prev_ms + delta_ms;
+        if (target > now_ms) {
+            delay(target - now_ms);
+        }
+        *prev_ms = target;
+    }
+    bool aborted() const {
+        return abort_ms != 0 && now_ms >= abort_ms;
+    }
+};
+
+plan::Robot bind(SimRobot* sim) {
+    return {
+        sim,
+        [](void* ctx, int l, int r) { static_cast<SimRobot*>(ctx)->drive(l, r); },
+        [](void* ctx) { static_cast<SimRobot*>(ctx)->brake_drive(); },
+        [](void* ctx, int power) { static_cast<SimRobot*>(ctx)->rollers(power); },
+        [](void* ctx, int power) { static_cast<SimRobot*>(ctx)->intake(power); },
+        [](void* ctx, int power) { static_cast<SimRobot*>(ctx)->outake(power); },
+        [](void* ctx) { static_cast<SimRobot*>(ctx)->stop_all(); },
+        [](void* ctx) { return static_cast<SimRobot*>(ctx)->heading; },
+        [](void* ctx) { return static_cast<SimRobot*>(ctx)->now_ms; },
+        [](void* ctx, std::uint32_t* prev_ms, std::uint32_t delta_ms) {
+            static_cast<SimRobot*>(ctx)->delay_until(prev_ms, delta_ms);
+        },
+        [](void* ctx) { return static_cast<SimRobot*>(ctx)->aborted(); },
+        [](void* ctx) { return static_cast<SimRobot*>(ctx)->left_mm; },
+        [](void* ctx) { return static_cast<SimRobot*>(ctx)->right_mm; },
+        kSimTrackMm,
+        [](void* ctx) {
+            const SimRobot* sim = static_cast<SimRobot*>(ctx);
+            return sim->micros_base + static_cast<std::uint64_t>(sim->now_ms) * 1000;
+        },
+        [](void* ctx, std::size_t step, std::uint32_t) { static_cast<SimRobot*>(ctx)->overruns.push_back(step); },
+    };
+}
+
+// --- The executor from Tahera before the VM, against the simulator. ---
+struct Reference {
+    SimRobot* sim;
+    std::uint32_t end_ms;
+
+    bool auton_time_up() const {
+        return sim->aborted() || (end_ms != 0 && sim->now_ms >= end_ms);
+    }
+
+    bool delay_with_abort(int ms) {
+        const int chunk = 20;
+        int remaining = ms;
+        while (remaining > 0) {
+            if (auton_time_up()) {
+                return false;
+            }
+            sim->delay(static_cast<std::uint32_t>(std::min(chunk, remaining)));
+            remaining -= chunk;
+        }
+        return true;
+    }
+
+    void turn_to_heading(double target, int max_speed) {
+        while (true) {
+            if (auton_time_up()) break;
+            double current = sim->heading;
+            double error = target - current;
+
+            if (error > 180) error -= 360;
+            if (error < -180) error += 360;
+
+            if (std::abs(error) < 2.0) break;
+
+            double kp = 1.5;
+            int speed = error * kp;
+
+            if (speed > max_speed) speed = max_speed;
+            if (speed < -max_speed) speed = -max_speed;
+
+            sim->drive(speed, -speed);
+            sim->delay(20);
+        }
+        sim->brake_drive();
+    }
+
+    void run(const std::vector<Step>& steps) {
+        for (const auto& step : steps) {
+            if (auton_time_up()) break;
+            switch (step.type) {
+                case StepType::EMPTY:
+                    break;
+                case StepType::DRIVE_MS:
+                    sim->drive(step.value1, step.value1);
+                    if (!delay_with_abort(step.value2)) {
+                        sim->stop_all();
+                        break;
+                    }
+                    sim->brake_drive();
+                    break;
+                case StepType::TANK_MS:
+                    sim->drive(step.value1, step.value2);
+                    if (!delay_with_abort(step.value3)) {
+                        sim->stop_all();
+                        break;
+                    }
+                    sim->brake_drive();
+                    break;
+                case StepType::TURN_HEADING:
+                    turn_to_heading(step.value1, 60);
+                    break;
+                case StepType::WAIT_MS:
+                    if (!delay_with_abort(step.value1)) {
+                        sim->stop_all();
+                        break;
+                    }
+                    break;
+                case StepType::INTAKE_ON:
+                    sim->rollers(127);
+                    break;
+                case StepType::INTAKE_OFF:
+                    sim->rollers(0);
+                    break;
+                case StepType::OUTTAKE_ON:
+                    sim->rollers(-127);
+                    break;
+                case StepType::OUTTAKE_OFF:
+                    sim->rollers(0);
+                    break;
+                default:
+                    break;
+            }
+            if (auton_time_up()) break;
+        }
+    }
+};
+
+struct Scenario {
+    std::uint32_t end_ms;
+    std::uint32_t abort_ms;
+};
+
+bool same_run(const std::vector<Step>& steps, const std::vector<plan::Instr>& program, const Scenario& scenario,
+              const char* name) {
+    SimRobot old_sim;
+    old_sim.abort_ms = scenario.abort_ms;
+    Reference reference{&old_sim, scenario.end_ms};
+    reference.run(steps);
+
+    SimRobot vm_sim;
+    vm_sim.abort_ms = scenario.abort_ms;
+    plan::run(program, bind(&vm_sim), scenario.end_ms);
+
+    if (old_sim.trace == vm_sim.trace && old_sim.now_ms == vm_sim.now_ms) {
+        return true;
+    }
+    std::printf("%s: budget %u ms, abort at %u ms: traces differ\n", name, scenario.end_ms, scenario.abort_ms);
+    const std::size_t count = std::max(old_sim.trace.size(), vm_sim.trace.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        const bool have_old = i < old_sim.trace.size();
+        const bool have_vm = i < vm_sim.trace.size();
+        if (have_old && have_vm && old_sim.trace[i] == vm_sim.trace[i]) {
+            continue;
+        }
+        const Entry none{0, Event::DRIVE, 0, 0};
+        const Entry& a = have_old ? old_sim.trace[i] : none;
+        const Entry& b = have_vm ? vm_sim.trace[i] : none;
+        std::printf("  event %zu: old %s{%u ms, %d, %d, %d} vm %s{%u ms, %d, %d, %d}\n", i, have_old ? "" : "missing",
+                    a.ms, static_cast<int>(a.event), a.a, a.b, have_vm ? "" : "missing", b.ms,
+                    static_cast<int>(b.event), b.a, b.b);
+        break;
+    }
+    return false;
+}
+
+// A full run, then aborts and budgets every 7 ms up to just past its end.
+int check_plan(const std::vector<Step>& steps, const char* name) {
+    std::vector<plan::Instr> program;
+    plan::compile(steps.data(), steps.size(), &program);
+
+    SimRobot full;
+    plan::run(program, bind(&full), 15000);
+    int failures = same_run(steps, program, {15000, 0}, name) ? 0 : 1;
+    for (std::uint32_t t = 1; t <= full.now_ms + 20 && failures == 0; t += 7) {
+        failures += same_run(steps, program, {t, 0}, name) ? 0 : 1;
+        failures += same_run(steps, program, {15000, t}, name) ? 0 : 1;
+    }
+    return failures;
+}
+
+// EMPTY through OUTTAKE_OFF: the types the old executor ran.
+constexpr int kLegacyStepTypes = 9;
+
+bool legacy_only(const std::vector<Step>& steps) {
+    return std::all_of(steps.begin(), steps.end(),
+                       [](const Step& step) { return static_cast<int>(step.type) < kLegacyStepTypes; });
+}
+
+std::vector<Step> random_plan(std::mt19937* rng) {
+    std::uniform_int_distribution<int> length(0, 12);
+    std::uniform_int_distribution<int> type(0, kLegacyStepTypes - 1);
+    std::uniform_int_distribution<int> power(-160, 160);
+    std::uniform_int_distribution<int> ms(-50, 900);
+    std::uniform_int_distribution<int> heading(-400, 720);
+    std::vector<Step> steps(static_cast<std::size_t>(length(*rng)));
+    for (Step& step : steps) {
+        step.type = static_cast<StepType>(type(*rng));
+        switch (step.type) {
+            case StepType::DRIVE_MS:
+                step = {step.type, power(*rng), ms(*rng), 0};
+                break;
+            case StepType::TANK_MS:
+                step = {step.type, power(*rng), power(*rng), ms(*rng)};
+                break;
+            case StepType::TURN_HEADING:
+                step = {step.type, heading(*rng), 0, 0};
+                break;
+            case StepType::WAIT_MS:
+                step = {step.type, ms(*rng), 0, 0};
+                break;
+            default:
+                step = {step.type, 0, 0, 0};
+                break;
+        }
+    }
+    return steps;
+}
+// --- PARALLEL groups, against traces worked out by hand. ---
+struct TimelineCase {
+    const char* name;
+    std::vector<Step> steps;
+    std::uint32_t end_ms;
+    std::vector<Entry> expected;
+    std::uint32_t expected_ms;
+};
+
+std::vector<TimelineCase> timeline_cases() {
+    const Step drive_and_intake[] = {
+        {StepType::PARALLEL, 0, 0, 0},
+        {StepType::DRIVE_MS, 80, 1200, 0},
+        {StepType::INTAKE_FOR_MS, 127, 800, 0},
+        {StepType::END_PARALLEL, 0, 0, 0},
+    };
+    const std::vector<Step> drive_and_intake_steps(std::begin(drive_and_intake), std::end(drive_and_intake));
+    return {
+        {"drive while intaking",
+         drive_and_intake_steps,
+         15000,
+         {{0, Event::DRIVE, 80, 80}, {0, Event::INTAKE, 127, 0}, {800, Event::INTAKE, 0, 0},
+          {1200, Event::BRAKE_DRIVE, 0, 0}},
+         1200},
+        {"start offsets",
+         {{StepType::PARALLEL, 0, 0, 0},
+          {StepType::INTAKE_FOR_MS, 127, 300, 500},
+          {StepType::OUTAKE_FOR_MS, -127, 200, 0},
+          {StepType::WAIT_MS, 1000, 0, 0}},
+         15000,
+         {{0, Event::OUTAKE, -127, 0}, {200, Event::OUTAKE, 0, 0}, {500, Event::INTAKE, 127, 0},
+          {800, Event::INTAKE, 0, 0}},
+         1000},
+        {"later drive takes the wheels",
+         {{StepType::PARALLEL, 0, 0, 0},
+          {StepType::DRIVE_MS, 80, 1000, 0},
+          {StepType::DRIVE_MS, -50, 300, 400},
+          {StepType::END_PARALLEL, 0, 0, 0},
+          {StepType::INTAKE_ON, 0, 0, 0}},
+         15000,
+         {{0, Event::DRIVE, 80, 80}, {400, Event::DRIVE, -50, -50}, {700, Event::BRAKE_DRIVE, 0, 0},
+          {1000, Event::ROLLERS, 127, 0}},
+         1000},
+        {"rollers take over a timed intake",
+         {{StepType::PARALLEL, 0, 0, 0},
+          {StepType::INTAKE_FOR_MS, 100, 2000, 0},
+          {StepType::INTAKE_ON, 127, 0, 500},
+          {StepType::END_PARALLEL, 0, 0, 0}},
+         15000,
+         {{0, Event::INTAKE, 100, 0}, {500, Event::ROLLERS, 127, 0}},
+         2000},
+        {"budget ends mid-group",
+         drive_and_intake_steps,
+         600,
+         {{0, Event::DRIVE, 80, 80}, {0, Event::INTAKE, 127, 0}, {600, Event::STOP_ALL, 0, 0}},
+         600},
+    };
+}
+
+int check_timelines() {
+    int failures = 0;
+    for (const TimelineCase& test : timeline_cases()) {
+        std::vector<plan::Instr> program;
+        plan::compile(test.steps.data(), test.steps.size(), &program);
+        SimRobot sim;
+        plan::run(program, bind(&sim), test.end_ms);
+        if (sim.trace == test.expected && sim.now_ms == test.expected_ms) {
+            continue;
+        }
+        ++failures;
+        std::printf("%s: ran for %u ms (expected %u):\n", test.name, sim.now_ms, test.expected_ms);
+        for (const Entry& entry : sim.trace) {
+            std::printf("  %u ms: event %d, %d, %d\n", entry.ms, static_cast<int>(entry.event), entry.a, entry.b);
+        }
+    }
+
+    // The same steps without the PARALLEL markers run one after another.
+    const std::vector<Step> grouped = timeline_cases()[0].steps;
+    const std::vector<Step> sequential(grouped.begin() + 1, grouped.end() - 1);
+    std::vector<plan::Instr> program;
+    plan::compile(grouped.data(), grouped.size(), &program);
+    const std::uint32_t parallel_ms = plan::estimate_ms(program);
+    plan::compile(sequential.data(), sequential.size(), &program);
+    std::printf("drive while intaking: %u ms in a group, %u ms in sequence\n", parallel_ms,
+                plan::estimate_ms(program));
+    return failures;
+}
+// --- Closed-loop steps, against where the robot ends up. ---
+struct MotionCase {
+    const char* name;
+    Step step;
+    double distance_mm; // expected center travel
+    double turn_deg;    // expected heading change
+};
+
+struct Drivetrain {
+    const char* name;
+    double left_scale;
+    double right_scale;
+};
+
+double heading_change(double from, double to) {
+    double change = std::fmod(to - from, 360.0);
+    if (change > 180) change -= 360;
+    if (change < -180) change += 360;
+    return change;
+}
+
+int check_closed_loop() {
+    const MotionCase cases[] = {
+        {"DRIVE_DIST 600", {StepType::DRIVE_DIST, 600, 0, 0}, 600, 0},
+        {"DRIVE_DIST -450 at 60", {StepType::DRIVE_DIST, -450, 60, 0}, -450, 0},
+        {"TURN_RELATIVE 90", {StepType::TURN_RELATIVE, 90, 0, 0}, 0, 90},
+        {"TURN_RELATIVE -135", {StepType::TURN_RELATIVE, -135, 0, 0}, 0, -135},
+        {"ARC 90 r500", {StepType::ARC, 90, 500, 0}, 500 * kPi / 2, 90},
+        {"ARC -45 r800", {StepType::ARC, -45, 800, 0}, 800 * kPi / 4, -45},
+    };
+    const Drivetrain drivetrains[] = {{"full battery", 1.0, 1.0}, {"weak battery", 0.7, 0.7}, {"left drags", 0.85, 1.0}};
+
+    int failures = 0;
+    for (const MotionCase& test : cases) {
+        std::vector<plan::Instr> program;
+        plan::compile(&test.step, 1, &program);
+        for (const Drivetrain& drivetrain : drivetrains) {
+            SimRobot sim;
+            sim.heading = 100;
+            sim.left_scale = drivetrain.left_scale;
+            sim.right_scale = drivetrain.right_scale;
+            const bool finished = plan::run(program, bind(&sim), 15000);
+            const double travelled = (sim.left_mm + sim.right_mm) / 2;
+            const double turned = heading_change(100, sim.heading);
+            const bool ok = finished && sim.now_ms < program[0].ms &&
+                            std::abs(travelled - test.distance_mm) <= std::max(plan::kDriveToleranceMm,
+                                                                               0.02 * std::abs(test.distance_mm)) &&
+                            std::abs(turned - test.turn_deg) <= 2 * plan::kTurnSettleDeg;
+            std::printf("%-22s %-13s %5u ms  %7.1f mm  %6.1f deg%s\n", test.name, drivetrain.name, sim.now_ms,
+                        travelled, turned, ok ? "" : "  FAILED");
+            failures += ok ? 0 : 1;
+        }
+    }
+
+    // The open-loop step these replace covers less ground on a weak battery.
+    const Step timed{StepType::DRIVE_MS, 80, 1000, 0};
+    std::vector<plan::Instr> program;
+    plan::compile(&timed, 1, &program);
+    for (const Drivetrain& drivetrain : drivetrains) {
+        SimRobot sim;
+        sim.left_scale = drivetrain.left_scale;
+        sim.right_scale = drivetrain.right_scale;
+        plan::run(program, bind(&sim), 15000);
+        std::printf("%-22s %-13s %5u ms  %7.1f mm  %6.1f deg\n", "DRIVE_MS 80,1000", drivetrain.name, sim.now_ms,
+                    (sim.left_mm + sim.right_mm) / 2, heading_change(0, sim.heading));
+    }
+    return failures;
+}
+// --- The plan clock, on a robot whose every sleep wakes late. ---
+// The steps are ones the old executor knew, so it can run them too.
+// Each boundary of a timed plan must land at most one wake-up's lateness
+// after where it lands on a punctual robot, however many steps came before.
+int check_drift() {
+    std::vector<Step> steps;
+    std::uint32_t planned_ms = 0;
+    for (int i = 0; i < 15; ++i) {
+        steps.push_back({StepType::DRIVE_MS, 60, 310, 0});
+        steps.push_back({StepType::WAIT_MS, 125, 0, 0});
+        steps.push_back({StepType::TANK_MS, 40, -40, 240});
+        planned_ms += 310 + 125 + 240;
+    }
+    std::vector<plan::Instr> program;
+    plan::compile(steps.data(), steps.size(), &program);
+
+    SimRobot punctual;
+    plan::run(program, bind(&punctual), 0);
+
+    int failures = 0;
+    for (std::uint32_t late : {0u, 1u, 3u}) {
+        SimRobot vm_sim;
+        vm_sim.late_ms = late;
+        // micros() runs seconds ahead of millis(), so overruns are only
+        // reported right if they are measured against the run's own start.
+        vm_sim.micros_base = 7000000;
+        plan::run(program, bind(&vm_sim), 0);
+        std::uint32_t worst = 0;
+        bool ok = vm_sim.trace.size() == punctual.trace.size();
+        for (std::size_t i = 0; ok && i < vm_sim.trace.size(); ++i) {
+            const std::uint32_t on_time = punctual.trace[i].ms;
+            ok = vm_sim.trace[i].ms >= on_time && vm_sim.trace[i].ms - on_time <= late;
+            worst = std::max(worst, vm_sim.trace[i].ms - on_time);
+        }
+        // Reports only once a wake is more than a tick late.
+        ok = ok && vm_sim.overruns.size() == (late * 1000 > plan::kOverrunReportUs ? steps.size() : 0);
+
+        SimRobot old_sim;
+        old_sim.late_ms = late;
+        Reference reference{&old_sim, 0};
+        reference.run(steps);
+
+        std::printf("%zu timed steps, %u ms planned, sleeps %u ms late: VM ends %+d ms (worst boundary +%u ms, "
+                    "%zu overrun reports), old executor ends %+d ms%s\n",
+                    steps.size(), planned_ms, late, static_cast<int>(vm_sim.now_ms - planned_ms), worst,
+                    vm_sim.overruns.size(), static_cast<int>(old_sim.now_ms - planned_ms), ok ? "" : "  FAILED");
+        failures += ok ? 0 : 1;
+    }
+    return failures;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int random_plans = 2000;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            random_plans = std::atoi(argv[++i]);
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    int failures = 0;
+    for (const char* path : paths) {
+        FILE* file = std::fopen(path, "r");
+        std::vector<Step> gps;
+        std::vector<Step> basic;
+        if (!plan::read_plans(file, &gps, &basic, path)) {
+            std::fprintf(stderr, "%s: no steps\n", path);
+            ++failures;
+        }
+        if (file) {
+            std::fclose(file);
+        }
+        for (const std::vector<Step>* steps : {&gps, &basic}) {
+            if (legacy_only(*steps)) {
+                failures += check_plan(*steps, path);
+            } else {
+                std::vector<plan::Instr> program;
+                plan::compile(steps->data(), steps->size(), &program);
+                SimRobot sim;
+                const bool finished = plan::run(program, bind(&sim), 15000);
+                std::printf("%s: has newer step types, not compared; VM ran %u ms%s\n", path, sim.now_ms,
+                            finished ? "" : " and was cut off");
+            }
+        }
+    }
+
+    failures += check_timelines();
+    failures += check_closed_loop();
+    failures += check_drift();
+
+    std::mt19937 rng(20240611);
+    for (int i = 0; i < random_plans; ++i) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "random plan %d", i);
+        failures += check_plan(random_plan(&rng), name);
+    }
+    std::printf("%zu files, %d random plans: %d mismatches\n", paths.size(), random_plans, failures);
+    return failures == 0 ? 0 : 1;
+}
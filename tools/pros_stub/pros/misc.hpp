@@ -0,0 +1,13 @@
+#pragma once
+
+// Host stand-in for PROS's microSD queries. The card is the current
+// directory: "/usd/..." paths do not exist on the host, "usd/..." ones can.
+
+#include <cstdint>
+
+namespace pros {
+namespace usd {
+std::int32_t is_installed();
+std::int32_t list_files(const char* path, char* buffer, std::int32_t len);
+} // namespace usd
+} // namespace pros
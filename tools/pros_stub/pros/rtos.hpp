@@ -0,0 +1,27 @@
+#pragma once
+
+// Host stand-in for PROS's clocks and mutex, backed by std::chrono and
+// std::mutex.
+
+#include <cstdint>
+#include <mutex>
+
+namespace pros {
+class Mutex {
+    public:
+        bool take() {
+            m_mutex.lock();
+            return true;
+        }
+        bool take(std::uint32_t) { return take(); }
+        bool give() {
+            m_mutex.unlock();
+            return true;
+        }
+    private:
+        std::mutex m_mutex;
+};
+
+std::uint32_t millis();
+std::uint64_t micros();
+} // namespace pros
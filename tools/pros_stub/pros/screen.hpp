@@ -0,0 +1,15 @@
+#pragma once
+
+// Host stand-in for the parts of PROS's screen API the shared library uses.
+// Calls are counted and drawn into a host framebuffer; see pros_stub.hpp.
+
+#include <cstdint>
+
+namespace pros {
+namespace screen {
+std::uint32_t set_pen(std::uint32_t color);
+std::uint32_t draw_pixel(const std::int16_t x, const std::int16_t y);
+std::uint32_t copy_area(const std::int16_t x0, const std::int16_t y0, const std::int16_t x1, const std::int16_t y1,
+                        uint32_t* buf, const std::int32_t stride);
+} // namespace screen
+} // namespace pros
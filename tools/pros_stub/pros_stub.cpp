@@ -0,0 +1,84 @@
+#include "pros_stub.hpp"
+
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+#include "pros/screen.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace stub {
+namespace {
+Screen g_screen{};
+bool g_sd_installed = true;
+const auto g_start = std::chrono::steady_clock::now();
+} // namespace
+
+Screen& screen() {
+    return g_screen;
+}
+
+void reset_screen() {
+    std::memset(&g_screen, 0, sizeof(g_screen));
+}
+
+void set_sd_installed(bool installed) {
+    g_sd_installed = installed;
+}
+} // namespace stub
+
+namespace pros {
+std::uint32_t millis() {
+    return static_cast<std::uint32_t>(micros() / 1000);
+}
+
+std::uint64_t micros() {
+    const auto elapsed = std::chrono::steady_clock::now() - stub::g_start;
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+namespace screen {
+std::uint32_t set_pen(std::uint32_t color) {
+    ++stub::screen().set_pen_calls;
+    stub::screen().pen = color;
+    return 1;
+}
+
+std::uint32_t draw_pixel(const std::int16_t x, const std::int16_t y) {
+    stub::Screen& screen = stub::screen();
+    ++screen.draw_pixel_calls;
+    if (x >= 0 && x < stub::kScreenW && y >= 0 && y < stub::kScreenH) {
+        screen.frame[y * stub::kScreenW + x] = screen.pen;
+        ++screen.pixels;
+    }
+    return 1;
+}
+
+std::uint32_t copy_area(const std::int16_t x0, const std::int16_t y0, const std::int16_t x1, const std::int16_t y1,
+                        uint32_t* buf, const std::int32_t stride) {
+    stub::Screen& screen = stub::screen();
+    ++screen.copy_area_calls;
+    for (int y = std::max<int>(y0, 0); y <= std::min<int>(y1, stub::kScreenH - 1); ++y) {
+        for (int x = std::max<int>(x0, 0); x <= std::min<int>(x1, stub::kScreenW - 1); ++x) {
+            screen.frame[y * stub::kScreenW + x] = buf[(y - y0) * stride + (x - x0)];
+            ++screen.pixels;
+        }
+    }
+    return 1;
+}
+} // namespace screen
+
+namespace usd {
+std::int32_t is_installed() {
+    return stub::g_sd_installed ? 1 : 0;
+}
+
+std::int32_t list_files(const char*, char* buffer, std::int32_t len) {
+    if (buffer && len > 0) {
+        buffer[0] = '\0';
+    }
+    return 0;
+}
+} // namespace usd
+} // namespace pros
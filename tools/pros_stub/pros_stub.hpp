@@ -0,0 +1,28 @@
+#pragma once
+
+// Controls and counters for the host PROS stubs in pros_stub/pros/, for the
+// checks and benchmarks that link the brain's screen and SD code.
+
+#include <cstdint>
+
+namespace stub {
+constexpr int kScreenW = 480;
+constexpr int kScreenH = 240;
+
+struct Screen {
+    std::uint32_t copy_area_calls;
+    std::uint32_t set_pen_calls;
+    std::uint32_t draw_pixel_calls;
+    std::uint32_t pen;
+    std::uint64_t pixels;                     // pixels drawn, clipped to the screen
+    std::uint32_t frame[kScreenW * kScreenH]; // what was drawn, XRGB
+};
+
+Screen& screen();
+
+// Zeroes the counters and the framebuffer.
+void reset_screen();
+
+// What pros::usd::is_installed() reports; true to start with.
+void set_sd_installed(bool installed);
+} // namespace stub
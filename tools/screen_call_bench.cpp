@@ -0,0 +1,220 @@
+// Counts the pros::screen calls it takes to draw an image, before and after
+// the Auton Planner moved to row batching. "Before" is the old
+// draw_bmp_from_sd() loop, one set_pen and one draw_pixel per pixel; "after"
+// is image::draw_image(), one copy_area per row. Both run on the host
+// against the screen stub, which counts every call, and both must leave the
+// same picture on the stub screen.
+//
+// Usage:
+//   screen_call_bench [-n iterations] [image.bmp|image.vbi]...
+//
+// Without files, a full-screen, a small and an oversized 24-bit BMP and a
+// full-screen 32-bit BMP are generated. The old loop only read 24-bit BMPs
+// and cropped larger ones instead of scaling them, so only 24-bit images
+// that fit the screen get a "before" column. Times are host times per draw
+// and only show the relative cost of the call pattern.
+
+#include "bonkers/image_decoder.hpp"
+#include "pros/screen.hpp"
+#include "pros_stub.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+struct Result {
+    bool ok = false;
+    std::uint32_t calls = 0;
+    double micros = 0;
+};
+
+void put_le(std::vector<std::uint8_t>* out, std::uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out->push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+}
+
+void write_bmp(const fs::path& path, int width, int height, int bpp) {
+    const std::uint32_t row_size = ((static_cast<std::uint32_t>(bpp / 8) * width + 3) / 4) * 4;
+    std::vector<std::uint8_t> bytes = {'B', 'M'};
+    put_le(&bytes, 54 + row_size * height, 4);
+    put_le(&bytes, 0, 4);
+    put_le(&bytes, 54, 4);
+    put_le(&bytes, 40, 4);
+    put_le(&bytes, static_cast<std::uint32_t>(width), 4);
+    put_le(&bytes, static_cast<std::uint32_t>(height), 4);
+    put_le(&bytes, 1, 2);
+    put_le(&bytes, static_cast<std::uint32_t>(bpp), 2);
+    put_le(&bytes, 0, 4);
+    put_le(&bytes, row_size * height, 4);
+    put_le(&bytes, 2835, 4);
+    put_le(&bytes, 2835, 4);
+    put_le(&bytes, 0, 4);
+    put_le(&bytes, 0, 4);
+    for (int row = 0; row < height; ++row) {
+        const std::size_t start = bytes.size();
+        for (int x = 0; x < width; ++x) {
+            put_le(&bytes, static_cast<std::uint32_t>(((x * 5) & 0xFF) << 16 | ((row * 3) & 0xFF) << 8 | (x ^ row)),
+                   bpp / 8);
+        }
+        bytes.resize(start + row_size, 0);
+    }
+    FILE* file = std::fopen(path.string().c_str(), "wb");
+    std::fwrite(bytes.data(), 1, bytes.size(), file);
+    std::fclose(file);
+}
+
+// The Auton Planner's draw_bmp_from_sd() before row batching, minus the
+// path probing.
+bool draw_per_pixel(FILE* file, int x, int y) {
+    std::uint8_t header[54];
+    if (std::fread(header, 1, sizeof(header), file) != sizeof(header)) {
+        return false;
+    }
+    std::uint32_t data_offset;
+    std::int32_t width;
+    std::int32_t height;
+    std::uint16_t bpp;
+    std::uint32_t compression;
+    std::memcpy(&data_offset, &header[10], 4);
+    std::memcpy(&width, &header[18], 4);
+    std::memcpy(&height, &header[22], 4);
+    std::memcpy(&bpp, &header[28], 2);
+    std::memcpy(&compression, &header[30], 4);
+    if (bpp != 24 || compression != 0 || width <= 0 || height == 0) {
+        return false;
+    }
+
+    const std::int32_t abs_height = std::abs(height);
+    const std::uint32_t row_size = ((bpp * width + 31) / 32) * 4;
+    std::vector<std::uint8_t> row(row_size);
+    std::fseek(file, static_cast<long>(data_offset), SEEK_SET);
+    for (std::int32_t row_idx = 0; row_idx < abs_height; ++row_idx) {
+        if (std::fread(row.data(), 1, row_size, file) != row_size) {
+            break;
+        }
+        const std::int32_t draw_y = height > 0 ? (abs_height - 1 - row_idx) : row_idx;
+        for (std::int32_t col = 0; col < width; ++col) {
+            const std::size_t idx = static_cast<std::size_t>(col * 3);
+            const std::uint32_t color = (static_cast<std::uint32_t>(row[idx + 2]) << 16) |
+                                        (static_cast<std::uint32_t>(row[idx + 1]) << 8) | row[idx];
+            pros::screen::set_pen(color);
+            pros::screen::draw_pixel(static_cast<std::int16_t>(x + col), static_cast<std::int16_t>(y + draw_y));
+        }
+    }
+    return true;
+}
+
+bool fits_screen(const char* path) {
+    FILE* file = std::fopen(path, "rb");
+    image::ImageHeader header{};
+    const bool ok = file && image::read_header(file, &header) && header.format == image::Format::BMP &&
+                    header.bmp.bpp == 24 && header.bmp.width <= image::kScreenW &&
+                    header.bmp.height <= image::kScreenH;
+    if (file) {
+        std::fclose(file);
+    }
+    return ok;
+}
+
+template <typename Draw>
+Result measure(const char* path, int iterations, Draw draw) {
+    Result result;
+    double total_us = 0;
+    for (int i = 0; i < iterations; ++i) {
+        FILE* file = std::fopen(path, "rb");
+        if (!file) {
+            return result;
+        }
+        stub::reset_screen();
+        const auto start = std::chrono::steady_clock::now();
+        result.ok = draw(file);
+        total_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        std::fclose(file);
+    }
+    const stub::Screen& screen = stub::screen();
+    result.calls = screen.copy_area_calls + screen.set_pen_calls + screen.draw_pixel_calls;
+    result.micros = total_us / iterations;
+    return result;
+}
+
+std::vector<std::uint32_t> snapshot() {
+    const stub::Screen& screen = stub::screen();
+    return std::vector<std::uint32_t>(screen.frame, screen.frame + stub::kScreenW * stub::kScreenH);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = 20;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (iterations < 1) {
+        std::fprintf(stderr, "usage: screen_call_bench [-n iterations] [image.bmp|image.vbi]...\n");
+        return 2;
+    }
+
+    fs::path generated;
+    if (paths.empty()) {
+        generated = fs::temp_directory_path() / "bonkers_screen_call_bench";
+        fs::create_directories(generated);
+        const struct {
+            const char* name;
+            int width;
+            int height;
+            int bpp;
+        } kImages[] = {{"full_480x240.bmp", 480, 240, 24},
+                       {"small_200x100.bmp", 200, 100, 24},
+                       {"oversized_960x480.bmp", 960, 480, 24},
+                       {"full_480x240_32bpp.bmp", 480, 240, 32}};
+        for (const auto& spec : kImages) {
+            write_bmp(generated / spec.name, spec.width, spec.height, spec.bpp);
+            paths.push_back((generated / spec.name).string());
+        }
+    }
+
+    int failures = 0;
+    std::printf("%-28s %12s %10s %8s %12s %10s\n", "image", "before calls", "after", "ratio", "before us", "after us");
+    for (const std::string& path : paths) {
+        const Result after =
+            measure(path.c_str(), iterations, [](FILE* file) { return image::draw_image(file, 0, 0); });
+        const std::vector<std::uint32_t> batched = snapshot();
+        const std::string name = fs::path(path).filename().string();
+        if (!after.ok) {
+            std::printf("%-28s not a readable BMP or VBI\n", name.c_str());
+            ++failures;
+            continue;
+        }
+        if (!fits_screen(path.c_str())) {
+            std::printf("%-28s %12s %10u %8s %12s %10.0f\n", name.c_str(), "-", after.calls, "-", "-",
+                        after.micros);
+            continue;
+        }
+        const Result before =
+            measure(path.c_str(), iterations, [](FILE* file) { return draw_per_pixel(file, 0, 0); });
+        if (snapshot() != batched) {
+            std::printf("%-28s the two draws left different pictures\n", name.c_str());
+            ++failures;
+            continue;
+        }
+        std::printf("%-28s %12u %10u %7.0fx %12.0f %10.0f\n", name.c_str(), before.calls, after.calls,
+                    static_cast<double>(before.calls) / after.calls, before.micros, after.micros);
+    }
+    if (!generated.empty()) {
+        fs::remove_all(generated);
+    }
+    return failures > 0 ? 1 : 0;
+}
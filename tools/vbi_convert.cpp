@@ -0,0 +1,326 @@
+// Batch-converts BMP images to the brain's screen-native .vbi format.
+//
+// Usage:
+//   vbi_convert [-j threads] [-o out_dir] [--raw] <image.bmp | dir>...
+//
+// Every input is resized to 480x240 (area-averaged when shrinking), packed
+// to RGB565 and row RLE-compressed. Directories are scanned for *.bmp;
+// hidden/AppleDouble files are skipped. Output goes next to the input
+// unless -o is given.
+
+#include "bonkers/vbi_format.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr int kOutW = vbi::kMaxWidth;
+constexpr int kOutH = vbi::kMaxHeight;
+
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint32_t> pixels; // XRGB, top-down
+};
+
+std::uint32_t read_u32(const std::vector<std::uint8_t>& b, std::size_t off) {
+    return static_cast<std::uint32_t>(b[off]) | (static_cast<std::uint32_t>(b[off + 1]) << 8) |
+           (static_cast<std::uint32_t>(b[off + 2]) << 16) | (static_cast<std::uint32_t>(b[off + 3]) << 24);
+}
+
+int mask_shift(std::uint32_t mask) {
+    int shift = 0;
+    while (mask && ((mask >> shift) & 1U) == 0) {
+        ++shift;
+    }
+    return shift;
+}
+
+std::uint32_t mask_to8(std::uint32_t pixel, std::uint32_t mask) {
+    if (mask == 0) {
+        return 0;
+    }
+    const int shift = mask_shift(mask);
+    const std::uint32_t max = mask >> shift;
+    return (((pixel & mask) >> shift) * 255U + max / 2) / max;
+}
+
+bool load_bmp(const fs::path& path, Image* out, std::string* error) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 54 || bytes[0] != 'B' || bytes[1] != 'M') {
+        *error = "not a BMP";
+        return false;
+    }
+
+    const std::uint32_t data_offset = read_u32(bytes, 10);
+    const std::int32_t width = static_cast<std::int32_t>(read_u32(bytes, 18));
+    const std::int32_t raw_height = static_cast<std::int32_t>(read_u32(bytes, 22));
+    const std::uint16_t bpp = static_cast<std::uint16_t>(bytes[28] | (bytes[29] << 8));
+    const std::uint32_t compression = read_u32(bytes, 30);
+    if ((bpp != 24 && bpp != 32) || width <= 0 || raw_height == 0 ||
+        !(compression == 0 || (compression == 3 && bpp == 32))) {
+        *error = "unsupported BMP (need 24/32-bit BI_RGB or 32-bit BI_BITFIELDS)";
+        return false;
+    }
+
+    std::uint32_t masks[3] = {0x00FF0000, 0x0000FF00, 0x000000FF};
+    if (compression == 3) {
+        if (bytes.size() < 66) {
+            *error = "truncated BI_BITFIELDS header";
+            return false;
+        }
+        for (int i = 0; i < 3; ++i) {
+            masks[i] = read_u32(bytes, 54 + i * 4);
+        }
+    }
+
+    const bool top_down = raw_height < 0;
+    const int height = top_down ? -raw_height : raw_height;
+    const std::size_t bytes_pp = bpp / 8;
+    const std::size_t row_size = ((bytes_pp * width + 3) / 4) * 4;
+    if (data_offset + row_size * height > bytes.size()) {
+        *error = "truncated pixel data";
+        return false;
+    }
+
+    out->width = width;
+    out->height = height;
+    out->pixels.assign(static_cast<std::size_t>(width) * height, 0);
+    for (int row = 0; row < height; ++row) {
+        const std::uint8_t* src = &bytes[data_offset + row_size * row];
+        const int y = top_down ? row : height - 1 - row;
+        std::uint32_t* dst = &out->pixels[static_cast<std::size_t>(y) * width];
+        for (int x = 0; x < width; ++x) {
+            const std::uint8_t* p = src + x * bytes_pp;
+            if (bpp == 32) {
+                const std::uint32_t px = static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+                                         (static_cast<std::uint32_t>(p[2]) << 16) |
+                                         (static_cast<std::uint32_t>(p[3]) << 24);
+                dst[x] = (mask_to8(px, masks[0]) << 16) | (mask_to8(px, masks[1]) << 8) | mask_to8(px, masks[2]);
+            } else {
+                dst[x] = (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[1]) << 8) | p[0];
+            }
+        }
+    }
+    return true;
+}
+
+// Each output pixel averages the source pixels whose centers fall inside
+// its footprint; when upscaling no center falls inside and the nearest
+// source pixel is used.
+Image resize(const Image& src, int out_w, int out_h) {
+    Image out;
+    out.width = out_w;
+    out.height = out_h;
+    out.pixels.resize(static_cast<std::size_t>(out_w) * out_h);
+    for (int y = 0; y < out_h; ++y) {
+        int y0 = (y * src.height) / out_h;
+        int y1 = ((y + 1) * src.height) / out_h;
+        if (y1 <= y0) y1 = y0 + 1;
+        for (int x = 0; x < out_w; ++x) {
+            int x0 = (x * src.width) / out_w;
+            int x1 = ((x + 1) * src.width) / out_w;
+            if (x1 <= x0) x1 = x0 + 1;
+            std::uint32_t r = 0;
+            std::uint32_t g = 0;
+            std::uint32_t b = 0;
+            for (int sy = y0; sy < y1; ++sy) {
+                const std::uint32_t* row = &src.pixels[static_cast<std::size_t>(sy) * src.width];
+                for (int sx = x0; sx < x1; ++sx) {
+                    r += (row[sx] >> 16) & 0xFF;
+                    g += (row[sx] >> 8) & 0xFF;
+                    b += row[sx] & 0xFF;
+                }
+            }
+            const std::uint32_t n = static_cast<std::uint32_t>((y1 - y0) * (x1 - x0));
+            out.pixels[static_cast<std::size_t>(y) * out_w + x] =
+                (((r + n / 2) / n) << 16) | (((g + n / 2) / n) << 8) | ((b + n / 2) / n);
+        }
+    }
+    return out;
+}
+
+void encode_row_rle(const std::uint16_t* px, int width, std::vector<std::uint8_t>* out) {
+    auto put_px = [out](std::uint16_t v) {
+        out->push_back(static_cast<std::uint8_t>(v & 0xFF));
+        out->push_back(static_cast<std::uint8_t>(v >> 8));
+    };
+
+    int i = 0;
+    while (i < width) {
+        int run = 1;
+        while (i + run < width && run < vbi::kMaxRun && px[i + run] == px[i]) {
+            ++run;
+        }
+        if (run >= 2) {
+            out->push_back(static_cast<std::uint8_t>(0x80 | (run - 1)));
+            put_px(px[i]);
+            i += run;
+            continue;
+        }
+
+        // Literal span up to the next run of two or more.
+        int lit = 1;
+        while (i + lit < width && lit < vbi::kMaxRun &&
+               !(i + lit + 1 < width && px[i + lit] == px[i + lit + 1])) {
+            ++lit;
+        }
+        out->push_back(static_cast<std::uint8_t>(lit - 1));
+        for (int k = 0; k < lit; ++k) {
+            put_px(px[i + k]);
+        }
+        i += lit;
+    }
+}
+
+std::vector<std::uint8_t> encode(const Image& img, std::uint8_t codec) {
+    std::vector<std::uint8_t> payload;
+    std::vector<std::uint16_t> row(static_cast<std::size_t>(img.width));
+    std::vector<std::uint8_t> encoded;
+    for (int y = 0; y < img.height; ++y) {
+        for (int x = 0; x < img.width; ++x) {
+            row[static_cast<std::size_t>(x)] = vbi::to_rgb565(img.pixels[static_cast<std::size_t>(y) * img.width + x]);
+        }
+        encoded.clear();
+        if (codec == vbi::kCodecRle) {
+            encode_row_rle(row.data(), img.width, &encoded);
+        } else {
+            for (std::uint16_t v : row) {
+                encoded.push_back(static_cast<std::uint8_t>(v & 0xFF));
+                encoded.push_back(static_cast<std::uint8_t>(v >> 8));
+            }
+        }
+        payload.push_back(static_cast<std::uint8_t>(encoded.size() & 0xFF));
+        payload.push_back(static_cast<std::uint8_t>(encoded.size() >> 8));
+        payload.insert(payload.end(), encoded.begin(), encoded.end());
+    }
+
+    vbi::Header header{static_cast<std::uint16_t>(img.width), static_cast<std::uint16_t>(img.height),
+                       vbi::kPixelRgb565, codec, static_cast<std::uint32_t>(payload.size())};
+    std::vector<std::uint8_t> file(vbi::kHeaderSize);
+    vbi::write_header(header, file.data());
+    file.insert(file.end(), payload.begin(), payload.end());
+    return file;
+}
+
+bool is_bmp(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".bmp" && path.filename().string()[0] != '.';
+}
+
+void usage() {
+    std::fprintf(stderr, "usage: vbi_convert [-j threads] [-o out_dir] [--raw] <image.bmp | dir>...\n");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned threads = std::max(1U, std::thread::hardware_concurrency());
+    fs::path out_dir;
+    std::uint8_t codec = vbi::kCodecRle;
+    std::vector<fs::path> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "-o" && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else if (arg == "--raw") {
+            codec = vbi::kCodecRaw;
+        } else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        } else if (fs::is_directory(arg)) {
+            for (const auto& entry : fs::directory_iterator(arg)) {
+                if (entry.is_regular_file() && is_bmp(entry.path())) {
+                    inputs.push_back(entry.path());
+                }
+            }
+        } else if (fs::is_regular_file(arg)) {
+            inputs.emplace_back(arg);
+        } else {
+            std::fprintf(stderr, "vbi_convert: no such file or directory: %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (inputs.empty()) {
+        usage();
+        return 2;
+    }
+    std::sort(inputs.begin(), inputs.end());
+    if (!out_dir.empty()) {
+        fs::create_directories(out_dir);
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<int> failed{0};
+    std::atomic<std::uintmax_t> total_in{0};
+    std::atomic<std::uintmax_t> total_out{0};
+    std::mutex print_mutex;
+
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < inputs.size(); i = next++) {
+            const fs::path& in_path = inputs[i];
+            fs::path out_path = (out_dir.empty() ? in_path.parent_path() : out_dir) / in_path.filename();
+            out_path.replace_extension(".vbi");
+
+            Image img;
+            std::string error;
+            if (!load_bmp(in_path, &img, &error)) {
+                std::lock_guard<std::mutex> lock(print_mutex);
+                std::fprintf(stderr, "FAIL %s: %s\n", in_path.string().c_str(), error.c_str());
+                ++failed;
+                continue;
+            }
+            if (img.width != kOutW || img.height != kOutH) {
+                img = resize(img, kOutW, kOutH);
+            }
+            const std::vector<std::uint8_t> file = encode(img, codec);
+            std::ofstream out(out_path, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+            if (!out) {
+                std::lock_guard<std::mutex> lock(print_mutex);
+                std::fprintf(stderr, "FAIL %s: cannot write %s\n", in_path.string().c_str(),
+                             out_path.string().c_str());
+                ++failed;
+                continue;
+            }
+
+            const std::uintmax_t in_size = fs::file_size(in_path);
+            total_in += in_size;
+            total_out += file.size();
+            std::lock_guard<std::mutex> lock(print_mutex);
+            std::printf("%s -> %s  %ju -> %zu bytes (%.1fx)\n", in_path.string().c_str(),
+                        out_path.string().c_str(), in_size, file.size(),
+                        static_cast<double>(in_size) / static_cast<double>(file.size()));
+        }
+    };
+
+    std::vector<std::thread> pool;
+    const unsigned count = std::min<unsigned>(threads, static_cast<unsigned>(inputs.size()));
+    for (unsigned t = 0; t < count; ++t) {
+        pool.emplace_back(worker);
+    }
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    std::printf("Converted %zu of %zu image(s): %ju -> %ju bytes\n", inputs.size() - failed.load(),
+                inputs.size(), total_in.load(), total_out.load());
+    return failed.load() == 0 ? 0 : 1;
+}